@@ -0,0 +1,318 @@
+// Checks the batched slerp against a double-precision reference on random and edge-case
+// quaternion pairs, then times channel sampling on a synthetic clip: the batched lanes (as
+// Model::SampleAnimation runs them, plain and compressed) against one channel at a time.
+#include "AnimationSampling.h"
+#include "AnimationCompression.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const size_t SlerpPairs = 100000;
+    const size_t AnimatedNodes = 1000;  // Each with a translation, rotation and scale channel
+    const size_t KeysPerChannel = 240;  // 8 s at 30 keys per second
+    const float KeyInterval = 1.0f / 30.0f;
+    const float FrameInterval = 1.0f / 60.0f;
+    const int Runs = 5;
+
+    // Error limit of the batched slerp: far above float rounding and the lerp fallback near
+    // parallel keys, far below anything visible
+    const double MaxSlerpError = 1e-4;
+
+    void Normalize(double q[4])
+    {
+        const double length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        for (int c = 0; c < 4; ++c)
+            q[c] /= length;
+    }
+
+    // Exact shortest-arc slerp in doubles
+    void ReferenceSlerp(const float* from, const float* to, float t, double* result)
+    {
+        double a[4], b[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            a[c] = from[c];
+            b[c] = to[c];
+        }
+        Normalize(a);
+        Normalize(b);
+
+        double cosTheta = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+        const double sign = cosTheta < 0.0 ? -1.0 : 1.0;
+        cosTheta = std::min(cosTheta * sign, 1.0);
+        const double theta = std::acos(cosTheta);
+        double weight0 = 1.0 - t, weight1 = t;
+        if (theta > 1e-12)
+        {
+            weight0 = std::sin((1.0 - t) * theta) / std::sin(theta);
+            weight1 = std::sin(t * theta) / std::sin(theta);
+        }
+        for (int c = 0; c < 4; ++c)
+            result[c] = a[c] * weight0 + b[c] * sign * weight1;
+        Normalize(result);
+    }
+
+    // Angle between two rotations
+    double RotationError(const double* a, const float* b)
+    {
+        double dot = 0.0;
+        for (int c = 0; c < 4; ++c)
+            dot += a[c] * b[c];
+        double differenceSq = 0.0, sumSq = 0.0;
+        for (int c = 0; c < 4; ++c)
+        {
+            const double bc = dot < 0.0 ? -b[c] : b[c];
+            differenceSq += (a[c] - bc) * (a[c] - bc);
+            sumSq += (a[c] + bc) * (a[c] + bc);
+        }
+        return 4.0 * std::atan2(std::sqrt(differenceSq), std::sqrt(sumSq));
+    }
+
+    void RandomRotation(std::mt19937& random, float* q)
+    {
+        std::normal_distribution<float> normal;
+        float lengthSq = 0.0f;
+        for (int c = 0; c < 4; ++c)
+        {
+            q[c] = normal(random);
+            lengthSq += q[c] * q[c];
+        }
+        for (int c = 0; c < 4; ++c)
+            q[c] /= std::sqrt(lengthSq);
+    }
+
+    bool CheckSlerp(std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::uniform_real_distribution<float> tiny(-1e-3f, 1e-3f);
+
+        // A quarter each: random pairs, nearly parallel, nearly opposite, and identical or negated
+        std::vector<float> pairs(SlerpPairs * 8);
+        std::vector<float> factors(SlerpPairs);
+        for (size_t i = 0; i < SlerpPairs; ++i)
+        {
+            float* from = &pairs[i * 8];
+            float* to = from + 4;
+            RandomRotation(random, from);
+            switch (i % 4)
+            {
+            case 0:
+                RandomRotation(random, to);
+                break;
+            case 1:
+            case 2:
+            {
+                float lengthSq = 0.0f;
+                for (int c = 0; c < 4; ++c)
+                {
+                    to[c] = (i % 4 == 1 ? from[c] : -from[c]) + tiny(random);
+                    lengthSq += to[c] * to[c];
+                }
+                for (int c = 0; c < 4; ++c)
+                    to[c] /= std::sqrt(lengthSq);
+                break;
+            }
+            default:
+                for (int c = 0; c < 4; ++c)
+                    to[c] = (i % 8 == 3) ? from[c] : -from[c];
+                break;
+            }
+            factors[i] = unit(random);
+        }
+
+        AnimationSampleLanes lanes;
+        const size_t laneCount = (SlerpPairs + 3) & ~size_t(3);
+        for (int c = 0; c < 4; ++c)
+        {
+            lanes.from[c].assign(laneCount, c == 3 ? 1.0f : 0.0f);
+            lanes.to[c].assign(laneCount, c == 3 ? 1.0f : 0.0f);
+            for (size_t i = 0; i < SlerpPairs; ++i)
+            {
+                lanes.from[c][i] = pairs[i * 8 + c];
+                lanes.to[c][i] = pairs[i * 8 + 4 + c];
+            }
+        }
+        lanes.factor.assign(laneCount, 0.0f);
+        std::copy(factors.begin(), factors.end(), lanes.factor.begin());
+        SlerpLanes(lanes);
+
+        double maxError[4] = {}, sumError = 0.0;
+        for (size_t i = 0; i < SlerpPairs; ++i)
+        {
+            double expected[4];
+            ReferenceSlerp(&pairs[i * 8], &pairs[i * 8 + 4], factors[i], expected);
+            const float result[4] = { lanes.from[0][i], lanes.from[1][i], lanes.from[2][i], lanes.from[3][i] };
+            const double error = RotationError(expected, result);
+            maxError[i % 4] = std::max(maxError[i % 4], error);
+            sumError += error;
+        }
+
+        std::cout << "Slerp against the reference (" << SlerpPairs << " pairs), max error in radians: random " << maxError[0]
+            << ", nearly parallel " << maxError[1] << ", nearly opposite " << maxError[2] << ", equal or negated " << maxError[3]
+            << "; mean " << sumError / SlerpPairs << std::endl;
+        return *std::max_element(maxError, maxError + 4) <= MaxSlerpError;
+    }
+
+    // Smooth random curves, so compression has something realistic to drop
+    void BuildClip(std::mt19937& random, std::vector<GLTFNode>& nodes, GLTFAnimation& animation)
+    {
+        std::uniform_real_distribution<float> phase(0.0f, 6.2831853f);
+        std::uniform_real_distribution<float> rate(0.2f, 2.0f);
+        nodes.resize(AnimatedNodes);
+        animation.channels.resize(AnimatedNodes * 3);
+        for (size_t n = 0; n < AnimatedNodes; ++n)
+        {
+            const float p[4] = { phase(random), phase(random), phase(random), phase(random) };
+            const float w = rate(random);
+            for (uint32_t type = 0; type < GLTFAnimationChannel::TypeCount; ++type)
+            {
+                GLTFAnimationChannel& channel = animation.channels[n * 3 + type];
+                channel.type = GLTFAnimationChannel::Type(type);
+                channel.targetNode = &nodes[n];
+                for (size_t k = 0; k < KeysPerChannel; ++k)
+                {
+                    const float time = k * KeyInterval;
+                    channel.times.push_back(time);
+                    if (type == GLTFAnimationChannel::Translation)
+                        channel.translations.push_back(DirectX::XMFLOAT3(std::sin(w * time + p[0]), std::sin(w * time + p[1]) * 0.5f, std::cos(w * time + p[2])));
+                    else if (type == GLTFAnimationChannel::Scale)
+                        channel.scales.push_back(DirectX::XMFLOAT3(1.0f + 0.1f * std::sin(w * time + p[3]), 1.0f, 1.0f));
+                    else
+                    {
+                        float q[4] = { std::sin(w * time + p[0]), std::cos(w * time * 0.7f + p[1]), std::sin(w * time * 1.3f + p[2]), 2.0f + std::cos(w * time + p[3]) };
+                        const float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+                        channel.rotations.push_back(DirectX::XMFLOAT4(q[0] / length, q[1] / length, q[2] / length, q[3] / length));
+                    }
+                }
+            }
+        }
+        PrepareAnimation(animation);
+    }
+
+    // What SampleAnimation does for one instance
+    void SampleBatched(const GLTFAnimation& animation, float time, std::vector<size_t>& cursors, AnimationSampleLanes (&lanes)[GLTFAnimationChannel::TypeCount])
+    {
+        for (uint32_t type = 0; type < GLTFAnimationChannel::TypeCount; ++type)
+        {
+            GatherKeyframes(animation, GLTFAnimationChannel::Type(type), time, cursors, lanes[type]);
+            if (type == GLTFAnimationChannel::Rotation)
+                SlerpLanes(lanes[type]);
+            else
+                LerpLanes(lanes[type], 3);
+        }
+    }
+
+    // One channel at a time with scalar math; results in channel order, four floats each
+    void SampleScalar(const GLTFAnimation& animation, float time, std::vector<size_t>& cursors, std::vector<float>& results)
+    {
+        results.resize(animation.channels.size() * 4);
+        for (size_t i = 0; i < animation.channels.size(); ++i)
+        {
+            const GLTFAnimationChannel& channel = animation.channels[i];
+            const size_t key0 = FindKeyframe(channel.times, time, cursors[i]);
+            const float t0 = channel.times[key0], t1 = channel.times[key0 + 1];
+            const float t = std::clamp((time - t0) / (t1 - t0), 0.0f, 1.0f);
+            float* result = &results[i * 4];
+            if (channel.type != GLTFAnimationChannel::Rotation)
+            {
+                const DirectX::XMFLOAT3& a = channel.type == GLTFAnimationChannel::Translation ? channel.translations[key0] : channel.scales[key0];
+                const DirectX::XMFLOAT3& b = channel.type == GLTFAnimationChannel::Translation ? channel.translations[key0 + 1] : channel.scales[key0 + 1];
+                result[0] = a.x + (b.x - a.x) * t;
+                result[1] = a.y + (b.y - a.y) * t;
+                result[2] = a.z + (b.z - a.z) * t;
+                continue;
+            }
+
+            const float* a = &channel.rotations[key0].x;
+            const float* b = &channel.rotations[key0 + 1].x;
+            float cosTheta = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+            const float sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+            cosTheta *= sign;
+            float weight0 = 1.0f - t, weight1 = t;
+            if (cosTheta <= 0.9995f)
+            {
+                const float theta = std::acos(std::min(cosTheta, 1.0f));
+                weight0 = std::sin((1.0f - t) * theta) / std::sin(theta);
+                weight1 = std::sin(t * theta) / std::sin(theta);
+            }
+            float lengthSq = 0.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                result[c] = a[c] * weight0 + b[c] * sign * weight1;
+                lengthSq += result[c] * result[c];
+            }
+            for (int c = 0; c < 4; ++c)
+                result[c] /= std::sqrt(lengthSq);
+        }
+    }
+
+    // Milliseconds per frame over a full playback of the clip, best of Runs
+    template <typename Function>
+    double TimePlayback(Function sample)
+    {
+        const size_t frames = size_t((KeysPerChannel - 1) * KeyInterval / FrameInterval);
+        double best = 1e30;
+        for (int run = 0; run < Runs; ++run)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t frame = 0; frame < frames; ++frame)
+                sample(frame * FrameInterval);
+            auto end = std::chrono::high_resolution_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count() / frames);
+        }
+        return best;
+    }
+}
+
+int main()
+{
+    std::mt19937 random(12345);
+    if (!CheckSlerp(random))
+    {
+        std::cerr << "Batched slerp exceeds " << MaxSlerpError << " rad against the reference" << std::endl;
+        return 1;
+    }
+
+    std::vector<GLTFNode> nodes;
+    GLTFAnimation animation;
+    BuildClip(random, nodes, animation);
+
+    // The batched lanes hold channels grouped by type; compare them with the scalar results once
+    std::vector<size_t> batchedCursors(animation.channels.size()), scalarCursors(animation.channels.size());
+    AnimationSampleLanes lanes[GLTFAnimationChannel::TypeCount];
+    std::vector<float> scalarResults;
+    float maxDifference = 0.0f;
+    for (float time = 0.0f; time < (KeysPerChannel - 1) * KeyInterval; time += 0.37f)
+    {
+        SampleBatched(animation, time, batchedCursors, lanes);
+        SampleScalar(animation, time, scalarCursors, scalarResults);
+        for (uint32_t type = 0; type < GLTFAnimationChannel::TypeCount; ++type)
+        {
+            const std::vector<uint32_t>& channels = animation.typeChannels[type];
+            for (size_t i = 0; i < channels.size(); ++i)
+            {
+                for (uint32_t c = 0; c < (type == GLTFAnimationChannel::Rotation ? 4u : 3u); ++c)
+                    maxDifference = std::max(maxDifference, std::fabs(lanes[type].from[c][i] - scalarResults[channels[i] * 4 + c]));
+            }
+        }
+    }
+    std::cout << AnimatedNodes * 3 << " channels of " << KeysPerChannel << " keys; batched and scalar samples differ by at most " << maxDifference << std::endl;
+
+    const double scalarMs = TimePlayback([&](float time) { SampleScalar(animation, time, scalarCursors, scalarResults); });
+    const double batchedMs = TimePlayback([&](float time) { SampleBatched(animation, time, batchedCursors, lanes); });
+
+    AnimationCompressionStats stats;
+    for (GLTFAnimationChannel& channel : animation.channels)
+        CompressAnimationChannel(channel, AnimationCompressionSettings(), stats);
+    PrepareAnimation(animation);
+    const double compressedMs = TimePlayback([&](float time) { SampleBatched(animation, time, batchedCursors, lanes); });
+
+    std::cout << "Sampling per frame: scalar " << scalarMs << " ms, batched " << batchedMs << " ms, batched compressed " << compressedMs
+        << " ms (" << stats.keysAfter << " of " << stats.keysBefore << " keys kept)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,205 @@
+// Times the geometry half of Model::LoadGLTFModel on real glTF files: reading, meshopt decode
+// and the primitive decode, serial against the JobSystem workers, and checks that both produce
+// the same arrays and offsets. Pass several files (e.g. a float scene and the same scene
+// through gltfpack -c) to compare their load times against the first one.
+#define CGLTF_IMPLEMENTATION
+#include "GLTFDecoding.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const int Runs = 5;
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    double GetMs(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    struct DecodedScene
+    {
+        std::vector<GLTFPrimitive> primitives;
+        std::vector<GLTFVertex> vertices;
+        std::vector<uint32_t> indices32;
+        std::vector<uint16_t> indices16;
+        std::vector<SkinVertex> skinVertices;
+        size_t bufferBytes = 0;
+        MeshoptDecodeStats meshopt;
+        double readMs = 0.0;    // Parse, buffer loads and validation
+        double meshoptMs = 0.0;
+        double decodeMs = 0.0;  // Sizing pass, allocation and primitive decode
+
+        double GetTotalMs() const { return readMs + meshoptMs + decodeMs; }
+    };
+
+    // Same steps and layout as Model::LoadGLTFModel up to the decoded global arrays
+    bool LoadAndDecode(const char* path, bool parallel, DecodedScene& scene)
+    {
+        scene = DecodedScene();
+        const Clock::time_point readStart = Clock::now();
+        cgltf_options options = {};
+        cgltf_data* data = nullptr;
+        if (cgltf_parse_file(&options, path, &data) != cgltf_result_success)
+        {
+            std::cerr << "Failed to parse " << path << std::endl;
+            return false;
+        }
+        if (cgltf_load_buffers(&options, data, path) != cgltf_result_success || cgltf_validate(data) != cgltf_result_success)
+        {
+            std::cerr << "Failed to load the buffers of " << path << std::endl;
+            cgltf_free(data);
+            return false;
+        }
+        for (size_t i = 0; i < data->buffers_count; ++i)
+            scene.bufferBytes += data->buffers[i].data ? data->buffers[i].size : 0;
+
+        const Clock::time_point meshoptStart = Clock::now();
+        if (!DecodeMeshoptBuffers(data, parallel, scene.meshopt))
+        {
+            std::cerr << "Failed to decode the meshopt buffers of " << path << std::endl;
+            cgltf_free(data);
+            return false;
+        }
+
+        const Clock::time_point decodeStart = Clock::now();
+        std::vector<const cgltf_primitive*> sources;
+        for (size_t i = 0; i < data->meshes_count; ++i)
+        {
+            for (size_t j = 0; j < data->meshes[i].primitives_count; ++j)
+                sources.push_back(&data->meshes[i].primitives[j]);
+        }
+
+        scene.primitives.resize(sources.size());
+        uint64_t totalVertices = 0;
+        uint64_t totalIndices[IndexPool_Count] = {};
+        uint64_t totalSkinVertices = 0;
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            GLTFPrimitive& prim = scene.primitives[i];
+            SizePrimitive(sources[i], prim);
+            prim.globalVertexOffset = static_cast<uint32_t>(totalVertices);
+            prim.globalIndexOffset = static_cast<uint32_t>(totalIndices[prim.indexPool]);
+            prim.firstSkinVertex = static_cast<uint32_t>(totalSkinVertices);
+            totalVertices += prim.vertexCount;
+            totalIndices[prim.indexPool] += prim.indexCount;
+            totalSkinVertices += prim.skinned ? prim.vertexCount : 0;
+        }
+        scene.vertices.resize(static_cast<size_t>(totalVertices));
+        scene.skinVertices.resize(static_cast<size_t>(totalSkinVertices));
+        scene.indices32.resize(static_cast<size_t>(totalIndices[IndexPool_32]));
+        scene.indices16.resize(static_cast<size_t>((totalIndices[IndexPool_16] + 1) & ~1ull));
+
+        std::atomic<bool> failed{ false };
+        auto decode = [&](size_t i)
+        {
+            GLTFPrimitive& prim = scene.primitives[i];
+            void* indices = prim.indexPool == IndexPool_16
+                ? static_cast<void*>(scene.indices16.data() + prim.globalIndexOffset)
+                : static_cast<void*>(scene.indices32.data() + prim.globalIndexOffset);
+            if (!DecodePrimitive(data, sources[i], prim, scene.vertices.data() + prim.globalVertexOffset, indices) ||
+                (prim.skinned && !DecodeSkinVertices(sources[i], scene.vertices.data() + prim.globalVertexOffset, prim.vertexCount, scene.skinVertices.data() + prim.firstSkinVertex)))
+                failed = true;
+        };
+        if (parallel)
+        {
+            JobSystem::Get().ParallelFor(sources.size(), decode);
+        }
+        else
+        {
+            for (size_t i = 0; i < sources.size(); ++i)
+                decode(i);
+        }
+        const Clock::time_point decodeEnd = Clock::now();
+        cgltf_free(data);
+
+        scene.readMs = GetMs(readStart, meshoptStart);
+        scene.meshoptMs = GetMs(meshoptStart, decodeStart);
+        scene.decodeMs = GetMs(decodeStart, decodeEnd);
+        if (failed)
+            std::cerr << "Failed to decode the primitives of " << path << std::endl;
+        return !failed;
+    }
+
+    template <typename T>
+    bool SameBytes(const std::vector<T>& a, const std::vector<T>& b)
+    {
+        return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    bool SameLayout(const DecodedScene& a, const DecodedScene& b)
+    {
+        if (a.primitives.size() != b.primitives.size())
+            return false;
+        for (size_t i = 0; i < a.primitives.size(); ++i)
+        {
+            const GLTFPrimitive& pa = a.primitives[i];
+            const GLTFPrimitive& pb = b.primitives[i];
+            if (pa.globalVertexOffset != pb.globalVertexOffset || pa.globalIndexOffset != pb.globalIndexOffset ||
+                pa.vertexCount != pb.vertexCount || pa.indexCount != pb.indexCount || pa.indexPool != pb.indexPool)
+                return false;
+        }
+        return SameBytes(a.vertices, b.vertices) && SameBytes(a.indices32, b.indices32) &&
+            SameBytes(a.indices16, b.indices16) && SameBytes(a.skinVertices, b.skinVertices);
+    }
+
+    void Print(const char* label, const DecodedScene& scene)
+    {
+        std::cout << "  " << label << ": read " << scene.readMs << " ms, meshopt " << scene.meshoptMs
+            << " ms, decode " << scene.decodeMs << " ms, total " << scene.GetTotalMs() << " ms" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: GLTFDecodeBenchmark <scene.gltf|glb> [<other encoding of the scene> ...]" << std::endl;
+        return 1;
+    }
+
+    // Best of Runs for each mode; the first run also warms the file cache
+    std::vector<double> totals;
+    for (int file = 1; file < argc; ++file)
+    {
+        DecodedScene best[2];
+        for (int parallel = 0; parallel < 2; ++parallel)
+        {
+            for (int run = 0; run < Runs; ++run)
+            {
+                DecodedScene scene;
+                if (!LoadAndDecode(argv[file], parallel != 0, scene))
+                    return 1;
+                if (run == 0 || scene.GetTotalMs() < best[parallel].GetTotalMs())
+                    best[parallel] = std::move(scene);
+            }
+        }
+
+        const DecodedScene& serial = best[0];
+        std::cout << argv[file] << ": " << serial.bufferBytes / 1024 << " KB of buffers (" << serial.meshopt.views << " meshopt views, "
+            << serial.meshopt.decodedBytes / 1024 << " KB decoded), " << serial.primitives.size() << " primitives, "
+            << serial.vertices.size() << " vertices" << std::endl;
+        Print("serial", serial);
+        Print(("parallel, " + std::to_string(JobSystem::Get().GetWorkerCount() + 1) + " threads").c_str(), best[1]);
+        std::cout << "  decode speedup " << serial.decodeMs / std::max(best[1].decodeMs, 1e-3)
+            << "x, load speedup " << serial.GetTotalMs() / std::max(best[1].GetTotalMs(), 1e-3) << "x" << std::endl;
+
+        if (!SameLayout(serial, best[1]))
+        {
+            std::cerr << "Parallel decode differs from the serial one" << std::endl;
+            return 1;
+        }
+        totals.push_back(best[1].GetTotalMs());
+    }
+
+    for (size_t i = 1; i < totals.size(); ++i)
+        std::cout << argv[i + 1] << " loads in " << totals[i] / std::max(totals[0], 1e-3) << "x the time of " << argv[1] << " (parallel)" << std::endl;
+    return 0;
+}
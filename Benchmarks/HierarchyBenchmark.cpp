@@ -0,0 +1,300 @@
+// Times PropagateNodeTransforms against the recursive walk it replaced, on a synthetic
+// 100k-node hierarchy: a full propagation, and incremental updates of a few random nodes.
+// Both produce the same worlds and AABBs, which is checked before anything is timed.
+#include "SceneTypes.h"
+#include "NodeHierarchy.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    const size_t NodeCount = 100000;
+    const size_t MaxDepth = 48;
+    const size_t DirtyNodesPerUpdate = 100;
+    const int Runs = 21;
+
+    struct Scene
+    {
+        std::vector<GLTFMesh> meshes;
+        std::vector<GLTFNode> nodes;
+        std::vector<GLTFNode*> roots;
+        NodeHierarchy hierarchy;
+    };
+
+    // Pre-order generation: each node's parent is some ancestor of the node before it, so the
+    // node array is already depth-first and doubles as the flattened hierarchy
+    void BuildScene(Scene& scene, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::bernoulli_distribution popLevel(0.3);
+        std::bernoulli_distribution hasMesh(0.6);
+
+        scene.meshes.resize(4);
+        for (size_t m = 0; m < scene.meshes.size(); ++m)
+        {
+            scene.meshes[m].primitives.resize(1 + m % 2);
+            for (auto& primitive : scene.meshes[m].primitives)
+                primitive.aabb = BoundingBox(XMFLOAT3(unit(random), unit(random), unit(random)), XMFLOAT3(0.5f, 0.25f + 0.2f * m, 0.5f));
+        }
+
+        scene.nodes.resize(NodeCount);
+        NodeHierarchy& hierarchy = scene.hierarchy;
+        hierarchy.parents.resize(NodeCount);
+        std::vector<int32_t> path;
+        for (size_t i = 0; i < NodeCount; ++i)
+        {
+            while (!path.empty() && (path.size() >= MaxDepth || popLevel(random)))
+                path.pop_back();
+
+            GLTFNode& node = scene.nodes[i];
+            const XMMATRIX local = XMMatrixRotationRollPitchYaw(0.2f * unit(random), 0.2f * unit(random), 0.2f * unit(random)) *
+                XMMatrixTranslation(unit(random), unit(random), unit(random));
+            XMStoreFloat4x4(&node.transform, local);
+            node.mesh = hasMesh(random) ? &scene.meshes[i % scene.meshes.size()] : nullptr;
+            node.hierarchyIndex = static_cast<uint32_t>(i);
+
+            hierarchy.parents[i] = path.empty() ? -1 : path.back();
+            if (path.empty())
+                scene.roots.push_back(&node);
+            else
+                scene.nodes[path.back()].children.push_back(&node);
+            path.push_back(static_cast<int32_t>(i));
+        }
+
+        hierarchy.nodes.resize(NodeCount);
+        hierarchy.locals.resize(NodeCount);
+        hierarchy.subtreeEnds.resize(NodeCount);
+        for (size_t i = 0; i < NodeCount; ++i)
+        {
+            hierarchy.nodes[i] = &scene.nodes[i];
+            hierarchy.locals[i] = scene.nodes[i].transform;
+            hierarchy.subtreeEnds[i] = static_cast<uint32_t>(i + 1);
+        }
+        for (size_t i = NodeCount; i-- > 0;)
+        {
+            if (hierarchy.parents[i] >= 0)
+                hierarchy.subtreeEnds[hierarchy.parents[i]] = std::max(hierarchy.subtreeEnds[hierarchy.parents[i]], hierarchy.subtreeEnds[i]);
+        }
+        hierarchy.worlds.resize(NodeCount);
+        hierarchy.worldAabbs.resize(NodeCount);
+        hierarchy.meshAabbs.resize(NodeCount);
+        hierarchy.dirty.assign(NodeCount, 1);
+        hierarchy.states.assign(NodeCount, 0);
+    }
+
+    // The recursive version: world matrices down the GLTFNode tree, AABBs merged on the way back up
+    struct RecursiveState
+    {
+        std::vector<XMFLOAT4X4> worlds;
+        std::vector<BoundingBox> worldAabbs;
+        std::vector<BoundingBox> meshAabbs;
+    };
+
+    void MeshAabb(const GLTFNode& node, FXMMATRIX world, BoundingBox& result)
+    {
+        if (!node.mesh)
+            return;
+        for (size_t j = 0; j < node.mesh->primitives.size(); ++j)
+        {
+            BoundingBox transformedAabb;
+            node.mesh->primitives[j].aabb.Transform(transformedAabb, world);
+            if (j == 0)
+                result = transformedAabb;
+            else
+                BoundingBox::CreateMerged(result, result, transformedAabb);
+        }
+    }
+
+    // World AABB from the node's primitives and its children's current boxes
+    void RefitRecursive(const GLTFNode& node, RecursiveState& state)
+    {
+        const uint32_t i = node.hierarchyIndex;
+        bool bounded = node.mesh && !node.mesh->primitives.empty();
+        BoundingBox box = state.meshAabbs[i];
+        for (const GLTFNode* child : node.children)
+        {
+            if (bounded)
+                BoundingBox::CreateMerged(box, box, state.worldAabbs[child->hierarchyIndex]);
+            else
+                box = state.worldAabbs[child->hierarchyIndex];
+            bounded = true;
+        }
+        if (!bounded)
+            box = BoundingBox(XMFLOAT3(state.worlds[i]._41, state.worlds[i]._42, state.worlds[i]._43), XMFLOAT3(0.0f, 0.0f, 0.0f));
+        state.worldAabbs[i] = box;
+    }
+
+    void PropagateRecursive(const GLTFNode& node, const GLTFNode* parent, RecursiveState& state)
+    {
+        const uint32_t i = node.hierarchyIndex;
+        XMMATRIX world = XMLoadFloat4x4(&node.transform);
+        if (parent)
+            world = world * XMLoadFloat4x4(&state.worlds[parent->hierarchyIndex]);
+        XMStoreFloat4x4(&state.worlds[i], world);
+        MeshAabb(node, world, state.meshAabbs[i]);
+
+        for (const GLTFNode* child : node.children)
+            PropagateRecursive(*child, &node, state);
+        RefitRecursive(node, state);
+    }
+
+    // Incremental: redo each dirty node's subtree, then refit its ancestors one by one
+    void UpdateRecursive(const Scene& scene, const std::vector<uint32_t>& dirtyNodes, RecursiveState& state)
+    {
+        for (uint32_t index : dirtyNodes)
+        {
+            const int32_t parent = scene.hierarchy.parents[index];
+            PropagateRecursive(scene.nodes[index], parent >= 0 ? &scene.nodes[parent] : nullptr, state);
+            for (int32_t ancestor = parent; ancestor >= 0; ancestor = scene.hierarchy.parents[ancestor])
+                RefitRecursive(scene.nodes[ancestor], state);
+        }
+    }
+
+    void PropagateAllRecursive(const Scene& scene, RecursiveState& state)
+    {
+        for (const GLTFNode* root : scene.roots)
+            PropagateRecursive(*root, nullptr, state);
+    }
+
+    // Largest difference between the two results (merge order differs, so AABBs may round apart)
+    float Compare(const NodeHierarchy& hierarchy, const RecursiveState& state)
+    {
+        float difference = 0.0f;
+        for (size_t i = 0; i < hierarchy.nodes.size(); ++i)
+        {
+            for (int r = 0; r < 4; ++r)
+            {
+                for (int c = 0; c < 4; ++c)
+                    difference = std::max(difference, std::fabs(hierarchy.worlds[i].m[r][c] - state.worlds[i].m[r][c]));
+            }
+            const BoundingBox& a = hierarchy.worldAabbs[i];
+            const BoundingBox& b = state.worldAabbs[i];
+            difference = std::max({ difference, std::fabs(a.Center.x - b.Center.x), std::fabs(a.Center.y - b.Center.y), std::fabs(a.Center.z - b.Center.z),
+                std::fabs(a.Extents.x - b.Extents.x), std::fabs(a.Extents.y - b.Extents.y), std::fabs(a.Extents.z - b.Extents.z) });
+        }
+        return difference;
+    }
+
+    template <typename Function>
+    double MedianMilliseconds(Function function)
+    {
+        std::vector<double> times;
+        for (int run = 0; run < Runs; ++run)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            function();
+            auto end = std::chrono::high_resolution_clock::now();
+            times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        return times[times.size() / 2];
+    }
+
+    void Touch(Scene& scene, const std::vector<uint32_t>& dirtyNodes, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (uint32_t index : dirtyNodes)
+        {
+            const XMMATRIX local = XMMatrixRotationRollPitchYaw(0.2f * unit(random), 0.2f * unit(random), 0.2f * unit(random)) *
+                XMMatrixTranslation(unit(random), unit(random), unit(random));
+            XMStoreFloat4x4(&scene.nodes[index].transform, local);
+            scene.hierarchy.locals[index] = scene.nodes[index].transform;
+            scene.hierarchy.dirty[index] = 1;
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 random(12345);
+    Scene scene;
+    BuildScene(scene, random);
+
+    size_t depth = 0, meshNodes = 0;
+    for (size_t i = 0; i < NodeCount; ++i)
+    {
+        size_t nodeDepth = 1;
+        for (int32_t parent = scene.hierarchy.parents[i]; parent >= 0; parent = scene.hierarchy.parents[parent])
+            ++nodeDepth;
+        depth = std::max(depth, nodeDepth);
+        meshNodes += scene.nodes[i].mesh ? 1 : 0;
+    }
+    std::cout << NodeCount << " nodes (" << scene.roots.size() << " roots, depth " << depth << ", " << meshNodes << " with meshes)" << std::endl;
+
+    RecursiveState state;
+    state.worlds.resize(NodeCount);
+    state.worldAabbs.resize(NodeCount);
+    state.meshAabbs.resize(NodeCount);
+
+    // Full propagation
+    PropagateNodeTransforms(scene.hierarchy);
+    PropagateAllRecursive(scene, state);
+    float difference = Compare(scene.hierarchy, state);
+    std::cout << "Full propagation: max difference " << difference << std::endl;
+    if (difference > 1e-3f)
+    {
+        std::cerr << "Linear and recursive propagation disagree" << std::endl;
+        return 1;
+    }
+
+    const double fullLinear = MedianMilliseconds([&]
+    {
+        std::fill(scene.hierarchy.dirty.begin(), scene.hierarchy.dirty.end(), uint8_t(1));
+        PropagateNodeTransforms(scene.hierarchy);
+    });
+    const double fullRecursive = MedianMilliseconds([&] { PropagateAllRecursive(scene, state); });
+    std::cout << "Full propagation: linear " << fullLinear << " ms, recursive " << fullRecursive << " ms" << std::endl;
+
+    // Incremental updates of random nodes
+    std::uniform_int_distribution<uint32_t> pick(0, NodeCount - 1);
+    std::vector<uint32_t> dirtyNodes(DirtyNodesPerUpdate);
+    auto pickDirtyNodes = [&]
+    {
+        for (uint32_t& index : dirtyNodes)
+            index = pick(random);
+    };
+
+    pickDirtyNodes();
+    Touch(scene, dirtyNodes, random);
+    PropagateNodeTransforms(scene.hierarchy);
+    UpdateRecursive(scene, dirtyNodes, state);
+    difference = Compare(scene.hierarchy, state);
+    std::cout << "Incremental update: max difference " << difference << std::endl;
+    if (difference > 1e-3f)
+    {
+        std::cerr << "Linear and recursive incremental updates disagree" << std::endl;
+        return 1;
+    }
+
+    double incrementalLinear = 0.0, incrementalRecursive = 0.0;
+    {
+        std::vector<double> linearTimes, recursiveTimes;
+        for (int run = 0; run < Runs; ++run)
+        {
+            pickDirtyNodes();
+            Touch(scene, dirtyNodes, random);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            PropagateNodeTransforms(scene.hierarchy);
+            auto middle = std::chrono::high_resolution_clock::now();
+            UpdateRecursive(scene, dirtyNodes, state);
+            auto end = std::chrono::high_resolution_clock::now();
+
+            linearTimes.push_back(std::chrono::duration<double, std::milli>(middle - start).count());
+            recursiveTimes.push_back(std::chrono::duration<double, std::milli>(end - middle).count());
+        }
+        std::sort(linearTimes.begin(), linearTimes.end());
+        std::sort(recursiveTimes.begin(), recursiveTimes.end());
+        incrementalLinear = linearTimes[Runs / 2];
+        incrementalRecursive = recursiveTimes[Runs / 2];
+    }
+    std::cout << "Incremental update (" << DirtyNodesPerUpdate << " dirty nodes): linear " << incrementalLinear << " ms, recursive "
+        << incrementalRecursive << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include "AnimationCompression.h"
+#include "SceneTypes.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // Bounds the quadratic span test on long runs of reducible keys
+    const size_t MaxSpanKeys = 256;
+
+    const float* GetSourceKey(const GLTFAnimationChannel& channel, size_t key)
+    {
+        if (channel.type == GLTFAnimationChannel::Translation)
+            return &channel.translations[key].x;
+        if (channel.type == GLTFAnimationChannel::Rotation)
+            return &channel.rotations[key].x;
+        return &channel.scales[key].x;
+    }
+
+    uint16_t QuantizeUnorm(float value, float maxValue)
+    {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * maxValue));
+    }
+
+    void EncodeRotation(const float* rotation, uint16_t* packed)
+    {
+        float q[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        const float length = std::sqrt(rotation[0] * rotation[0] + rotation[1] * rotation[1] + rotation[2] * rotation[2] + rotation[3] * rotation[3]);
+        if (length > 0.0f)
+        {
+            for (uint32_t c = 0; c < 4; ++c)
+                q[c] = rotation[c] / length;
+        }
+
+        uint32_t largest = 0;
+        for (uint32_t c = 1; c < 4; ++c)
+        {
+            if (std::abs(q[c]) > std::abs(q[largest]))
+                largest = c;
+        }
+
+        // q and -q are the same rotation; store the one whose dropped component is positive
+        const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+        for (uint32_t c = 0, i = 0; c < 4; ++c)
+        {
+            if (c == largest)
+                continue;
+            const uint16_t value = QuantizeUnorm(q[c] * sign / SmallestThreeRange * 0.5f + 0.5f, 32767.0f);
+            packed[i++] = static_cast<uint16_t>(value << 1);
+        }
+        packed[0] |= largest & 1;
+        packed[1] |= largest >> 1;
+    }
+
+    // Same interpolation as the sampler: lerp for translations and scales; shortest-arc slerp
+    // for rotations, falling back to lerp where the keys are nearly parallel, then normalized
+    void Interpolate(const float* from, const float* to, float t, bool rotation, float* result)
+    {
+        if (!rotation)
+        {
+            for (uint32_t c = 0; c < 3; ++c)
+                result[c] = from[c] + (to[c] - from[c]) * t;
+            return;
+        }
+
+        float cosTheta = from[0] * to[0] + from[1] * to[1] + from[2] * to[2] + from[3] * to[3];
+        const float sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+        cosTheta *= sign;
+
+        float weight0 = 1.0f - t;
+        float weight1 = t;
+        if (cosTheta <= 0.9995f)
+        {
+            const float theta = std::acos(std::min(cosTheta, 1.0f));
+            const float sinTheta = std::sin(theta);
+            weight0 = std::sin((1.0f - t) * theta) / sinTheta;
+            weight1 = std::sin(t * theta) / sinTheta;
+        }
+
+        float lengthSq = 0.0f;
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            result[c] = from[c] * weight0 + to[c] * sign * weight1;
+            lengthSq += result[c] * result[c];
+        }
+        const float invLength = 1.0f / std::sqrt(lengthSq);
+        for (uint32_t c = 0; c < 4; ++c)
+            result[c] *= invLength;
+    }
+
+    // Rotations: angle between the two rotations (atan2 form, which stays precise for tiny angles
+    // where acos of the dot product does not). Translations and scales: largest component difference.
+    float KeyError(const float* a, const float* b, bool rotation)
+    {
+        if (!rotation)
+            return std::max({ std::abs(a[0] - b[0]), std::abs(a[1] - b[1]), std::abs(a[2] - b[2]) });
+
+        const float lengthA = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2] + a[3] * a[3]);
+        const float lengthB = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2] + b[3] * b[3]);
+        if (lengthA == 0.0f || lengthB == 0.0f)
+            return 0.0f;
+        const float sign = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3] < 0.0f ? -1.0f : 1.0f;
+
+        float differenceSq = 0.0f, sumSq = 0.0f;
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            const float unitA = a[c] / lengthA;
+            const float unitB = b[c] * sign / lengthB;
+            differenceSq += (unitA - unitB) * (unitA - unitB);
+            sumSq += (unitA + unitB) * (unitA + unitB);
+        }
+        return 4.0f * std::atan2(std::sqrt(differenceSq), std::sqrt(sumSq));
+    }
+}
+
+void AnimationCompressionStats::Merge(const AnimationCompressionStats& other)
+{
+    keysBefore += other.keysBefore;
+    keysAfter += other.keysAfter;
+    bytesBefore += other.bytesBefore;
+    bytesAfter += other.bytesAfter;
+    rotationError = std::max(rotationError, other.rotationError);
+    translationError = std::max(translationError, other.translationError);
+    scaleError = std::max(scaleError, other.scaleError);
+    uncompressedChannels += other.uncompressedChannels;
+}
+
+void CompressAnimationChannel(GLTFAnimationChannel& channel, const AnimationCompressionSettings& settings, AnimationCompressionStats& stats)
+{
+    const bool rotation = channel.type == GLTFAnimationChannel::Rotation;
+    const size_t valueCount = channel.type == GLTFAnimationChannel::Translation ? channel.translations.size()
+        : rotation ? channel.rotations.size() : channel.scales.size();
+    const size_t keyCount = std::min(channel.times.size(), valueCount);
+    if (keyCount == 0 || !channel.compressedKeys.values.empty())
+        return;
+
+    const uint32_t components = rotation ? 4 : 3;
+    CompressedKeys& keys = channel.compressedKeys;
+    std::vector<uint16_t> packed(keyCount * 3);
+    if (rotation)
+    {
+        for (size_t k = 0; k < keyCount; ++k)
+            EncodeRotation(GetSourceKey(channel, k), &packed[k * 3]);
+    }
+    else
+    {
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            float minValue = GetSourceKey(channel, 0)[c], maxValue = minValue;
+            for (size_t k = 1; k < keyCount; ++k)
+            {
+                minValue = std::min(minValue, GetSourceKey(channel, k)[c]);
+                maxValue = std::max(maxValue, GetSourceKey(channel, k)[c]);
+            }
+            keys.offset[c] = minValue;
+            keys.scale[c] = maxValue - minValue;
+            for (size_t k = 0; k < keyCount; ++k)
+                packed[k * 3 + c] = keys.scale[c] > 0.0f ? QuantizeUnorm((GetSourceKey(channel, k)[c] - minValue) / keys.scale[c], 65535.0f) : 0;
+        }
+    }
+
+    // Spans are tested against the quantized keys they would interpolate, so quantization is part
+    // of the measured error
+    keys.values.swap(packed);
+    std::vector<float> decoded(keyCount * 4);
+    for (size_t k = 0; k < keyCount; ++k)
+        DecodeKey(keys, rotation, k, &decoded[k * 4]);
+    keys.values.swap(packed);
+
+    const float tolerance = rotation ? settings.rotationTolerance
+        : channel.type == GLTFAnimationChannel::Translation ? settings.translationTolerance : settings.scaleTolerance;
+    const size_t channelBytes = channel.times.size() * sizeof(float) + valueCount * components * sizeof(float);
+
+    // On a channel with a wide range the 16-bit step alone may exceed the tolerance; such a
+    // channel keeps its float keys instead of being stored with a larger error than asked for
+    for (size_t k = 0; k < keyCount; ++k)
+    {
+        if (KeyError(&decoded[k * 4], GetSourceKey(channel, k), rotation) > tolerance)
+        {
+            AnimationCompressionStats channelStats;
+            channelStats.keysBefore = channelStats.keysAfter = keyCount;
+            channelStats.bytesBefore = channelStats.bytesAfter = channelBytes;
+            channelStats.uncompressedChannels = 1;
+            stats.Merge(channelStats);
+            keys = CompressedKeys();
+            return;
+        }
+    }
+
+    const std::vector<float>& times = channel.times;
+    auto spanFits = [&](size_t first, size_t last)
+    {
+        if (times[last] <= times[first])
+            return false;
+        float value[4];
+        for (size_t k = first + 1; k < last; ++k)
+        {
+            Interpolate(&decoded[first * 4], &decoded[last * 4], (times[k] - times[first]) / (times[last] - times[first]), rotation, value);
+            if (KeyError(value, GetSourceKey(channel, k), rotation) > tolerance)
+                return false;
+        }
+        return true;
+    };
+
+    // Greedy: extend the span from the last kept key until a skipped key no longer fits
+    std::vector<size_t> kept(1, 0);
+    for (size_t last = 2; last < keyCount; ++last)
+    {
+        if (last - kept.back() > MaxSpanKeys || !spanFits(kept.back(), last))
+            kept.push_back(last - 1);
+    }
+    if (keyCount > 1)
+        kept.push_back(keyCount - 1);
+
+    // Measure what sampling will return at every source key time
+    float maxError = 0.0f;
+    for (size_t k = 0, span = 0; k < keyCount; ++k)
+    {
+        while (span + 1 < kept.size() && kept[span + 1] < k)
+            ++span;
+        const size_t first = kept[span];
+        const size_t last = span + 1 < kept.size() ? kept[span + 1] : first;
+        float value[4];
+        if (k == first || k == last)
+            std::copy(&decoded[k * 4], &decoded[k * 4] + components, value);
+        else
+            Interpolate(&decoded[first * 4], &decoded[last * 4], (times[k] - times[first]) / (times[last] - times[first]), rotation, value);
+        maxError = std::max(maxError, KeyError(value, GetSourceKey(channel, k), rotation));
+    }
+
+    std::vector<float> keptTimes(kept.size());
+    keys.values.resize(kept.size() * 3);
+    for (size_t i = 0; i < kept.size(); ++i)
+    {
+        keptTimes[i] = times[kept[i]];
+        std::copy(&packed[kept[i] * 3], &packed[kept[i] * 3] + 3, &keys.values[i * 3]);
+    }
+
+    AnimationCompressionStats channelStats;
+    channelStats.keysBefore = keyCount;
+    channelStats.keysAfter = kept.size();
+    channelStats.bytesBefore = channelBytes;
+    channelStats.bytesAfter = keptTimes.size() * sizeof(float) + keys.values.size() * sizeof(uint16_t);
+    (rotation ? channelStats.rotationError : channel.type == GLTFAnimationChannel::Translation ? channelStats.translationError : channelStats.scaleError) = maxError;
+    stats.Merge(channelStats);
+
+    channel.times.swap(keptTimes);
+    std::vector<DirectX::XMFLOAT3>().swap(channel.translations);
+    std::vector<DirectX::XMFLOAT4>().swap(channel.rotations);
+    std::vector<DirectX::XMFLOAT3>().swap(channel.scales);
+}
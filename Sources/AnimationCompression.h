@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+struct GLTFAnimationChannel;
+
+// Keys of a compressed channel, three 16-bit values per key. Translations and scales are
+// quantized relative to the channel's range (value = offset + q / 65535 * scale); rotations are
+// smallest-three: the three smaller components in the top 15 bits of each value, the index of the
+// dropped largest one in bit 0 of the first two.
+struct CompressedKeys
+{
+    std::vector<uint16_t> values;
+    float offset[3] = {};
+    float scale[3] = {};
+};
+
+// Largest magnitude of a non-largest quaternion component
+static const float SmallestThreeRange = 0.70710678f;
+
+// Decode one key into `result` (three floats, four for rotations)
+inline void DecodeKey(const CompressedKeys& keys, bool rotation, size_t key, float* result)
+{
+    const uint16_t* packed = keys.values.data() + key * 3;
+    if (!rotation)
+    {
+        for (uint32_t c = 0; c < 3; ++c)
+            result[c] = keys.offset[c] + packed[c] * (keys.scale[c] / 65535.0f);
+        return;
+    }
+
+    const uint32_t largest = (packed[0] & 1) | ((packed[1] & 1) << 1);
+    float sumSquares = 0.0f;
+    for (uint32_t c = 0, i = 0; c < 4; ++c)
+    {
+        if (c == largest)
+            continue;
+        const float value = ((packed[i++] >> 1) * (2.0f / 32767.0f) - 1.0f) * SmallestThreeRange;
+        result[c] = value;
+        sumSquares += value * value;
+    }
+    result[largest] = std::sqrt(std::max(0.0f, 1.0f - sumSquares));
+}
+
+struct AnimationCompressionSettings
+{
+    // Largest deviation from the source curve at any source key time
+    float rotationTolerance = 0.0005f;      // Radians
+    float translationTolerance = 0.0001f;   // Scene units
+    float scaleTolerance = 0.0001f;
+};
+
+struct AnimationCompressionStats
+{
+    uint64_t keysBefore = 0;
+    uint64_t keysAfter = 0;
+    uint64_t bytesBefore = 0;   // Times and values
+    uint64_t bytesAfter = 0;
+    // Largest reconstruction error at the source key times, per channel type
+    float rotationError = 0.0f;
+    float translationError = 0.0f;
+    float scaleError = 0.0f;
+    uint64_t uncompressedChannels = 0; // Left as floats: their 16-bit keys alone exceed the tolerance
+
+    void Merge(const AnimationCompressionStats& other);
+};
+
+// Quantize one channel's keys, then drop every key that interpolating its kept neighbours
+// reconstructs within tolerance. The float value arrays are released; times keep only the kept
+// keys. The first and last key always stay, so the clip keeps its duration. A channel whose
+// quantized keys would already exceed the tolerance is left uncompressed (and counted in the
+// stats). Thread-safe for distinct channels.
+void CompressAnimationChannel(GLTFAnimationChannel& channel, const AnimationCompressionSettings& settings, AnimationCompressionStats& stats);
@@ -0,0 +1,178 @@
+#include "AnimationSampling.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // Keys a frame may step over before the lookup switches to a binary search
+    const size_t MaxKeyframeSteps = 4;
+
+    // Copies the key into `result` (three floats, four for rotations), decoding compressed channels
+    void GetKeyValue(const GLTFAnimationChannel& channel, size_t key, float* result)
+    {
+        if (!channel.compressedKeys.values.empty())
+            DecodeKey(channel.compressedKeys, channel.type == GLTFAnimationChannel::Rotation, key, result);
+        else if (channel.type == GLTFAnimationChannel::Translation)
+            memcpy(result, &channel.translations[key], sizeof(DirectX::XMFLOAT3));
+        else if (channel.type == GLTFAnimationChannel::Rotation)
+            memcpy(result, &channel.rotations[key], sizeof(DirectX::XMFLOAT4));
+        else
+            memcpy(result, &channel.scales[key], sizeof(DirectX::XMFLOAT3));
+    }
+
+    DirectX::XMVECTOR LoadLanes(const std::vector<float>& lanes, size_t first)
+    {
+        return DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(lanes.data() + first));
+    }
+
+    void StoreLanes(std::vector<float>& lanes, size_t first, DirectX::FXMVECTOR value)
+    {
+        DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(lanes.data() + first), value);
+    }
+}
+
+size_t FindKeyframe(const std::vector<float>& times, float time, size_t& cursor)
+{
+    const size_t lastPair = times.size() - 2; // Callers ensure at least two keys
+    if (cursor > lastPair || time < times[cursor])
+    {
+        const size_t next = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+        cursor = std::min(next > 0 ? next - 1 : 0, lastPair);
+        return cursor;
+    }
+
+    for (size_t steps = 0; cursor < lastPair && time >= times[cursor + 1]; ++steps)
+    {
+        if (steps == MaxKeyframeSteps)
+        {
+            const size_t next = std::upper_bound(times.begin() + cursor + 1, times.end(), time) - times.begin();
+            cursor = std::min(next - 1, lastPair);
+            break;
+        }
+        ++cursor;
+    }
+    return cursor;
+}
+
+size_t GetKeyCount(const GLTFAnimationChannel& channel)
+{
+    const size_t valueCount = !channel.compressedKeys.values.empty() ? channel.compressedKeys.values.size() / 3
+        : channel.type == GLTFAnimationChannel::Translation ? channel.translations.size()
+        : channel.type == GLTFAnimationChannel::Rotation ? channel.rotations.size() : channel.scales.size();
+    return std::min(channel.times.size(), valueCount);
+}
+
+void PrepareAnimation(GLTFAnimation& animation)
+{
+    animation.duration = 0.0f;
+    animation.targetNodes.clear();
+    for (auto& channels : animation.typeChannels)
+        channels.clear();
+
+    for (size_t i = 0; i < animation.channels.size(); ++i)
+    {
+        const GLTFAnimationChannel& channel = animation.channels[i];
+        if (!channel.targetNode || GetKeyCount(channel) == 0)
+            continue;
+
+        animation.duration = std::max(animation.duration, channel.times.back());
+        animation.typeChannels[channel.type].push_back(static_cast<uint32_t>(i));
+        animation.targetNodes.push_back(channel.targetNode);
+    }
+    std::sort(animation.targetNodes.begin(), animation.targetNodes.end());
+    animation.targetNodes.erase(std::unique(animation.targetNodes.begin(), animation.targetNodes.end()), animation.targetNodes.end());
+}
+
+void GatherKeyframes(const GLTFAnimation& animation, GLTFAnimationChannel::Type type, float time, std::vector<size_t>& cursors, AnimationSampleLanes& lanes)
+{
+    const std::vector<uint32_t>& channels = animation.typeChannels[type];
+    const size_t laneCount = (channels.size() + 3) & ~size_t(3);
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        // Padding lanes hold identity values, which every path interpolates safely
+        lanes.from[c].assign(laneCount, c == 3 ? 1.0f : 0.0f);
+        lanes.to[c].assign(laneCount, c == 3 ? 1.0f : 0.0f);
+    }
+    lanes.factor.assign(laneCount, 0.0f);
+
+    const uint32_t components = type == GLTFAnimationChannel::Rotation ? 4 : 3;
+    for (size_t i = 0; i < channels.size(); ++i)
+    {
+        const GLTFAnimationChannel& channel = animation.channels[channels[i]];
+
+        // A single key holds its value
+        size_t key0 = 0, key1 = 0;
+        if (GetKeyCount(channel) > 1)
+        {
+            key0 = FindKeyframe(channel.times, time, cursors[channels[i]]);
+            key1 = key0 + 1;
+            const float t0 = channel.times[key0];
+            const float t1 = channel.times[key1];
+            lanes.factor[i] = t1 > t0 ? std::clamp((time - t0) / (t1 - t0), 0.0f, 1.0f) : 0.0f;
+        }
+
+        float from[4], to[4];
+        GetKeyValue(channel, key0, from);
+        GetKeyValue(channel, key1, to);
+        for (uint32_t c = 0; c < components; ++c)
+        {
+            lanes.from[c][i] = from[c];
+            lanes.to[c][i] = to[c];
+        }
+    }
+}
+
+void LerpLanes(AnimationSampleLanes& lanes, uint32_t components)
+{
+    for (size_t i = 0; i < lanes.factor.size(); i += 4)
+    {
+        const DirectX::XMVECTOR t = LoadLanes(lanes.factor, i);
+        for (uint32_t c = 0; c < components; ++c)
+            StoreLanes(lanes.from[c], i, DirectX::XMVectorLerpV(LoadLanes(lanes.from[c], i), LoadLanes(lanes.to[c], i), t));
+    }
+}
+
+void SlerpLanes(AnimationSampleLanes& lanes)
+{
+    using namespace DirectX;
+    const XMVECTOR one = XMVectorSplatOne();
+    const XMVECTOR lerpThreshold = XMVectorReplicate(0.9995f);
+    for (size_t i = 0; i < lanes.factor.size(); i += 4)
+    {
+        const XMVECTOR t = LoadLanes(lanes.factor, i);
+        XMVECTOR from[4], to[4];
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            from[c] = LoadLanes(lanes.from[c], i);
+            to[c] = LoadLanes(lanes.to[c], i);
+        }
+
+        XMVECTOR cosTheta = XMVectorMultiply(from[0], to[0]);
+        for (uint32_t c = 1; c < 4; ++c)
+            cosTheta = XMVectorMultiplyAdd(from[c], to[c], cosTheta);
+
+        // q and -q are the same rotation; flip `to` where that takes the shorter arc
+        const XMVECTOR sign = XMVectorAndInt(cosTheta, XMVectorSplatSignMask());
+        cosTheta = XMVectorXorInt(cosTheta, sign);
+        for (uint32_t c = 0; c < 4; ++c)
+            to[c] = XMVectorXorInt(to[c], sign);
+
+        const XMVECTOR theta = XMVectorACos(XMVectorMin(cosTheta, one));
+        const XMVECTOR sinTheta = XMVectorSin(theta);
+        const XMVECTOR oneMinusT = XMVectorSubtract(one, t);
+        const XMVECTOR useLerp = XMVectorGreater(cosTheta, lerpThreshold);
+        const XMVECTOR weight0 = XMVectorSelect(XMVectorDivide(XMVectorSin(XMVectorMultiply(oneMinusT, theta)), sinTheta), oneMinusT, useLerp);
+        const XMVECTOR weight1 = XMVectorSelect(XMVectorDivide(XMVectorSin(XMVectorMultiply(t, theta)), sinTheta), t, useLerp);
+
+        XMVECTOR result[4];
+        XMVECTOR lengthSq = XMVectorZero();
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            result[c] = XMVectorMultiplyAdd(from[c], weight0, XMVectorMultiply(to[c], weight1));
+            lengthSq = XMVectorMultiplyAdd(result[c], result[c], lengthSq);
+        }
+        const XMVECTOR invLength = XMVectorReciprocalSqrt(lengthSq);
+        for (uint32_t c = 0; c < 4; ++c)
+            StoreLanes(lanes.from[c], i, XMVectorMultiply(result[c], invLength));
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "SceneTypes.h"
+
+// Keyframe lookup and batched interpolation of animation channels. Samples of one channel type
+// are gathered into AnimationSampleLanes, then interpolated four channels at a time.
+
+// First key of the pair around time (clamped to the first and last pair). Forward playback
+// only moves the cursor by a key or two, so it is amortized O(1); seeks backwards, loops and
+// large jumps binary search instead.
+size_t FindKeyframe(const std::vector<float>& times, float time, size_t& cursor);
+
+// Keys of the channel, whether plain or compressed
+size_t GetKeyCount(const GLTFAnimationChannel& channel);
+
+// Duration, channels grouped by type and the set of target nodes. Channels without keys are
+// left out (LoadAnimations already drops paths other than translation, rotation and scale).
+void PrepareAnimation(GLTFAnimation& animation);
+
+// Find each channel's key pair at `time` and copy both keys and the blend factor into the lanes
+void GatherKeyframes(const GLTFAnimation& animation, GLTFAnimationChannel::Type type, float time, std::vector<size_t>& cursors, AnimationSampleLanes& lanes);
+
+// Translations and scales: per-component lerp of four channels at once
+void LerpLanes(AnimationSampleLanes& lanes, uint32_t components);
+
+// Rotations: shortest-arc slerp of four quaternions at once, falling back to lerp where the
+// keys are nearly parallel, then normalized
+void SlerpLanes(AnimationSampleLanes& lanes);
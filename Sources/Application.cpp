@@ -1,6 +1,7 @@
 #include "Application.h"
 #include <SDL.h>
 #include <SDL_syswm.h>
+#include <algorithm>
 #include <iostream>
 #define CGLTF_IMPLEMENTATION
 #include <cgltf.h>
@@ -8,6 +9,26 @@
 
 const char* WINDOW_TITLE = "TortureRed";
 
+namespace
+{
+    float GetElapsedMs(Uint64 startCounter)
+    {
+        return static_cast<float>((SDL_GetPerformanceCounter() - startCounter) * 1000.0 / SDL_GetPerformanceFrequency());
+    }
+
+    const char* GetLoadStateName(LoadState state)
+    {
+        switch (state)
+        {
+        case LoadState::Geometry: return "Loading geometry";
+        case LoadState::Textures: return "Uploading textures";
+        case LoadState::AccelerationStructures: return "Building acceleration structures";
+        case LoadState::Ready: return "Ready";
+        default: return "Failed";
+        }
+    }
+}
+
 Application::Application()
     : m_IsRunning(false)
     , m_Window(nullptr)
@@ -39,6 +60,8 @@ void Application::Run()
         lastTime = currentTime;
 
         ProcessEvents();
+        UpdateLoading();
+        UpdateUnloading();
         Update(deltaTime);
         Render();
 
@@ -51,6 +74,8 @@ void Application::Initialize()
 {
     // Initialize SDL
     CHECK_BOOL(SDL_Init(SDL_INIT_VIDEO) == 0, "SDL_Init failed");
+    m_StartCounter = SDL_GetPerformanceCounter();
+    LoadProfiler::Get(); // Stage times are relative to its creation
 
     // Create window
     m_Window = SDL_CreateWindow(
@@ -69,7 +94,12 @@ void Application::Initialize()
     SDL_GetWindowWMInfo(m_Window, &wmInfo);
     HWND hwnd = wmInfo.info.win.window;
 
-    CHECK_BOOL(m_Renderer.Initialize(hwnd), "Renderer initialization failed");
+    // Opt in to 16-byte compact vertices (quantized position, octahedral normal, half UV) with VertexFormat::Compact
+    m_Renderer.SetVertexFormat(VertexFormat::Full);
+    {
+        LoadProfiler::Scope scope("InitializeRenderer");
+        CHECK_BOOL(m_Renderer.Initialize(hwnd), "Renderer initialization failed");
+    }
 
     // Set camera projection parameters
     float aspectRatio = static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT;
@@ -82,18 +112,6 @@ void Application::Initialize()
     m_FrameConstants.enableAvoidCaustics = 1;
     m_FrameConstants.enableIndirectSpecular = 0;
 
-    // Load GLTF model
-    if (!m_Model.LoadGLTFModel(&m_Renderer, "Content/Sponza/Sponza.gltf"))
-    {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load GLTF model");
-    }
-
-    // Upload textures to GPU
-    m_Model.UploadTextures(m_Renderer.GetDevice(), m_Renderer.GetCommandList(), m_Renderer.GetCommandQueue(), m_Renderer.GetCommandAllocator(), &m_Renderer);
-
-    // Build ray tracing acceleration structures
-    m_Renderer.BuildAccelerationStructures(&m_Model);
-
     // Initialize ImGui
     InitializeImGui();
 
@@ -105,9 +123,136 @@ void Application::Initialize()
 
     m_LastViewMatrix = m_Camera.GetViewMatrix();
 
+    // Models share the scene's geometry, material and draw pools
+    CHECK_BOOL(m_Scene.Initialize(&m_Renderer), "Scene initialization failed");
+
+    // Load the first model in the background while frames keep running. Texture uploads record
+    // into their own command list so they never touch the frame's.
+    ID3D12Device* device = m_Renderer.GetDevice();
+    CHECK_HR(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_LoadCommandAllocator)), "Failed to create loading command allocator");
+    CHECK_HR(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_LoadCommandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_LoadCommandList)), "Failed to create loading command list");
+    m_LoadCommandList->Close();
+    m_LoadStartCounter = m_StartCounter;
+    StartLoading(m_LoadPathInput);
+
     std::cout << "TortureRed application initialized successfully!" << std::endl;
 }
 
+void Application::StartLoading(const std::string& path)
+{
+    // The model is created here so the frame loop can poll its progress; the loading thread owns it until Textures
+    m_LoadingPath = path;
+    m_LoadingModel = std::make_unique<Model>();
+    m_LoadingModel->SetPooled(true);
+    m_LoadingModelPtr = m_LoadingModel.get();
+    m_LoadingHandle = InvalidModelHandle;
+    m_LoadState = LoadState::Geometry;
+    m_ObservedLoadState = LoadState::Geometry;
+    std::fill(std::begin(m_LoadStateMs), std::end(m_LoadStateMs), 0.0f);
+    m_LoadProfileStart = LoadProfiler::Clock::now();
+    m_LoadThread = std::thread(&Application::LoadModel, this);
+}
+
+void Application::LoadModel()
+{
+    // Load GLTF model
+    Model* model = m_LoadingModelPtr;
+    if (!model->LoadGLTFModel(&m_Renderer, m_LoadingPath))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load GLTF model %s", m_LoadingPath.c_str());
+        m_LoadState = LoadState::Failed;
+        return;
+    }
+
+    // Fail before placing anything rather than run out of SRV slots halfway through the textures
+    if (m_Renderer.GetFreeDescriptorCount() < model->GetTextureDescriptorCount())
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Not enough free descriptors for the textures of %s", m_LoadingPath.c_str());
+        m_LoadState = LoadState::Failed;
+        return;
+    }
+
+    // Geometry and untextured materials go straight into the scene pools
+    if (!m_Scene.Place(*model, m_LoadingPlacement))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No room in the scene pools for %s", m_LoadingPath.c_str());
+        m_LoadState = LoadState::Failed;
+        return;
+    }
+    m_LoadState = LoadState::Textures;
+
+    // Upload textures to GPU
+    model->UploadTextures(m_Renderer.GetDevice(), m_LoadCommandList.Get(), m_Renderer.GetCommandQueue(), m_LoadCommandAllocator.Get(), &m_Renderer);
+    m_LoadState = LoadState::AccelerationStructures;
+}
+
+void Application::UpdateLoading()
+{
+    const LoadState state = m_LoadState.load();
+    if (state == m_ObservedLoadState)
+        return;
+
+    // Stages passed between two frames all get this frame's time
+    const float elapsedMs = GetElapsedMs(m_LoadStartCounter);
+    const size_t firstStage = state == LoadState::Failed ? static_cast<size_t>(state) : static_cast<size_t>(m_ObservedLoadState) + 1;
+    for (size_t stage = firstStage; stage <= static_cast<size_t>(state); ++stage)
+        m_LoadStateMs[stage] = elapsedMs;
+    m_ObservedLoadState = state;
+    std::cout << m_LoadingPath << ": " << GetLoadStateName(state) << " after " << elapsedMs << " ms" << std::endl;
+
+    // Start drawing the model as soon as its geometry is in the pools
+    if (state >= LoadState::Textures && state != LoadState::Failed && m_LoadingModel)
+        m_LoadingHandle = m_Scene.Add(std::move(m_LoadingModel), m_LoadingPlacement);
+
+    if (state != LoadState::AccelerationStructures && state != LoadState::Failed)
+        return;
+
+    // The loading thread is done
+    m_LoadThread.join();
+    m_LoadingModel.reset();
+    m_LoadingModelPtr = nullptr;
+
+    if (state == LoadState::Failed)
+        WriteLoadProfile();
+
+    if (state == LoadState::AccelerationStructures)
+    {
+        // Materials now point at the uploaded textures
+        m_Scene.UpdateMaterials(m_LoadingHandle);
+        m_Scene.FinishLoading(m_LoadingHandle);
+
+        // Records into the frame's command list, so it runs here between frames
+        m_Renderer.BuildAccelerationStructures(&m_Scene);
+        m_LoadState = LoadState::Ready;
+        m_ObservedLoadState = LoadState::Ready;
+        m_LoadStateMs[static_cast<size_t>(LoadState::Ready)] = GetElapsedMs(m_LoadStartCounter);
+        std::cout << m_LoadingPath << ": " << GetLoadStateName(LoadState::Ready) << " after " << m_LoadStateMs[static_cast<size_t>(LoadState::Ready)] << " ms" << std::endl;
+        WriteLoadProfile();
+    }
+}
+
+void Application::WriteLoadProfile()
+{
+    // Every load rewrites the report with all stages recorded since startup, so it can be diffed between runs
+    LoadProfiler& profiler = LoadProfiler::Get();
+    profiler.Record("LoadModel", m_LoadingPath, m_LoadProfileStart, LoadProfiler::Clock::now());
+    profiler.WriteReport("LoadProfile.json");
+    if (m_WriteLoadTrace)
+        profiler.WriteChromeTrace("LoadTrace.json");
+}
+
+void Application::UpdateUnloading()
+{
+    if (m_PendingUnload == InvalidModelHandle)
+        return;
+
+    // The GPU is idle between frames; the other models keep their pool ranges and BLASes
+    m_Scene.Remove(m_PendingUnload);
+    m_PendingUnload = InvalidModelHandle;
+    m_Renderer.BuildAccelerationStructures(&m_Scene);
+    m_FrameConstants.frameIndex = 0;
+}
+
 void Application::InitializeImGui()
 {
     // Create descriptor heap for ImGui
@@ -138,6 +283,10 @@ void Application::InitializeImGui()
 
 void Application::Shutdown()
 {
+    // Loading cannot be cancelled; let it finish before tearing down what it uses
+    if (m_LoadThread.joinable())
+        m_LoadThread.join();
+
     // Shutdown ImGui
     ImGui_ImplDX12_Shutdown();
     ImGui_ImplSDL2_Shutdown();
@@ -233,7 +382,7 @@ void Application::Update(float deltaTime)
     m_Camera.Update(deltaTime);
 
     // Update model animation
-    m_Model.UpdateAnimation(deltaTime);
+    m_Scene.UpdateAnimation(deltaTime);
 
     // Compute view-projection matrix
     DirectX::XMMATRIX view = m_Camera.GetViewMatrix();
@@ -302,9 +451,32 @@ void Application::Render()
     // Begin frame rendering
     m_Renderer.BeginFrame();
 
-    if (m_UsePathTracer && m_Renderer.IsRayTracingSupported())
+    // The scene draws every model it holds but streams, skins and culls only the loaded ones; a
+    // model still loading owns its textures, streamer and CPU data. The TLAS only covers loaded models.
+    const bool accelerationStructuresReady = m_Scene.GetLoadedModelCount() > 0;
+
+    // Stream texture mips for what the camera sees, ahead of every pass that samples them
     {
-        m_Renderer.DispatchRays(&m_Model, m_FrameConstants, m_MainLight);
+        DirectX::BoundingFrustum viewFrustum(m_Camera.GetProjMatrix(), false);
+        viewFrustum.Transform(viewFrustum, m_Camera.GetInvViewMatrix());
+        m_Scene.UpdateTextureStreaming(m_Renderer.GetCommandList(), viewFrustum, m_Camera.GetPosition(), m_Camera.GetFovY(), static_cast<float>(WINDOW_HEIGHT));
+        m_Scene.UpdateLods(m_Camera.GetPosition(), m_Camera.GetFovY(), static_cast<float>(WINDOW_HEIGHT));
+
+        // Skinned vertices land in the vertex pool ahead of every pass and every BLAS refit
+        m_Scene.UpdateSkinning(m_Renderer.GetCommandList(), m_SkinnedPrimitives);
+        m_Renderer.UpdateSkinnedAccelerationStructures(&m_Scene, m_SkinnedPrimitives);
+
+        if (m_CpuMeshletCulling)
+        {
+            const Uint64 cullStart = SDL_GetPerformanceCounter();
+            m_Scene.CullMeshlets(viewFrustum, m_Camera.GetPosition(), m_MeshletCullResult);
+            m_MeshletCullMs = static_cast<float>((SDL_GetPerformanceCounter() - cullStart) * 1000.0 / SDL_GetPerformanceFrequency());
+        }
+    }
+
+    if (m_UsePathTracer && m_Renderer.IsRayTracingSupported() && accelerationStructuresReady)
+    {
+        m_Renderer.DispatchRays(&m_Scene, m_FrameConstants, m_MainLight);
         m_Renderer.CopyTextureToBackBuffer(m_Renderer.GetPathTracerOutput());
 
         // Setup viewport and RTV for ImGui rendering on top of PT output
@@ -339,17 +511,7 @@ void Application::Render()
             // Temporarily bind light viewProj to root param 0 for shadow pass
             cmdList->SetGraphicsRootConstantBufferView(0, m_Renderer.GetLightGPUAddress());
 
-            // Calculate shadow frustum in world space
-            DirectX::XMVECTOR lightDir = DirectX::XMLoadFloat4(&m_MainLight.direction);
-            DirectX::XMVECTOR lightPos = DirectX::XMVectorScale(lightDir, -20.0f);
-            DirectX::XMMATRIX lightView = DirectX::XMMatrixLookToLH(lightPos, lightDir, DirectX::XMVectorSet(0, 1, 0, 0));
-            DirectX::XMMATRIX lightProj = DirectX::XMMatrixOrthographicLH(40.0f, 40.0f, 0.1f, 100.0f);
-            
-            DirectX::BoundingFrustum shadowFrustum(lightProj, false);
-            DirectX::XMMATRIX invLightView = DirectX::XMMatrixInverse(nullptr, lightView);
-            shadowFrustum.Transform(shadowFrustum, invLightView);
-
-            m_Model.Render(cmdList, &m_Renderer, shadowFrustum, AlphaMode::Opaque);
+            m_Scene.RenderShadowCasters(cmdList, &m_Renderer);
 
             m_Renderer.TransitionResource(shadowMap, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
         }
@@ -363,14 +525,6 @@ void Application::Render()
         // Restore camera viewProj to root param 0
         cmdList->SetGraphicsRootConstantBufferView(0, m_Renderer.GetFrameGPUAddress());
 
-        // Compute frustum for culling
-        DirectX::XMMATRIX proj = m_Camera.GetProjMatrix();
-        DirectX::BoundingFrustum frustum(proj, false);
-
-        // Transform frustum to world space (inverse view matrix)
-        DirectX::XMMATRIX invView = m_Camera.GetInvViewMatrix();
-        frustum.Transform(frustum, invView);
-
         // 1. Depth Pre-Pass
         if (m_EnableDepthPrePass)
         {
@@ -381,7 +535,7 @@ void Application::Render()
             cmdList->OMSetRenderTargets(0, nullptr, FALSE, &dsvHandle);
             cmdList->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
 
-            m_Model.Render(cmdList, &m_Renderer, frustum, AlphaMode::Opaque);
+            m_Scene.Render(cmdList, &m_Renderer, AlphaMode::Opaque);
         }
 
         // 2. G-Buffer Pass
@@ -413,8 +567,8 @@ void Application::Render()
             else
                 cmdList->SetPipelineState(m_Renderer.GetGBufferWritePSO());
 
-            m_Model.Render(cmdList, &m_Renderer, frustum, AlphaMode::Opaque);
-            m_Model.Render(cmdList, &m_Renderer, frustum, AlphaMode::Mask);
+            m_Scene.Render(cmdList, &m_Renderer, AlphaMode::Opaque);
+            m_Scene.Render(cmdList, &m_Renderer, AlphaMode::Mask);
         }
 
         // 3. Lighting Pass
@@ -454,7 +608,7 @@ void Application::Render()
             if (m_Renderer.GetPipelineState())
             {
                 cmdList->SetPipelineState(m_Renderer.GetPipelineState());
-                m_Model.Render(cmdList, &m_Renderer, frustum, AlphaMode::Blend);
+                m_Scene.Render(cmdList, &m_Renderer, AlphaMode::Blend);
             }
         }
     }
@@ -475,6 +629,12 @@ void Application::Render()
 
     // End frame rendering (includes present)
     m_Renderer.EndFrame();
+
+    if (m_FirstFrameMs == 0.0f)
+    {
+        m_FirstFrameMs = GetElapsedMs(m_StartCounter);
+        std::cout << "First frame presented after " << m_FirstFrameMs << " ms" << std::endl;
+    }
 }
 
 void Application::RenderImGui()
@@ -489,7 +649,11 @@ void Application::RenderImGui()
 
     ImGui::Checkbox("Debug Shadow Map", &m_DebugShadowMap);
 
-    if (m_Renderer.IsRayTracingSupported())
+    if (m_Renderer.IsRayTracingSupported() && m_Scene.GetLoadedModelCount() == 0)
+    {
+        ImGui::TextDisabled("Path Tracer (waiting for acceleration structures)");
+    }
+    else if (m_Renderer.IsRayTracingSupported())
     {
         if (ImGui::Checkbox("Use Path Tracer", &m_UsePathTracer))
         {
@@ -570,10 +734,177 @@ void Application::RenderImGui()
 
     ImGui::Text("FPS: %.1f", fps);
 
-    // Debug values from Model
-    ImGui::Text("Total Nodes Read: %zu", m_Model.GetTotalNodes());
-    ImGui::Text("Total Root Nodes: %zu", m_Model.GetTotalRootNodes());
-    ImGui::Text("Nodes Survive Frustum: %zu", m_Model.GetNodesSurviveFrustum());
+    // Background loading of the last requested model
+    ImGui::Text("Loading %s: %s", m_LoadingPath.c_str(), GetLoadStateName(m_ObservedLoadState));
+    ImGui::Indent();
+    if (m_ObservedLoadState == LoadState::Textures && m_LoadingModelPtr)
+    {
+        const size_t textureCount = m_LoadingModelPtr->GetTextureCount();
+        const size_t texturesUploaded = m_LoadingModelPtr->GetTexturesUploaded();
+        ImGui::ProgressBar(textureCount ? float(texturesUploaded) / float(textureCount) : 0.0f, ImVec2(-1.0f, 0.0f));
+        ImGui::Text("Textures: %zu / %zu", texturesUploaded, textureCount);
+    }
+    ImGui::Text("First Frame: %.1f ms", m_FirstFrameMs);
+    ImGui::Text("Geometry Resident: %.1f ms", m_LoadStateMs[static_cast<size_t>(LoadState::Textures)]);
+    ImGui::Text("Textures Resident: %.1f ms", m_LoadStateMs[static_cast<size_t>(LoadState::AccelerationStructures)]);
+    ImGui::Text("Ready: %.1f ms", m_LoadStateMs[static_cast<size_t>(LoadState::Ready)]);
+    ImGui::Unindent();
+
+    // Models and shared pools
+    ImGui::Separator();
+    ImGui::InputText("glTF", m_LoadPathInput, sizeof(m_LoadPathInput));
+    if (IsLoading())
+    {
+        ImGui::TextDisabled("Load (busy)");
+    }
+    else if (ImGui::Button("Load"))
+    {
+        m_LoadStartCounter = SDL_GetPerformanceCounter();
+        StartLoading(m_LoadPathInput);
+    }
+
+    ImGui::Text("Models: %zu, Draws: %zu", m_Scene.GetModelCount(), m_Scene.GetDrawCount());
+    ImGui::Indent();
+    for (size_t i = 0; i < m_Scene.GetModelCount(); ++i)
+    {
+        const Model* model = m_Scene.GetModel(i);
+        const ModelPlacement& placement = m_Scene.GetPlacement(i);
+        ImGui::PushID(static_cast<int>(m_Scene.GetHandle(i)));
+        ImGui::Text("#%u: %zu vertices @ %u, %zu draw nodes @ %u", m_Scene.GetHandle(i), model->GetVertexCount(), placement.vertexBase,
+            model->GetDrawNodeData().size(), placement.drawNodeBase);
+        // Unloading rebuilds the TLAS, which waits for a finished load
+        if (!IsLoading())
+        {
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Unload"))
+                m_PendingUnload = m_Scene.GetHandle(i);
+        }
+        ImGui::PopID();
+    }
+    ImGui::Unindent();
+
+    const char* poolNames[ScenePool_Count] = { "Vertices", "32-bit Indices", "16-bit Indices", "Materials", "Draw Nodes" };
+    for (uint32_t pool = 0; pool < ScenePool_Count; ++pool)
+    {
+        const RangeAllocator& allocator = m_Scene.GetPool(ScenePool(pool));
+        ImGui::Text("%s: %u / %u", poolNames[pool], allocator.GetUsed(), allocator.GetCapacity());
+    }
+
+    // Load stages summed since startup
+    if (ImGui::CollapsingHeader("Load Profile"))
+    {
+        for (const LoadStageTotal& total : LoadProfiler::Get().GetTotals())
+        {
+            if (total.bytes > 0)
+                ImGui::Text("%s: %.1f ms (%u), %.1f MB", total.name.c_str(), total.durationMs, total.count, total.bytes / (1024.0 * 1024.0));
+            else
+                ImGui::Text("%s: %.1f ms (%u)", total.name.c_str(), total.durationMs, total.count);
+        }
+        ImGui::Checkbox("Write Chrome Trace", &m_WriteLoadTrace);
+        if (ImGui::Button("Write Report"))
+        {
+            LoadProfiler::Get().WriteReport("LoadProfile.json");
+            if (m_WriteLoadTrace)
+                LoadProfiler::Get().WriteChromeTrace("LoadTrace.json");
+        }
+    }
+
+    // Model statistics read state a loading thread may still be writing
+    if (IsLoading() || m_Scene.GetModelCount() == 0)
+    {
+        ImGui::End();
+        return;
+    }
+
+    // Debug values summed over the models
+    size_t totalNodes = 0;
+    size_t totalRootNodes = 0;
+    size_t animationInstances = 0;
+    size_t animatedChannels = 0;
+    float animationSampleMs = 0.0f;
+    size_t skinInstances = 0;
+    size_t skinnedVertices = 0;
+    float skinningError = 0.0f;
+    ModelMemoryStats memoryStats;
+    TextureStreamingStats streamingStats;
+    for (size_t i = 0; i < m_Scene.GetModelCount(); ++i)
+    {
+        Model* model = m_Scene.GetModel(i);
+        totalNodes += model->GetTotalNodes();
+        totalRootNodes += model->GetTotalRootNodes();
+        animationInstances += model->GetAnimationInstanceCount();
+        animatedChannels += model->GetAnimatedChannelCount();
+        animationSampleMs += model->GetAnimationSampleMs();
+        skinInstances += model->GetSkinInstanceCount();
+        skinnedVertices += model->GetSkinnedVertexCount();
+        skinningError = std::max(skinningError, model->GetSkinningError());
+
+        const ModelMemoryStats modelMemory = model->GetMemoryStats();
+        memoryStats.geometryBytes += modelMemory.geometryBytes;
+        memoryStats.sceneCacheBytes += modelMemory.sceneCacheBytes;
+        memoryStats.gltfSourceBytes += modelMemory.gltfSourceBytes;
+        memoryStats.sceneBytes += modelMemory.sceneBytes;
+        memoryStats.animationBytes += modelMemory.animationBytes;
+
+        const TextureStreamingStats modelStreaming = model->GetTextureStreamer().GetStats();
+        streamingStats.textureCount += modelStreaming.textureCount;
+        streamingStats.fullyResidentCount += modelStreaming.fullyResidentCount;
+        streamingStats.residentBytes += modelStreaming.residentBytes;
+        streamingStats.uploadedBytes += modelStreaming.uploadedBytes;
+        streamingStats.pendingReads += modelStreaming.pendingReads;
+    }
+    ImGui::Text("Total Nodes Read: %zu", totalNodes);
+    ImGui::Text("Total Root Nodes: %zu", totalRootNodes);
+    ImGui::Text("Animation: %zu instances, %zu channels in %.3f ms (%.3f ms CPU)", animationInstances, animatedChannels, m_Scene.GetAnimationMs(), animationSampleMs);
+    if (skinInstances > 0)
+    {
+        ImGui::Text("Skinning: %zu nodes, %zu vertices in %.3f ms", skinInstances, skinnedVertices, m_Scene.GetSkinningMs());
+        bool validateSkinning = m_Scene.GetValidateSkinning();
+        if (ImGui::Checkbox("Validate Skinning", &validateSkinning))
+            m_Scene.SetValidateSkinning(validateSkinning);
+        if (validateSkinning)
+            ImGui::Text("Max error vs scalar reference: %g", skinningError);
+    }
+
+    // Per-draw LOD selection by projected simplification error
+    float lodErrorThreshold = m_Scene.GetLodErrorThreshold();
+    if (ImGui::SliderFloat("LOD Error (px)", &lodErrorThreshold, 0.0f, 8.0f))
+        m_Scene.SetLodErrorThreshold(lodErrorThreshold);
+    ImGui::Indent();
+    for (uint32_t lod = 0; lod < MaxLodCount; ++lod)
+        ImGui::Text("LOD%u Draws: %zu", lod, m_Scene.GetLodDrawCount(lod));
+    ImGui::Unindent();
+
+    // CPU reference for meshlet (cluster) culling
+    ImGui::Checkbox("CPU Meshlet Culling", &m_CpuMeshletCulling);
+    if (m_CpuMeshletCulling)
+    {
+        const MeshletCullStats& cullStats = m_MeshletCullResult.stats;
+        ImGui::Indent();
+        ImGui::Text("Meshlets: %zu tested, %zu frustum culled, %zu backface culled", cullStats.meshletsTested, cullStats.frustumCulled, cullStats.backfaceCulled);
+        ImGui::Text("Triangles: %zu / %zu visible", cullStats.trianglesVisible, cullStats.trianglesTotal);
+        ImGui::Text("Compacted: %zu indices, %zu draws (%.2f ms)", m_MeshletCullResult.indices.size(), m_MeshletCullResult.commands.size(), m_MeshletCullMs);
+        ImGui::Unindent();
+    }
+
+    // Resident CPU memory held by the models
+    const float toMB = 1.0f / (1024.0f * 1024.0f);
+    ImGui::Text("Model CPU Memory: %.2f MB", memoryStats.GetTotal() * toMB);
+    ImGui::Indent();
+    ImGui::Text("Geometry: %.2f MB", memoryStats.geometryBytes * toMB);
+    ImGui::Text("Scene Cache: %.2f MB", memoryStats.sceneCacheBytes * toMB);
+    ImGui::Text("glTF Source: %.2f MB", memoryStats.gltfSourceBytes * toMB);
+    ImGui::Text("Scene: %.2f MB", memoryStats.sceneBytes * toMB);
+    ImGui::Text("Animation: %.2f MB", memoryStats.animationBytes * toMB);
+    ImGui::Unindent();
+
+    // Texture mip streaming
+    ImGui::Text("Streamed Textures: %zu (%zu fully resident)", streamingStats.textureCount, streamingStats.fullyResidentCount);
+    ImGui::Indent();
+    ImGui::Text("Resident: %.2f MB", streamingStats.residentBytes * toMB);
+    ImGui::Text("Uploaded This Frame: %.2f MB", streamingStats.uploadedBytes * toMB);
+    ImGui::Text("Pending Reads: %zu", streamingStats.pendingReads);
+    ImGui::Unindent();
 
     ImGui::End();
 }
\ No newline at end of file
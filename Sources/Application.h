@@ -9,12 +9,28 @@
 #include <imgui.h>
 #include <imgui_impl_dx12.h>
 #include <imgui_impl_sdl2.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
 
 #include "Utility.h"
 #include "Camera.h"
 #include "Model.h"
 #include "Renderer.h"
+#include "Scene.h"
+#include "LoadProfiler.h"
 
+// Background model loading stages, in order. Frames draw the model from Textures on.
+enum class LoadState
+{
+    Geometry,               // Parsing the glTF and uploading vertices and indices
+    Textures,               // Geometry resident; textures uploading on the loading thread
+    AccelerationStructures, // Textures resident; the frame loop builds the BLAS/TLAS next
+    Ready,
+    Failed,
+    Count
+};
 
 class Application
 {
@@ -34,17 +50,49 @@ private:
     void InitializeImGui();
     void RenderImGui();
 
+    void StartLoading(const std::string& path);
+    void LoadModel(); // Loading thread
+    void UpdateLoading();
+    void UpdateUnloading();
+    void WriteLoadProfile();
+    bool IsLoading() const { return m_LoadThread.joinable(); }
+
     bool m_IsRunning;
     bool m_EnableDepthPrePass = false;
     bool m_DebugShadowMap = false;
     bool m_UsePathTracer = false;
     float m_SunIntensity = 1.0f;
     float m_Exposure = 1.0f;
+    bool m_CpuMeshletCulling = false; // Run the CPU meshlet culling reference each frame (stats only)
+    MeshletCullResult m_MeshletCullResult;
+    std::vector<SkinnedPrimitive> m_SkinnedPrimitives; // Rewritten by this frame's skinning, for the BLAS refits
+    float m_MeshletCullMs = 0.0f;
     SDL_Window* m_Window;
 
+    // Background loading, one model at a time. The loading thread only advances m_LoadState; the
+    // frame loop acts on the state it last observed, so a stage's effects are visible for the whole frame.
+    std::thread m_LoadThread;
+    std::string m_LoadingPath;
+    std::unique_ptr<Model> m_LoadingModel;  // Until the frame loop adds it to the scene
+    Model* m_LoadingModelPtr = nullptr;     // Stays valid for the loading thread once the scene owns the model
+    ModelPlacement m_LoadingPlacement;
+    ModelHandle m_LoadingHandle = InvalidModelHandle;
+    ModelHandle m_PendingUnload = InvalidModelHandle; // Removed between frames
+    char m_LoadPathInput[260] = "Content/Sponza/Sponza.gltf";
+    std::atomic<LoadState> m_LoadState{ LoadState::Geometry };
+    LoadState m_ObservedLoadState = LoadState::Geometry;
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_LoadCommandAllocator;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_LoadCommandList;
+    Uint64 m_StartCounter = 0;
+    Uint64 m_LoadStartCounter = 0;
+    float m_FirstFrameMs = 0.0f;                                              // Since Initialize began
+    float m_LoadStateMs[static_cast<size_t>(LoadState::Count)] = {};          // When each stage of the last load was reached
+    LoadProfiler::Clock::time_point m_LoadProfileStart;                        // Start of the "LoadModel" stage
+    bool m_WriteLoadTrace = false;                                            // Also write a Chrome trace after each load
+
     // Core systems
     Renderer m_Renderer;
-    Model m_Model;
+    Scene m_Scene;
     Camera m_Camera;
     DirectX::XMMATRIX m_ViewProj;
     DirectX::XMMATRIX m_LastViewMatrix;
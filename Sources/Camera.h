@@ -22,6 +22,7 @@ public:
     // Projection matrix
     void SetProjectionParameters(float fovY, float aspectRatio, float nearZ, float farZ);
     DirectX::XMMATRIX GetProjMatrix() const;
+    float GetFovY() const { return m_FovY; }
     DirectX::XMMATRIX GetInvViewMatrix() const;
 
     // Camera control state
@@ -0,0 +1,405 @@
+#include "GLTFDecoding.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include <meshoptimizer.h>
+
+namespace
+{
+    const uint8_t* GetAccessorData(const cgltf_accessor* accessor)
+    {
+        const cgltf_buffer_view* view = accessor->buffer_view;
+        if (!view)
+            return nullptr;
+
+        const uint8_t* viewData = view->data
+            ? static_cast<const uint8_t*>(view->data)
+            : (view->buffer->data ? static_cast<const uint8_t*>(view->buffer->data) + view->offset : nullptr);
+        return viewData ? viewData + accessor->offset : nullptr;
+    }
+
+    // Convert 8/16-bit components (KHR_mesh_quantization) straight out of the buffer. Normalized
+    // values follow the glTF rules: c / max for unsigned, max(c / max, -1) for signed.
+    template <typename Component>
+    void ConvertComponents(const uint8_t* src, size_t srcStride, size_t count, size_t components, bool normalized, float* dst, size_t dstStride)
+    {
+        const float scale = normalized ? 1.0f / float(std::numeric_limits<Component>::max()) : 1.0f;
+        const float lowest = normalized ? -1.0f : -FLT_MAX;
+        uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+        for (size_t k = 0; k < count; ++k)
+        {
+            float* values = reinterpret_cast<float*>(out);
+            for (size_t c = 0; c < components; ++c)
+            {
+                Component value;
+                memcpy(&value, src + c * sizeof(Component), sizeof(value));
+                values[c] = std::max(float(value) * scale, lowest);
+            }
+            src += srcStride;
+            out += dstStride;
+        }
+    }
+
+    // Read `components` floats per element into a strided destination.
+    // Plain float and quantized 8/16-bit accessors are converted straight out of the buffer;
+    // everything else (sparse accessors, odd layouts) goes through cgltf in one bulk unpack.
+    bool ReadFloats(const cgltf_accessor* accessor, cgltf_size components, float* dst, size_t dstStride)
+    {
+        const size_t count = accessor->count;
+        const uint8_t* src = GetAccessorData(accessor);
+
+        if (src && !accessor->is_sparse && accessor->component_type == cgltf_component_type_r_32f &&
+            cgltf_num_components(accessor->type) == components)
+        {
+            const size_t srcStride = accessor->stride;
+            uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+            for (size_t k = 0; k < count; ++k)
+            {
+                memcpy(out, src, components * sizeof(float));
+                src += srcStride;
+                out += dstStride;
+            }
+            return true;
+        }
+
+        const cgltf_size srcComponents = cgltf_num_components(accessor->type);
+        if (srcComponents < components)
+            return false;
+
+        if (src && !accessor->is_sparse)
+        {
+            const size_t srcStride = accessor->stride;
+            const bool normalized = accessor->normalized != 0;
+            switch (accessor->component_type)
+            {
+            case cgltf_component_type_r_8:
+                ConvertComponents<int8_t>(src, srcStride, count, components, normalized, dst, dstStride);
+                return true;
+            case cgltf_component_type_r_8u:
+                ConvertComponents<uint8_t>(src, srcStride, count, components, normalized, dst, dstStride);
+                return true;
+            case cgltf_component_type_r_16:
+                ConvertComponents<int16_t>(src, srcStride, count, components, normalized, dst, dstStride);
+                return true;
+            case cgltf_component_type_r_16u:
+                ConvertComponents<uint16_t>(src, srcStride, count, components, normalized, dst, dstStride);
+                return true;
+            default:
+                break;
+            }
+        }
+
+        std::vector<float> unpacked(count * srcComponents);
+        if (cgltf_accessor_unpack_floats(accessor, unpacked.data(), unpacked.size()) != unpacked.size())
+            return false;
+
+        uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+        for (size_t k = 0; k < count; ++k)
+        {
+            memcpy(out, &unpacked[k * srcComponents], components * sizeof(float));
+            out += dstStride;
+        }
+        return true;
+    }
+
+    // IndexType is uint32_t, or uint16_t for primitives small enough for the 16-bit pool
+    template <typename IndexType>
+    bool ReadIndices(const cgltf_accessor* accessor, IndexType* dst)
+    {
+        const size_t count = accessor->count;
+        const uint8_t* src = GetAccessorData(accessor);
+
+        if (!src || accessor->is_sparse)
+        {
+            for (size_t k = 0; k < count; ++k)
+                dst[k] = static_cast<IndexType>(cgltf_accessor_read_index(accessor, k));
+            return true;
+        }
+
+        const size_t stride = accessor->stride;
+        switch (accessor->component_type)
+        {
+        case cgltf_component_type_r_8u:
+            for (size_t k = 0; k < count; ++k)
+                dst[k] = src[k * stride];
+            return true;
+        case cgltf_component_type_r_16u:
+            for (size_t k = 0; k < count; ++k)
+            {
+                uint16_t v;
+                memcpy(&v, src + k * stride, sizeof(v));
+                dst[k] = v;
+            }
+            return true;
+        case cgltf_component_type_r_32u:
+            for (size_t k = 0; k < count; ++k)
+            {
+                uint32_t v;
+                memcpy(&v, src + k * stride, sizeof(v));
+                dst[k] = static_cast<IndexType>(v);
+            }
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+bool DecodeMeshoptBuffers(cgltf_data* data, bool parallel, MeshoptDecodeStats& stats)
+{
+    std::vector<cgltf_buffer_view*> views;
+    for (size_t i = 0; i < data->buffer_views_count; ++i)
+    {
+        cgltf_buffer_view* view = &data->buffer_views[i];
+        if (!view->has_meshopt_compression || view->data)
+            continue;
+
+        const cgltf_meshopt_compression& compression = view->meshopt_compression;
+        if (!compression.buffer || !compression.buffer->data)
+        {
+            std::cerr << "EXT_meshopt_compression source buffer is not loaded" << std::endl;
+            return false;
+        }
+
+        const size_t decodedSize = compression.count * compression.stride;
+        view->data = data->memory.alloc_func(data->memory.user_data, decodedSize);
+        if (!view->data)
+            return false;
+
+        views.push_back(view);
+        stats.compressedBytes += compression.size;
+        stats.decodedBytes += decodedSize;
+    }
+    stats.views = views.size();
+
+    std::atomic<bool> failed{ false };
+    auto decodeView = [&](size_t index)
+    {
+        const cgltf_meshopt_compression& compression = views[index]->meshopt_compression;
+        const unsigned char* source = static_cast<const unsigned char*>(compression.buffer->data) + compression.offset;
+        void* destination = views[index]->data;
+
+        int result = -1;
+        switch (compression.mode)
+        {
+        case cgltf_meshopt_compression_mode_attributes:
+            result = meshopt_decodeVertexBuffer(destination, compression.count, compression.stride, source, compression.size);
+            break;
+        case cgltf_meshopt_compression_mode_triangles:
+            result = meshopt_decodeIndexBuffer(destination, compression.count, compression.stride, source, compression.size);
+            break;
+        case cgltf_meshopt_compression_mode_indices:
+            result = meshopt_decodeIndexSequence(destination, compression.count, compression.stride, source, compression.size);
+            break;
+        default:
+            break;
+        }
+        if (result != 0)
+        {
+            failed = true;
+            return;
+        }
+
+        switch (compression.filter)
+        {
+        case cgltf_meshopt_compression_filter_octahedral:
+            meshopt_decodeFilterOct(destination, compression.count, compression.stride);
+            break;
+        case cgltf_meshopt_compression_filter_quaternion:
+            meshopt_decodeFilterQuat(destination, compression.count, compression.stride);
+            break;
+        case cgltf_meshopt_compression_filter_exponential:
+            meshopt_decodeFilterExp(destination, compression.count, compression.stride);
+            break;
+        default:
+            break;
+        }
+    };
+
+    if (parallel)
+    {
+        JobSystem::Get().ParallelFor(views.size(), decodeView);
+    }
+    else
+    {
+        for (size_t i = 0; i < views.size(); ++i)
+            decodeView(i);
+    }
+    return !failed;
+}
+
+const cgltf_accessor* FindAttribute(const cgltf_primitive* primitive, cgltf_attribute_type type)
+{
+    for (size_t k = 0; k < primitive->attributes_count; ++k)
+    {
+        const cgltf_attribute* attribute = &primitive->attributes[k];
+        if (attribute->type == type && attribute->index == 0)
+            return attribute->data;
+    }
+    return nullptr;
+}
+
+
+void SizePrimitive(const cgltf_primitive* primitive, GLTFPrimitive& gltfPrim)
+{
+    const cgltf_accessor* positionAccessor = FindAttribute(primitive, cgltf_attribute_type_position);
+    if (!positionAccessor)
+        std::cerr << "GLTF mesh missing position data" << std::endl;
+
+    gltfPrim.vertexCount = positionAccessor ? static_cast<uint32_t>(positionAccessor->count) : 0;
+    gltfPrim.indexCount = (gltfPrim.vertexCount > 0 && primitive->indices) ? static_cast<uint32_t>(primitive->indices->count) : 0;
+    // Indices are primitive-local (vertex pulling adds vertexOffset), so they fit 16 bits up to 65536 vertices
+    gltfPrim.indexPool = gltfPrim.vertexCount <= 65536 ? IndexPool_16 : IndexPool_32;
+
+    // Skinned primitives also keep their bind pose and influences for per-frame skinning
+    const cgltf_accessor* jointAccessor = FindAttribute(primitive, cgltf_attribute_type_joints);
+    const cgltf_accessor* weightAccessor = FindAttribute(primitive, cgltf_attribute_type_weights);
+    gltfPrim.skinned = gltfPrim.vertexCount > 0 && jointAccessor && weightAccessor &&
+        jointAccessor->count == gltfPrim.vertexCount && weightAccessor->count == gltfPrim.vertexCount;
+}
+
+bool DecodePrimitive(const cgltf_data* data, const cgltf_primitive* primitive, GLTFPrimitive& gltfPrim, GLTFVertex* vertices, void* indices)
+{
+    // Process material
+    if (primitive->material)
+    {
+        const cgltf_material* material = primitive->material;
+        gltfPrim.materialIndex = static_cast<uint32_t>(material - data->materials);
+
+        // Set alpha mode
+        if (material->alpha_mode == cgltf_alpha_mode_opaque)
+            gltfPrim.alphaMode = AlphaMode::Opaque;
+        else if (material->alpha_mode == cgltf_alpha_mode_mask)
+            gltfPrim.alphaMode = AlphaMode::Mask;
+        else if (material->alpha_mode == cgltf_alpha_mode_blend)
+            gltfPrim.alphaMode = AlphaMode::Blend;
+    }
+
+    // Process attributes
+    const cgltf_accessor* positionAccessor = FindAttribute(primitive, cgltf_attribute_type_position);
+    const cgltf_accessor* normalAccessor = FindAttribute(primitive, cgltf_attribute_type_normal);
+    const cgltf_accessor* texCoordAccessor = FindAttribute(primitive, cgltf_attribute_type_texcoord);
+
+    // Read vertices
+    const size_t vertexCount = gltfPrim.vertexCount;
+    if (vertexCount == 0)
+        return true; // Skipped by the sizing pass
+
+    if (!ReadFloats(positionAccessor, 3, vertices[0].position, sizeof(GLTFVertex)))
+    {
+        std::cerr << "Failed to read position data from GLTF buffer" << std::endl;
+        return false;
+    }
+
+    // Compute AABB. Bounds of normalized (quantized) positions are stored in integer units.
+    DirectX::XMFLOAT3 minPos, maxPos;
+    if (positionAccessor->has_min && positionAccessor->has_max && !positionAccessor->normalized)
+    {
+        minPos = { positionAccessor->min[0], positionAccessor->min[1], positionAccessor->min[2] };
+        maxPos = { positionAccessor->max[0], positionAccessor->max[1], positionAccessor->max[2] };
+    }
+    else
+    {
+        minPos = { FLT_MAX, FLT_MAX, FLT_MAX };
+        maxPos = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (size_t k = 0; k < vertexCount; ++k)
+        {
+            const float* p = vertices[k].position;
+            minPos.x = std::min(minPos.x, p[0]);
+            minPos.y = std::min(minPos.y, p[1]);
+            minPos.z = std::min(minPos.z, p[2]);
+            maxPos.x = std::max(maxPos.x, p[0]);
+            maxPos.y = std::max(maxPos.y, p[1]);
+            maxPos.z = std::max(maxPos.z, p[2]);
+        }
+    }
+    DirectX::XMFLOAT3 center = {
+        (minPos.x + maxPos.x) * 0.5f,
+        (minPos.y + maxPos.y) * 0.5f,
+        (minPos.z + maxPos.z) * 0.5f
+    };
+    DirectX::XMFLOAT3 extents = {
+        (maxPos.x - minPos.x) * 0.5f,
+        (maxPos.y - minPos.y) * 0.5f,
+        (maxPos.z - minPos.z) * 0.5f
+    };
+    gltfPrim.aabb = DirectX::BoundingBox(center, extents);
+
+    // Read normals (if available), otherwise generate defaults
+    if (!normalAccessor || !ReadFloats(normalAccessor, 3, vertices[0].normal, sizeof(GLTFVertex)))
+    {
+        for (size_t k = 0; k < vertexCount; ++k)
+        {
+            vertices[k].normal[0] = 0.0f;
+            vertices[k].normal[1] = 1.0f;
+            vertices[k].normal[2] = 0.0f;
+        }
+    }
+
+    // Read texture coordinates (if available), otherwise generate defaults
+    if (!texCoordAccessor || !ReadFloats(texCoordAccessor, 2, vertices[0].texCoord, sizeof(GLTFVertex)))
+    {
+        for (size_t k = 0; k < vertexCount; ++k)
+        {
+            vertices[k].texCoord[0] = 0.0f;
+            vertices[k].texCoord[1] = 0.0f;
+        }
+    }
+
+    // Read indices
+    if (gltfPrim.indexCount > 0)
+    {
+        const bool indicesRead = gltfPrim.indexPool == IndexPool_16
+            ? ReadIndices(primitive->indices, static_cast<uint16_t*>(indices))
+            : ReadIndices(primitive->indices, static_cast<uint32_t*>(indices));
+        if (!indicesRead)
+        {
+            std::cerr << "Failed to read index data from GLTF buffer" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DecodeSkinVertices(const cgltf_primitive* primitive, const GLTFVertex* vertices, size_t vertexCount, SkinVertex* skinVertices)
+{
+    const cgltf_accessor* jointAccessor = FindAttribute(primitive, cgltf_attribute_type_joints);
+    const cgltf_accessor* weightAccessor = FindAttribute(primitive, cgltf_attribute_type_weights);
+    if (!ReadFloats(weightAccessor, 4, skinVertices[0].weights, sizeof(SkinVertex)))
+        return false;
+
+    for (size_t k = 0; k < vertexCount; ++k)
+    {
+        SkinVertex& skinVertex = skinVertices[k];
+        skinVertex.bindPose = vertices[k];
+
+        cgltf_uint joints[4] = {};
+        if (!cgltf_accessor_read_uint(jointAccessor, k, joints, 4))
+            return false;
+
+        float weightSum = 0.0f;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            skinVertex.joints[i] = static_cast<uint16_t>(std::min<cgltf_uint>(joints[i], UINT16_MAX));
+            skinVertex.weights[i] = std::max(skinVertex.weights[i], 0.0f);
+            weightSum += skinVertex.weights[i];
+        }
+        if (weightSum > 0.0f)
+        {
+            for (uint32_t i = 0; i < 4; ++i)
+                skinVertex.weights[i] /= weightSum;
+        }
+        else
+        {
+            skinVertex.joints[0] = 0;
+            skinVertex.weights[0] = 1.0f;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cgltf.h>
+#include "SceneTypes.h"
+
+// Geometry decode of a parsed glTF, shared by Model::LoadGLTFModel and the decode benchmark.
+// Nothing here touches D3D12, so it builds without a GPU.
+
+struct MeshoptDecodeStats
+{
+    size_t views = 0;
+    size_t compressedBytes = 0;
+    size_t decodedBytes = 0;
+};
+
+// EXT_meshopt_compression: decode every compressed buffer view with meshoptimizer's SIMD
+// codecs. The result goes to view->data, which accessors read instead of the (fallback)
+// buffer and which cgltf_free releases. Views decode independently on the workers.
+bool DecodeMeshoptBuffers(cgltf_data* data, bool parallel, MeshoptDecodeStats& stats);
+
+// First attribute set of `type`, or null
+const cgltf_accessor* FindAttribute(const cgltf_primitive* primitive, cgltf_attribute_type type);
+
+// Sizing pass: vertex and index counts, index pool and whether the primitive is skinned. The
+// caller lays out the global offsets.
+void SizePrimitive(const cgltf_primitive* primitive, GLTFPrimitive& gltfPrim);
+
+// Decode one glTF primitive (positions, normals, UVs, indices, AABB) into its slice of the
+// global arrays. Counts come from SizePrimitive. Thread-safe: touches only the cgltf data
+// (read-only), its own GLTFPrimitive and its own slices.
+bool DecodePrimitive(const cgltf_data* data, const cgltf_primitive* primitive, GLTFPrimitive& gltfPrim, GLTFVertex* vertices, void* indices);
+
+// Copy a decoded skinned primitive's bind pose and read its first joint/weight set.
+// Quantized weights rarely sum to exactly one, so they are renormalized; a vertex without
+// any weight follows joint 0. Thread-safe like DecodePrimitive.
+bool DecodeSkinVertices(const cgltf_primitive* primitive, const GLTFVertex* vertices, size_t vertexCount, SkinVertex* skinVertices);
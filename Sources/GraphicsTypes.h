@@ -19,6 +19,13 @@ struct Reservoir
     DirectX::XMFLOAT3 primaryPos;
 };
 
+// Layout of the global vertex buffer that shaders pull from
+enum class VertexFormat
+{
+    Full,   // GLTFVertex, 32 bytes
+    Compact // CompactVertex, 16 bytes: AABB-quantized position, octahedral normal, half UV
+};
+
 struct GPUResource
 {
     Microsoft::WRL::ComPtr<ID3D12Resource> resource;
@@ -0,0 +1,134 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <memory>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <objbase.h>
+#endif
+
+JobSystem& JobSystem::Get()
+{
+    // Leave one hardware thread for the main loop
+    static JobSystem instance(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return instance;
+}
+
+JobSystem::JobSystem(size_t workerCount)
+{
+    m_Workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i)
+    {
+        m_Workers.emplace_back(&JobSystem::WorkerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+        m_Stopping = true;
+    }
+    m_QueueCondition.notify_all();
+
+    for (auto& worker : m_Workers)
+    {
+        worker.join();
+    }
+}
+
+void JobSystem::Submit(std::function<void(void)> job)
+{
+    if (m_Workers.empty())
+    {
+        job();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+        m_Queue.push_back(std::move(job));
+    }
+    m_QueueCondition.notify_one();
+}
+
+void JobSystem::ParallelFor(size_t count, const std::function<void(size_t)>& fn)
+{
+    if (count == 0)
+        return;
+
+    if (count == 1 || m_Workers.empty())
+    {
+        for (size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+
+    // Shared so helpers that start after we return never touch a dead stack frame
+    struct ParallelForState
+    {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> done{ 0 };
+        size_t count = 0;
+        const std::function<void(size_t)>* fn = nullptr;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    auto state = std::make_shared<ParallelForState>();
+    state->count = count;
+    state->fn = &fn;
+
+    auto drain = [](ParallelForState& s)
+    {
+        size_t completed = 0;
+        for (size_t i = s.next.fetch_add(1); i < s.count; i = s.next.fetch_add(1))
+        {
+            (*s.fn)(i);
+            ++completed;
+        }
+        if (completed > 0 && s.done.fetch_add(completed) + completed == s.count)
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.finished.notify_all();
+        }
+    };
+
+    const size_t helpers = std::min(m_Workers.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        Submit([state, drain]() { drain(*state); });
+    }
+
+    drain(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&]() { return state->done.load() == state->count; });
+}
+
+void JobSystem::WorkerLoop()
+{
+#ifdef _WIN32
+    // Jobs decode images through WIC, which needs COM initialized on the calling thread
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+#endif
+
+    for (;;)
+    {
+        std::function<void(void)> job;
+        {
+            std::unique_lock<std::mutex> lock(m_QueueMutex);
+            m_QueueCondition.wait(lock, [this]() { return m_Stopping || !m_Queue.empty(); });
+            if (m_Stopping && m_Queue.empty())
+                break;
+            job = std::move(m_Queue.front());
+            m_Queue.pop_front();
+        }
+        job();
+    }
+
+#ifdef _WIN32
+    CoUninitialize();
+#endif
+}
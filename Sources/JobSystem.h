@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool shared by the loaders and per-frame CPU work
+class JobSystem
+{
+public:
+    static JobSystem& Get();
+
+    explicit JobSystem(size_t workerCount);
+    ~JobSystem();
+
+    // Queue a job for a worker thread
+    void Submit(std::function<void(void)> job);
+
+    // Run fn(i) for every i in [0, count) across the workers and block until all are done.
+    // The calling thread takes part, so nested ParallelFor calls cannot deadlock.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    size_t GetWorkerCount() const { return m_Workers.size(); }
+
+    // Prevent copying
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> m_Workers;
+    std::deque<std::function<void(void)>> m_Queue;
+    std::mutex m_QueueMutex;
+    std::condition_variable m_QueueCondition;
+    bool m_Stopping = false;
+};
@@ -0,0 +1,169 @@
+#include "LoadProfiler.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    std::atomic<uint32_t> g_NextThreadIndex{ 0 };
+    thread_local uint32_t t_ThreadIndex = UINT32_MAX;
+    thread_local uint32_t t_ScopeDepth = 0;
+
+    uint32_t GetThreadIndex()
+    {
+        if (t_ThreadIndex == UINT32_MAX)
+            t_ThreadIndex = g_NextThreadIndex++;
+        return t_ThreadIndex;
+    }
+
+    // Model paths may hold backslashes and quotes
+    std::string EscapeJson(const std::string& text)
+    {
+        std::string result;
+        result.reserve(text.size());
+        for (char c : text)
+        {
+            switch (c)
+            {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    continue;
+                result += c;
+                break;
+            }
+        }
+        return result;
+    }
+}
+
+LoadProfiler& LoadProfiler::Get()
+{
+    static LoadProfiler instance;
+    return instance;
+}
+
+LoadProfiler::LoadProfiler()
+    : m_Epoch(Clock::now())
+{
+}
+
+LoadProfiler::Scope::Scope(const char* name, std::string label)
+    : m_Name(name)
+    , m_Label(std::move(label))
+    , m_Start(Clock::now())
+    , m_Depth(t_ScopeDepth++)
+{
+}
+
+LoadProfiler::Scope::~Scope()
+{
+    --t_ScopeDepth;
+    LoadProfiler::Get().Add(m_Name, m_Label, m_Start, Clock::now(), m_Bytes, m_Depth);
+}
+
+void LoadProfiler::Record(const char* name, const std::string& label, Clock::time_point start, Clock::time_point end, uint64_t bytes)
+{
+    Add(name, label, start, end, bytes, t_ScopeDepth);
+}
+
+void LoadProfiler::Add(const char* name, const std::string& label, Clock::time_point start, Clock::time_point end, uint64_t bytes, uint32_t depth)
+{
+    LoadStageRecord record;
+    record.name = name;
+    record.label = label;
+    record.thread = GetThreadIndex();
+    record.depth = depth;
+    record.startMs = std::chrono::duration<double, std::milli>(start - m_Epoch).count();
+    record.durationMs = std::chrono::duration<double, std::milli>(end - start).count();
+    record.bytes = bytes;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Records.push_back(std::move(record));
+}
+
+std::vector<LoadStageRecord> LoadProfiler::GetRecords() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Records;
+}
+
+std::vector<LoadStageTotal> LoadProfiler::GetTotals() const
+{
+    std::vector<LoadStageTotal> totals;
+    for (const LoadStageRecord& record : GetRecords())
+    {
+        auto it = std::find_if(totals.begin(), totals.end(), [&](const LoadStageTotal& total) { return total.name == record.name; });
+        if (it == totals.end())
+        {
+            totals.push_back({ record.name });
+            it = totals.end() - 1;
+        }
+        ++it->count;
+        it->durationMs += record.durationMs;
+        it->bytes += record.bytes;
+    }
+    return totals;
+}
+
+bool LoadProfiler::WriteReport(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Failed to write load profile: " << path << std::endl;
+        return false;
+    }
+
+    const std::vector<LoadStageRecord> records = GetRecords();
+    file << "{\n  \"version\": 1,\n  \"records\": [";
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const LoadStageRecord& record = records[i];
+        file << (i ? ",\n" : "\n") << "    { \"name\": \"" << EscapeJson(record.name) << "\", \"label\": \"" << EscapeJson(record.label)
+            << "\", \"thread\": " << record.thread << ", \"depth\": " << record.depth << ", \"startMs\": " << record.startMs
+            << ", \"durationMs\": " << record.durationMs << ", \"bytes\": " << record.bytes << " }";
+    }
+
+    const std::vector<LoadStageTotal> totals = GetTotals();
+    file << "\n  ],\n  \"totals\": [";
+    for (size_t i = 0; i < totals.size(); ++i)
+    {
+        const LoadStageTotal& total = totals[i];
+        file << (i ? ",\n" : "\n") << "    { \"name\": \"" << EscapeJson(total.name) << "\", \"count\": " << total.count
+            << ", \"durationMs\": " << total.durationMs << ", \"bytes\": " << total.bytes << " }";
+    }
+    file << "\n  ]\n}\n";
+
+    std::cout << "Wrote load profile (" << records.size() << " stages): " << path << std::endl;
+    return static_cast<bool>(file);
+}
+
+bool LoadProfiler::WriteChromeTrace(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Failed to write load trace: " << path << std::endl;
+        return false;
+    }
+
+    // Timestamps are in microseconds
+    const std::vector<LoadStageRecord> records = GetRecords();
+    file << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const LoadStageRecord& record = records[i];
+        file << (i ? ",\n" : "\n") << "    { \"name\": \"" << EscapeJson(record.name) << "\", \"cat\": \"load\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+            << record.thread << ", \"ts\": " << record.startMs * 1000.0 << ", \"dur\": " << record.durationMs * 1000.0
+            << ", \"args\": { \"label\": \"" << EscapeJson(record.label) << "\", \"bytes\": " << record.bytes << " } }";
+    }
+    file << "\n  ]\n}\n";
+
+    std::cout << "Wrote load trace: " << path << std::endl;
+    return static_cast<bool>(file);
+}
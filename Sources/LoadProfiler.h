@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One timed load stage
+struct LoadStageRecord
+{
+    std::string name;
+    std::string label;       // What the stage worked on (model path, ...), may be empty
+    uint32_t thread = 0;     // Small per-thread index, 0 = first thread that recorded
+    uint32_t depth = 0;      // Scope nesting on that thread
+    double startMs = 0.0;    // Since the profiler was created
+    double durationMs = 0.0;
+    uint64_t bytes = 0;      // Bytes the stage read, decoded or uploaded (0 = not counted)
+};
+
+// Totals of every record with the same name
+struct LoadStageTotal
+{
+    std::string name;
+    uint32_t count = 0;
+    double durationMs = 0.0;
+    uint64_t bytes = 0;
+};
+
+// Collects load-stage timings from any thread and writes them as a JSON report or a Chrome
+// trace (chrome://tracing, Perfetto). Recording takes a lock, so it is meant for coarse stages.
+class LoadProfiler
+{
+public:
+    using Clock = std::chrono::high_resolution_clock;
+
+    static LoadProfiler& Get();
+
+    // Times its own lifetime as one stage
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name, std::string label = std::string());
+        ~Scope();
+
+        void AddBytes(uint64_t bytes) { m_Bytes += bytes; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_Name;
+        std::string m_Label;
+        Clock::time_point m_Start;
+        uint64_t m_Bytes = 0;
+        uint32_t m_Depth;
+    };
+
+    // Record a stage that did not fit a scope, e.g. one spanning several frames
+    void Record(const char* name, const std::string& label, Clock::time_point start, Clock::time_point end, uint64_t bytes = 0);
+
+    std::vector<LoadStageRecord> GetRecords() const;
+    std::vector<LoadStageTotal> GetTotals() const; // In order of first appearance
+
+    // {"version", "records": [...], "totals": [...]}; false when the file cannot be written
+    bool WriteReport(const std::string& path) const;
+    // Chrome trace event format, one complete ("X") event per record
+    bool WriteChromeTrace(const std::string& path) const;
+
+    LoadProfiler(const LoadProfiler&) = delete;
+    LoadProfiler& operator=(const LoadProfiler&) = delete;
+
+private:
+    LoadProfiler();
+
+    void Add(const char* name, const std::string& label, Clock::time_point start, Clock::time_point end, uint64_t bytes, uint32_t depth);
+
+    Clock::time_point m_Epoch;
+    mutable std::mutex m_Mutex;
+    std::vector<LoadStageRecord> m_Records;
+};
@@ -0,0 +1,378 @@
+#include "MeshProcessing.h"
+#include "SceneTypes.h"
+#include <meshoptimizer.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    // Favors meshlets with tight normal cones, so more of them can be rejected as back-facing
+    const float MeshletConeWeight = 0.25f;
+
+    // Simplification error budget per LOD level, relative to the primitive's extent
+    const float LodTargetErrors[MaxLodCount] = { 0.0f, 0.005f, 0.02f, 0.05f };
+    const size_t MinLodTriangles = 32;
+
+    // Above 1.0 lets the overdraw pass trade a little vertex cache efficiency for less overdraw
+    const float OverdrawThreshold = 1.05f;
+
+    // Quantized attributes of one vertex; vertices with equal keys weld
+    struct WeldKey
+    {
+        int32_t values[8];
+
+        bool operator==(const WeldKey& other) const { return memcmp(values, other.values, sizeof(values)) == 0; }
+    };
+
+    // Open-addressing slot: the hash is kept inline so most probes never touch the key array
+    struct WeldSlot
+    {
+        uint32_t hash;
+        uint32_t vertex; // Welded (new) index, or EmptySlot
+    };
+
+    const uint32_t EmptySlot = UINT32_MAX;
+
+    int32_t QuantizeAttribute(float value, float epsilon)
+    {
+        if (epsilon <= 0.0f)
+        {
+            if (value == 0.0f)
+                value = 0.0f; // -0 welds with +0
+            int32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        const double cell = std::floor(double(value) / epsilon + 0.5);
+        if (cell != cell)
+            return 0; // NaN
+        return static_cast<int32_t>(std::clamp(cell, double(INT32_MIN), double(INT32_MAX)));
+    }
+
+    WeldKey MakeWeldKey(const GLTFVertex& vertex, const WeldSettings& settings)
+    {
+        WeldKey key;
+        for (int i = 0; i < 3; ++i)
+        {
+            key.values[i] = QuantizeAttribute(vertex.position[i], settings.positionEpsilon);
+            key.values[3 + i] = QuantizeAttribute(vertex.normal[i], settings.normalEpsilon);
+        }
+        key.values[6] = QuantizeAttribute(vertex.texCoord[0], settings.texCoordEpsilon);
+        key.values[7] = QuantizeAttribute(vertex.texCoord[1], settings.texCoordEpsilon);
+        return key;
+    }
+
+    // murmur3's 64-bit finalizer: every input bit reaches every output bit
+    uint64_t MixBits(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    // Folds the components in pairs and finalizes each step, so all eight reach the result; a
+    // plain word-wise FNV would leave every second component out of the low 32 bits. The table
+    // slot comes from the high half.
+    uint32_t HashWeldKey(const WeldKey& key)
+    {
+        uint64_t hash = 0;
+        for (int i = 0; i < 8; i += 2)
+        {
+            const uint64_t pair = uint64_t(uint32_t(key.values[i])) | (uint64_t(uint32_t(key.values[i + 1])) << 32);
+            hash = MixBits(hash ^ pair);
+        }
+        return static_cast<uint32_t>(hash >> 32);
+    }
+
+    template <typename IndexType>
+    void WeldIndexed(GLTFVertex* vertices, uint32_t& vertexCount, IndexType* indices, size_t indexCount, const WeldSettings& settings, WeldStats& stats)
+    {
+        stats.verticesBefore += vertexCount;
+
+        // Non-indexed primitives and out-of-range indices are left as they are
+        bool weldable = indexCount > 0;
+        for (size_t i = 0; i < indexCount && weldable; ++i)
+            weldable = indices[i] < vertexCount;
+        if (!weldable)
+        {
+            stats.verticesAfter += vertexCount;
+            return;
+        }
+
+        // Power-of-two table at most half full keeps probe sequences short
+        size_t capacity = 1;
+        while (capacity < size_t(vertexCount) * 2)
+            capacity <<= 1;
+        const size_t mask = capacity - 1;
+        std::vector<WeldSlot> table(capacity, WeldSlot{ 0, EmptySlot });
+        std::vector<WeldKey> keys(vertexCount); // By welded index
+        std::vector<uint32_t> remap(vertexCount);
+
+        uint32_t uniqueCount = 0;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            const WeldKey key = MakeWeldKey(vertices[v], settings);
+            const uint32_t hash = HashWeldKey(key);
+            for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+            {
+                WeldSlot& entry = table[slot];
+                if (entry.vertex == EmptySlot)
+                {
+                    // First occurrence: compact it to the front (uniqueCount <= v, so this never overwrites unread data)
+                    entry = { hash, uniqueCount };
+                    keys[uniqueCount] = key;
+                    vertices[uniqueCount] = vertices[v];
+                    remap[v] = uniqueCount++;
+                    break;
+                }
+                if (entry.hash == hash && keys[entry.vertex] == key)
+                {
+                    remap[v] = entry.vertex;
+                    break;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < indexCount; ++i)
+            indices[i] = static_cast<IndexType>(remap[indices[i]]);
+
+        vertexCount = uniqueCount;
+        stats.verticesAfter += uniqueCount;
+    }
+
+    template <typename IndexType>
+    bool IsTriangleList(const IndexType* indices, size_t indexCount, uint32_t vertexCount)
+    {
+        if (indexCount < 3 || indexCount % 3 != 0 || vertexCount == 0)
+            return false;
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            if (indices[i] >= vertexCount)
+                return false;
+        }
+        return true;
+    }
+
+    template <typename IndexType>
+    void BuildMeshletsIndexed(const GLTFVertex* vertices, uint32_t vertexCount, IndexType* indices, size_t indexCount, std::vector<Meshlet>& meshlets)
+    {
+        if (!IsTriangleList(indices, indexCount, vertexCount))
+            return;
+
+        const std::vector<uint32_t> sourceIndices(indices, indices + indexCount);
+        const size_t maxMeshlets = meshopt_buildMeshletsBound(indexCount, MaxMeshletVertices, MaxMeshletTriangles);
+        std::vector<meshopt_Meshlet> built(maxMeshlets);
+        std::vector<unsigned int> meshletVertices(maxMeshlets * MaxMeshletVertices);
+        std::vector<unsigned char> meshletTriangles(maxMeshlets * MaxMeshletTriangles * 3);
+        const size_t meshletCount = meshopt_buildMeshlets(built.data(), meshletVertices.data(), meshletTriangles.data(), sourceIndices.data(), indexCount,
+            vertices[0].position, vertexCount, sizeof(GLTFVertex), MaxMeshletVertices, MaxMeshletTriangles, MeshletConeWeight);
+
+        size_t written = 0;
+        for (size_t m = 0; m < meshletCount; ++m)
+        {
+            const meshopt_Meshlet& source = built[m];
+            const unsigned int* localVertices = &meshletVertices[source.vertex_offset];
+            const unsigned char* localTriangles = &meshletTriangles[source.triangle_offset];
+            const meshopt_Bounds bounds = meshopt_computeMeshletBounds(localVertices, localTriangles, source.triangle_count,
+                vertices[0].position, vertexCount, sizeof(GLTFVertex));
+
+            Meshlet meshlet;
+            meshlet.center = { bounds.center[0], bounds.center[1], bounds.center[2] };
+            meshlet.radius = bounds.radius;
+            meshlet.coneApex = { bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2] };
+            meshlet.coneAxis = { bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2] };
+            meshlet.coneCutoff = bounds.cone_cutoff;
+            meshlet.firstIndex = static_cast<uint32_t>(written);
+            meshlet.indexCount = source.triangle_count * 3;
+            meshlet.vertexCount = source.vertex_count;
+
+            DirectX::XMVECTOR aabbMin = DirectX::XMVectorReplicate(FLT_MAX);
+            DirectX::XMVECTOR aabbMax = DirectX::XMVectorReplicate(-FLT_MAX);
+            for (unsigned int v = 0; v < source.vertex_count; ++v)
+            {
+                const DirectX::XMVECTOR position = DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(vertices[localVertices[v]].position));
+                aabbMin = DirectX::XMVectorMin(aabbMin, position);
+                aabbMax = DirectX::XMVectorMax(aabbMax, position);
+            }
+            DirectX::XMStoreFloat3(&meshlet.aabbMin, aabbMin);
+            DirectX::XMStoreFloat3(&meshlet.aabbMax, aabbMax);
+
+            // Meshlets cover every triangle exactly once, so the primitive's range is rewritten in full
+            for (size_t i = 0; i < meshlet.indexCount; ++i)
+                indices[written++] = static_cast<IndexType>(localVertices[localTriangles[i]]);
+
+            meshlets.push_back(meshlet);
+        }
+    }
+
+    template <typename IndexType>
+    void BuildLodsIndexed(const GLTFVertex* vertices, uint32_t vertexCount, const IndexType* indices, size_t indexCount, std::vector<SimplifiedLod>& lods, LodStats& stats)
+    {
+        if (!IsTriangleList(indices, indexCount, vertexCount))
+            return;
+
+        stats.primitives[0] += 1;
+        stats.triangles[0] += indexCount / 3;
+
+        const std::vector<uint32_t> sourceIndices(indices, indices + indexCount);
+        const float errorScale = meshopt_simplifyScale(vertices[0].position, vertexCount, sizeof(GLTFVertex));
+        size_t previousCount = indexCount;
+        float previousError = 0.0f;
+
+        // Every level simplifies LOD0 directly, so its error is measured against the full mesh
+        for (uint32_t level = 1; level < MaxLodCount; ++level)
+        {
+            const size_t targetCount = previousCount / 6 * 3;
+            if (targetCount < MinLodTriangles * 3)
+                break;
+
+            SimplifiedLod lod;
+            lod.indices.resize(indexCount);
+            float relativeError = 0.0f;
+            const size_t count = meshopt_simplify(lod.indices.data(), sourceIndices.data(), indexCount, vertices[0].position, vertexCount,
+                sizeof(GLTFVertex), targetCount, LodTargetErrors[level], meshopt_SimplifyLockBorder, &relativeError);
+            if (count == 0 || count > previousCount / 4 * 3)
+                break;
+
+            lod.indices.resize(count);
+            meshopt_optimizeVertexCache(lod.indices.data(), lod.indices.data(), count, vertexCount);
+            lod.error = std::max(relativeError * errorScale, previousError);
+
+            // Import-time checks: fewer whole triangles, indices in range. The error is meshopt's own
+            // estimate and already capped at the target, so it is not checked here (Tests/LodTests
+            // measures the deviation independently)
+            bool valid = count % 3 == 0 && count < previousCount;
+            for (size_t i = 0; i < count && valid; ++i)
+                valid = lod.indices[i] < vertexCount;
+            if (!valid)
+            {
+                ++stats.violations;
+                break;
+            }
+
+            stats.primitives[level] += 1;
+            stats.triangles[level] += count / 3;
+            previousCount = count;
+            previousError = lod.error;
+            lods.push_back(std::move(lod));
+        }
+    }
+
+    template <typename IndexType>
+    VertexCacheStats AnalyzeVertexCache(const IndexType* indices, size_t indexCount, size_t vertexCount)
+    {
+        const meshopt_VertexCacheStatistics result = meshopt_analyzeVertexCache(indices, indexCount, vertexCount, VertexCacheSize, 0, 0);
+
+        // meshopt's ATVR divides by the whole vertex count; ours counts only the vertices the
+        // indices reach, so unreferenced ones don't flatter the ratio
+        std::vector<bool> referenced(vertexCount, false);
+        VertexCacheStats stats;
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            if (!referenced[indices[i]])
+            {
+                referenced[indices[i]] = true;
+                ++stats.vertices;
+            }
+        }
+        stats.triangles = indexCount / 3;
+        stats.transformed = result.vertices_transformed;
+        return stats;
+    }
+
+    template <typename IndexType>
+    void OptimizeIndexed(GLTFVertex* vertices, uint32_t& vertexCount, IndexType* indices, size_t indexCount, MeshOptimizationStats& stats)
+    {
+        // Non-triangle lists and out-of-range indices are left exactly as the exporter wrote them
+        if (!IsTriangleList(indices, indexCount, vertexCount))
+            return;
+
+        stats.before.Merge(AnalyzeVertexCache(indices, indexCount, vertexCount));
+
+        meshopt_optimizeVertexCache(indices, indices, indexCount, vertexCount);
+        meshopt_optimizeOverdraw(indices, indices, indexCount, vertices[0].position, vertexCount, sizeof(GLTFVertex), OverdrawThreshold);
+
+        std::vector<GLTFVertex> reordered(vertexCount);
+        const size_t uniqueVertices = meshopt_optimizeVertexFetch(reordered.data(), indices, indexCount, vertices, vertexCount, sizeof(GLTFVertex));
+        std::copy(reordered.begin(), reordered.begin() + uniqueVertices, vertices);
+        vertexCount = static_cast<uint32_t>(uniqueVertices);
+
+        stats.after.Merge(AnalyzeVertexCache(indices, indexCount, vertexCount));
+    }
+}
+
+void VertexCacheStats::Merge(const VertexCacheStats& other)
+{
+    triangles += other.triangles;
+    vertices += other.vertices;
+    transformed += other.transformed;
+}
+
+void WeldStats::Merge(const WeldStats& other)
+{
+    verticesBefore += other.verticesBefore;
+    verticesAfter += other.verticesAfter;
+}
+
+void LodStats::Merge(const LodStats& other)
+{
+    for (uint32_t level = 0; level < MaxLodCount; ++level)
+    {
+        primitives[level] += other.primitives[level];
+        triangles[level] += other.triangles[level];
+    }
+    violations += other.violations;
+}
+
+void MeshOptimizationStats::Merge(const MeshOptimizationStats& other)
+{
+    before.Merge(other.before);
+    after.Merge(other.after);
+}
+
+void WeldPrimitive(GLTFVertex* vertices, uint32_t& vertexCount, uint32_t* indices, size_t indexCount, const WeldSettings& settings, WeldStats& stats)
+{
+    WeldIndexed(vertices, vertexCount, indices, indexCount, settings, stats);
+}
+
+void WeldPrimitive(GLTFVertex* vertices, uint32_t& vertexCount, uint16_t* indices, size_t indexCount, const WeldSettings& settings, WeldStats& stats)
+{
+    WeldIndexed(vertices, vertexCount, indices, indexCount, settings, stats);
+}
+
+void BuildMeshlets(const GLTFVertex* vertices, uint32_t vertexCount, uint32_t* indices, size_t indexCount, std::vector<Meshlet>& meshlets)
+{
+    BuildMeshletsIndexed(vertices, vertexCount, indices, indexCount, meshlets);
+}
+
+void BuildMeshlets(const GLTFVertex* vertices, uint32_t vertexCount, uint16_t* indices, size_t indexCount, std::vector<Meshlet>& meshlets)
+{
+    BuildMeshletsIndexed(vertices, vertexCount, indices, indexCount, meshlets);
+}
+
+void BuildLods(const GLTFVertex* vertices, uint32_t vertexCount, const uint32_t* indices, size_t indexCount, std::vector<SimplifiedLod>& lods, LodStats& stats)
+{
+    BuildLodsIndexed(vertices, vertexCount, indices, indexCount, lods, stats);
+}
+
+void BuildLods(const GLTFVertex* vertices, uint32_t vertexCount, const uint16_t* indices, size_t indexCount, std::vector<SimplifiedLod>& lods, LodStats& stats)
+{
+    BuildLodsIndexed(vertices, vertexCount, indices, indexCount, lods, stats);
+}
+
+void OptimizePrimitive(GLTFVertex* vertices, uint32_t& vertexCount, uint32_t* indices, size_t indexCount, MeshOptimizationStats& stats)
+{
+    OptimizeIndexed(vertices, vertexCount, indices, indexCount, stats);
+}
+
+void OptimizePrimitive(GLTFVertex* vertices, uint32_t& vertexCount, uint16_t* indices, size_t indexCount, MeshOptimizationStats& stats)
+{
+    OptimizeIndexed(vertices, vertexCount, indices, indexCount, stats);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+struct GLTFVertex;
+
+// Post-transform vertex cache totals over a set of primitives (simulated FIFO of VertexCacheSize entries)
+struct VertexCacheStats
+{
+    uint64_t triangles = 0;
+    uint64_t vertices = 0;    // Referenced vertices
+    uint64_t transformed = 0; // Vertex shader invocations
+
+    float GetACMR() const { return triangles ? float(transformed) / float(triangles) : 0.0f; } // Transformed vertices per triangle
+    float GetATVR() const { return vertices ? float(transformed) / float(vertices) : 0.0f; }   // Transformed per referenced vertex (1 = ideal)
+    void Merge(const VertexCacheStats& other);
+};
+
+struct MeshOptimizationStats
+{
+    VertexCacheStats before;
+    VertexCacheStats after;
+
+    void Merge(const MeshOptimizationStats& other);
+};
+
+static const unsigned int VertexCacheSize = 16;
+
+// Vertices weld when every attribute lands in the same epsilon-sized grid cell (0 = bit-exact match)
+struct WeldSettings
+{
+    float positionEpsilon = 0.0f;
+    float normalEpsilon = 0.0f;
+    float texCoordEpsilon = 0.0f;
+};
+
+struct WeldStats
+{
+    uint64_t verticesBefore = 0;
+    uint64_t verticesAfter = 0;
+
+    void Merge(const WeldStats& other);
+};
+
+// Merge duplicate vertices of one primitive and remap its primitive-local indices. The first
+// occurrence of each vertex is kept and survivors are compacted to the front of the slice, so
+// `vertexCount` shrinks. Thread-safe for distinct primitives.
+void WeldPrimitive(GLTFVertex* vertices, uint32_t& vertexCount, uint32_t* indices, size_t indexCount, const WeldSettings& settings, WeldStats& stats);
+void WeldPrimitive(GLTFVertex* vertices, uint32_t& vertexCount, uint16_t* indices, size_t indexCount, const WeldSettings& settings, WeldStats& stats);
+
+static const uint32_t MaxMeshletVertices = 64;
+static const uint32_t MaxMeshletTriangles = 124;
+
+// Cluster of at most MaxMeshletVertices vertices and MaxMeshletTriangles triangles. A meshlet's
+// triangles are contiguous in its primitive's index range, so a surviving meshlet draws as a
+// sub-range of the primitive. Bounds are in primitive-local space.
+struct Meshlet
+{
+    DirectX::XMFLOAT3 center;   // Bounding sphere
+    float radius;
+    DirectX::XMFLOAT3 aabbMin;
+    uint32_t firstIndex;        // Relative to the primitive's globalIndexOffset
+    DirectX::XMFLOAT3 aabbMax;
+    uint32_t indexCount;
+    DirectX::XMFLOAT3 coneApex; // Normal cone: back-facing when dot(normalize(coneApex - eye), coneAxis) >= coneCutoff
+    float coneCutoff;           // 1 when the triangles face too many ways to ever be rejected
+    DirectX::XMFLOAT3 coneAxis;
+    uint32_t vertexCount;
+};
+
+// Split one primitive into meshlets and rewrite its indices in meshlet order. Appends to
+// `meshlets`; primitives that are not indexed triangle lists get none. Thread-safe for
+// distinct primitives.
+void BuildMeshlets(const GLTFVertex* vertices, uint32_t vertexCount, uint32_t* indices, size_t indexCount, std::vector<Meshlet>& meshlets);
+void BuildMeshlets(const GLTFVertex* vertices, uint32_t vertexCount, uint16_t* indices, size_t indexCount, std::vector<Meshlet>& meshlets);
+
+static const uint32_t MaxLodCount = 4; // Including the full-resolution LOD0
+
+// One simplified level of a primitive, indexing the primitive's (unchanged) vertices
+struct SimplifiedLod
+{
+    std::vector<uint32_t> indices;
+    float error = 0.0f; // Geometric deviation from LOD0 in primitive-local units; never below the previous level's
+};
+
+struct LodStats
+{
+    uint64_t primitives[MaxLodCount] = {}; // Primitives that reached each level
+    uint64_t triangles[MaxLodCount] = {};  // Triangles summed per level
+    uint32_t violations = 0;               // Levels failing the reduction or index range checks
+
+    void Merge(const LodStats& other);
+};
+
+// Simplify one primitive (quadric error, borders locked so neighbouring primitives do not crack)
+// into up to MaxLodCount - 1 coarser levels, each aiming for half the triangles of the one before
+// within a growing error budget. The chain ends at the first level that fails to drop a quarter of
+// the triangles. Every level is checked for triangle reduction and index range.
+void BuildLods(const GLTFVertex* vertices, uint32_t vertexCount, const uint32_t* indices, size_t indexCount, std::vector<SimplifiedLod>& lods, LodStats& stats);
+void BuildLods(const GLTFVertex* vertices, uint32_t vertexCount, const uint16_t* indices, size_t indexCount, std::vector<SimplifiedLod>& lods, LodStats& stats);
+
+// Reorder one primitive's triangles for the post-transform vertex cache and then for overdraw,
+// and reorder its vertices into first-use order for fetch locality. Indices are primitive-local
+// and rewritten in place. `vertexCount` shrinks if the primitive had unreferenced vertices (they
+// are dropped from the end of its slice). Thread-safe for distinct primitives.
+void OptimizePrimitive(GLTFVertex* vertices, uint32_t& vertexCount, uint32_t* indices, size_t indexCount, MeshOptimizationStats& stats);
+void OptimizePrimitive(GLTFVertex* vertices, uint32_t& vertexCount, uint16_t* indices, size_t indexCount, MeshOptimizationStats& stats);
@@ -1,8 +1,11 @@
 #define NOMINMAX
 #include "Model.h"
+#include "AnimationSampling.h"
+#include "Skinning.h"
 #include "Renderer.h"
 #include "Utility.h"
 #include "ResourceUploadBatch.h"
+#include "GLTFDecoding.h"
 #include <iostream>
 #include <cgltf.h>
 #define CGLTF_IMPLEMENTATION
@@ -10,6 +13,246 @@
 #include <DirectXTex.h>
 #include <cstdint>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <meshoptimizer.h>
+#include "JobSystem.h"
+#include "LoadProfiler.h"
+
+namespace
+{
+    // Fixed-size records stored in the scene cache meta section
+    struct CachedImage
+    {
+        uint32_t kind; // 0 = none, 1 = external file, 2 = embedded bytes in Section_ImageData
+        uint32_t padding;
+        uint64_t dataOffset;
+        uint64_t dataSize;
+    };
+
+    struct CachedPrimitive
+    {
+        uint32_t materialIndex;
+        uint32_t alphaMode;
+        uint32_t globalVertexOffset;
+        uint32_t globalIndexOffset;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t indexPool;
+        uint32_t firstMeshlet;
+        uint32_t meshletCount;
+        uint32_t lodCount;
+        PrimitiveLod lods[MaxLodCount];
+        uint32_t firstDrawNode;
+        uint32_t skinned;
+        uint32_t firstSkinVertex;
+        DirectX::XMFLOAT3 aabbCenter;
+        DirectX::XMFLOAT3 aabbExtents;
+    };
+
+    struct CachedNode
+    {
+        int32_t meshIndex;
+        int32_t skinIndex;
+        int32_t parentIndex;
+        uint32_t firstChild;
+        uint32_t childCount;
+        uint32_t meshInstance;
+        DirectX::XMFLOAT4X4 transform;
+        DirectX::XMFLOAT3 translation;
+        DirectX::XMFLOAT4 rotation;
+        DirectX::XMFLOAT3 scale;
+    };
+
+    struct CachedChannel
+    {
+        uint32_t type;
+        uint32_t targetNode;
+        float quantizationOffset[3]; // Compressed channels only
+        float quantizationScale[3];
+    };
+
+    std::wstring GetImagePath(const GLTFImage& image, const std::string& directory)
+    {
+        std::string fullPath = directory + image.uri;
+        return std::wstring(fullPath.begin(), fullPath.end());
+    }
+
+    // Encoded bytes of an image: mapped from its file, or the embedded buffer range
+    bool GetImageSource(const GLTFImage& image, const std::string& directory, MappedFile& file, const uint8_t*& sourceData, size_t& sourceSize)
+    {
+        sourceData = image.embeddedData;
+        sourceSize = image.embeddedSize;
+        if (!image.uri.empty())
+        {
+            if (!file.Open(directory + image.uri))
+            {
+                std::cerr << "Failed to open image: " << image.uri << std::endl;
+                return false;
+            }
+            sourceData = file.GetData();
+            sourceSize = static_cast<size_t>(file.GetSize());
+        }
+        return sourceData != nullptr;
+    }
+
+    // Decode an image, through the texture cooker when one is given. Thread-safe: reads only the image source.
+    bool DecodeImage(const GLTFImage& image, const std::string& directory, const TextureCooker* cooker, DirectX::ScratchImage& result)
+    {
+        MappedFile file;
+        const uint8_t* sourceData = nullptr;
+        size_t sourceSize = 0;
+        if (!GetImageSource(image, directory, file, sourceData, sourceSize))
+            return false;
+
+        if (cooker)
+            return cooker->Load(sourceData, sourceSize, image.usage, result);
+
+        HRESULT hr = DirectX::LoadFromWICMemory(sourceData, sourceSize, DirectX::WIC_FLAGS_NONE, nullptr, result);
+        if (FAILED(hr))
+        {
+            std::cerr << "Load image failed: " << (image.uri.empty() ? std::string("<embedded>") : image.uri) << " (HRESULT: 0x" << std::hex << hr << std::dec << ")" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Cook an image if needed and read only its mip tail, for textures that stream the rest. Thread-safe.
+    bool DecodeImageTail(const GLTFImage& image, const std::string& directory, const TextureCooker& cooker, std::string& cookedPath,
+        DirectX::TexMetadata& fullMetadata, DirectX::ScratchImage& tail, uint32_t& tailMip)
+    {
+        MappedFile file;
+        const uint8_t* sourceData = nullptr;
+        size_t sourceSize = 0;
+        if (!GetImageSource(image, directory, file, sourceData, sourceSize))
+            return false;
+
+        return cooker.Prepare(sourceData, sourceSize, image.usage, cookedPath) &&
+            TextureStreamer::LoadTail(cookedPath, fullMetadata, tail, tailMip);
+    }
+
+    // Decoded size from the image header only, used to budget decodes before they run
+    size_t EstimateDecodedSize(const GLTFImage& image, const std::string& directory)
+    {
+        DirectX::TexMetadata metaData = {};
+        HRESULT hr = E_FAIL;
+        if (!image.uri.empty())
+            hr = DirectX::GetMetadataFromWICFile(GetImagePath(image, directory).c_str(), DirectX::WIC_FLAGS_NONE, metaData);
+        else if (image.embeddedData)
+            hr = DirectX::GetMetadataFromWICMemory(image.embeddedData, image.embeddedSize, DirectX::WIC_FLAGS_NONE, metaData);
+
+        if (FAILED(hr))
+            return 0;
+        return metaData.width * metaData.height * DirectX::BitsPerPixel(metaData.format) / 8;
+    }
+
+    // Record the copy of every subresource of `image` into `texture` (COMMON -> PIXEL_SHADER_RESOURCE).
+    // Returns the staging size; the upload buffer must stay alive until the copy has executed.
+    UINT64 StageTexture(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, ID3D12Resource* texture, const DirectX::ScratchImage& image, Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer)
+    {
+        const DirectX::TexMetadata& metaData = image.GetMetadata();
+
+        // Transition texture to COPY_DEST
+        D3D12_RESOURCE_BARRIER barrier = {};
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Transition.pResource = texture;
+        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+        cmdList->ResourceBarrier(1, &barrier);
+
+        const UINT numSubResources = UINT(metaData.mipLevels * metaData.arraySize);
+        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubResources);
+        std::vector<UINT> numRows(numSubResources);
+        std::vector<UINT64> rowSizes(numSubResources);
+
+        UINT64 textureMemSize = 0;
+        D3D12_RESOURCE_DESC textureDesc = texture->GetDesc();
+        device->GetCopyableFootprints(&textureDesc, 0, numSubResources, 0, layouts.data(), numRows.data(), rowSizes.data(), &textureMemSize);
+
+        // Create upload buffer
+        D3D12_HEAP_PROPERTIES uploadHeapProps = {};
+        uploadHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+        D3D12_RESOURCE_DESC uploadDesc = {};
+        uploadDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        uploadDesc.Width = textureMemSize;
+        uploadDesc.Height = 1;
+        uploadDesc.DepthOrArraySize = 1;
+        uploadDesc.MipLevels = 1;
+        uploadDesc.Format = DXGI_FORMAT_UNKNOWN;
+        uploadDesc.SampleDesc.Count = 1;
+        uploadDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+        CHECK_HR(device->CreateCommittedResource(&uploadHeapProps, D3D12_HEAP_FLAG_NONE, &uploadDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&uploadBuffer)), "Create upload buffer failed");
+
+        // Copy data to upload buffer
+        uint8_t* uploadMem;
+        uploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&uploadMem));
+
+        for (UINT arrayIdx = 0; arrayIdx < UINT(metaData.arraySize); ++arrayIdx)
+        {
+            for (UINT mipIdx = 0; mipIdx < UINT(metaData.mipLevels); ++mipIdx)
+            {
+                const UINT subResourceIdx = mipIdx + (arrayIdx * UINT(metaData.mipLevels));
+                const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& subResourceLayout = layouts[subResourceIdx];
+                uint8_t* dstSubResourceMem = uploadMem + subResourceLayout.Offset;
+                const DirectX::Image* subImage = image.GetImage(mipIdx, arrayIdx, 0);
+                for (UINT z = 0; z < subResourceLayout.Footprint.Depth; ++z)
+                {
+                    uint8_t* dst = dstSubResourceMem;
+                    const uint8_t* src = subImage->pixels;
+                    for (UINT y = 0; y < numRows[subResourceIdx]; ++y)
+                    {
+                        memcpy(dst, src, rowSizes[subResourceIdx]);
+                        dst += subResourceLayout.Footprint.RowPitch;
+                        src += subImage->rowPitch;
+                    }
+                }
+            }
+        }
+        uploadBuffer->Unmap(0, nullptr);
+
+        // Copy to texture
+        for (UINT subResourceIdx = 0; subResourceIdx < numSubResources; ++subResourceIdx)
+        {
+            D3D12_TEXTURE_COPY_LOCATION dst = {};
+            dst.pResource = texture;
+            dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            dst.SubresourceIndex = subResourceIdx;
+            D3D12_TEXTURE_COPY_LOCATION src = {};
+            src.pResource = uploadBuffer.Get();
+            src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+            src.PlacedFootprint = layouts[subResourceIdx];
+            cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+        }
+
+        // Transition to PIXEL_SHADER_RESOURCE
+        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+        cmdList->ResourceBarrier(1, &barrier);
+
+        return textureMemSize;
+    }
+
+    // Quantization range of compact positions: the primitive AABB. Flat axes keep a small nonzero
+    // size so the dequantizing BLAS instance transform stays invertible.
+    PositionQuantization GetPositionQuantization(const DirectX::BoundingBox& aabb)
+    {
+        const float largest = 2.0f * std::max({ aabb.Extents.x, aabb.Extents.y, aabb.Extents.z });
+        const float minimumSize = std::max(largest * 1e-3f, 1e-6f);
+        return {
+            { aabb.Center.x - aabb.Extents.x, aabb.Center.y - aabb.Extents.y, aabb.Center.z - aabb.Extents.z },
+            { std::max(aabb.Extents.x * 2.0f, minimumSize), std::max(aabb.Extents.y * 2.0f, minimumSize), std::max(aabb.Extents.z * 2.0f, minimumSize) }
+        };
+    }
+
+    // Vertices per skinning job, so one large mesh still spreads across the workers
+    const uint32_t SkinningBatchSize = 4096;
+}
 
 Model::Model()
 {
@@ -27,8 +270,28 @@ Model::~Model()
 
 bool Model::LoadGLTFModel(Renderer* renderer, const std::string& filepath)
 {
+    // Set file directory
+    size_t lastSlash = filepath.find_last_of("/\\");
+    std::string dir = (lastSlash != std::string::npos) ? filepath.substr(0, lastSlash + 1) : std::string();
+    std::string fileName = (lastSlash != std::string::npos) ? filepath.substr(lastSlash + 1) : filepath;
+    fileDirectory = std::wstring(dir.begin(), dir.end());
+    LoadProfiler::Scope loadScope("LoadGLTFModel", fileName);
+
+    // Warm start from the cooked scene cache if it is present and up to date
+    const std::string cachePath = filepath + ".trscene";
+    if (m_UseSceneCache && LoadFromSceneCache(renderer, dir, cachePath))
+    {
+        std::cout << "Loaded GLTF model from scene cache: " << cachePath << " (" << m_GltfModel.meshes.size() << " meshes)" << std::endl;
+        return true;
+    }
+
+    auto parseStart = std::chrono::high_resolution_clock::now();
     cgltf_options options = {};
-    cgltf_result result = cgltf_parse_file(&options, filepath.c_str(), &m_GltfModel.data);
+    cgltf_result result;
+    {
+        LoadProfiler::Scope scope("cgltf_parse_file");
+        result = cgltf_parse_file(&options, filepath.c_str(), &m_GltfModel.data);
+    }
 
     if (result != cgltf_result_success)
     {
@@ -36,20 +299,13 @@ bool Model::LoadGLTFModel(Renderer* renderer, const std::string& filepath)
         return false;
     }
 
-    // Set file directory
-    size_t lastSlash = filepath.find_last_of("/\\");
-    if (lastSlash != std::string::npos)
-    {
-        std::string dir = filepath.substr(0, lastSlash + 1);
-        fileDirectory = std::wstring(dir.begin(), dir.end());
-    }
-    else
+    // Load buffer data - required for cgltf_accessor_read functions to work
     {
-        fileDirectory = L"";
+        LoadProfiler::Scope scope("cgltf_load_buffers");
+        result = cgltf_load_buffers(&options, m_GltfModel.data, filepath.c_str());
+        for (size_t i = 0; result == cgltf_result_success && i < m_GltfModel.data->buffers_count; ++i)
+            scope.AddBytes(m_GltfModel.data->buffers[i].data ? m_GltfModel.data->buffers[i].size : 0);
     }
-
-    // Load buffer data - required for cgltf_accessor_read functions to work
-    result = cgltf_load_buffers(&options, m_GltfModel.data, filepath.c_str());
     if (result != cgltf_result_success)
     {
         std::cerr << "Failed to load GLTF buffers: " << filepath << std::endl;
@@ -58,7 +314,10 @@ bool Model::LoadGLTFModel(Renderer* renderer, const std::string& filepath)
         return false;
     }
 
-    result = cgltf_validate(m_GltfModel.data);
+    {
+        LoadProfiler::Scope scope("cgltf_validate");
+        result = cgltf_validate(m_GltfModel.data);
+    }
     if (result != cgltf_result_success)
     {
         std::cerr << "GLTF validation failed: " << filepath << std::endl;
@@ -67,260 +326,945 @@ bool Model::LoadGLTFModel(Renderer* renderer, const std::string& filepath)
         return false;
     }
 
-    LoadTextures(renderer);
+    size_t bufferBytes = 0;
+    for (size_t i = 0; i < m_GltfModel.data->buffers_count; ++i)
+        bufferBytes += m_GltfModel.data->buffers[i].data ? m_GltfModel.data->buffers[i].size : 0;
+    auto parseEnd = std::chrono::high_resolution_clock::now();
+    std::cout << "Parsed glTF and read " << bufferBytes / 1024 << " KB of buffers in "
+        << std::chrono::duration<double, std::milli>(parseEnd - parseStart).count() << " ms" << std::endl;
+
+    // Compressed buffer views have to be decoded before anything reads their accessors
+    MeshoptDecodeStats meshoptStats;
+    bool meshoptDecoded;
+    {
+        LoadProfiler::Scope scope("MeshoptDecode");
+        meshoptDecoded = DecodeMeshoptBuffers(m_GltfModel.data, m_ParallelDecode, meshoptStats);
+        scope.AddBytes(meshoptStats.decodedBytes);
+    }
+    if (!meshoptDecoded)
+    {
+        std::cerr << "Failed to decode EXT_meshopt_compression buffers: " << filepath << std::endl;
+        cgltf_free(m_GltfModel.data);
+        m_GltfModel.data = nullptr;
+        return false;
+    }
+    if (meshoptStats.views > 0)
+    {
+        auto meshoptEnd = std::chrono::high_resolution_clock::now();
+        std::cout << "Decoded " << meshoptStats.views << " meshopt buffer views (" << meshoptStats.compressedBytes / 1024 << " KB -> "
+            << meshoptStats.decodedBytes / 1024 << " KB) in " << std::chrono::duration<double, std::milli>(meshoptEnd - parseEnd).count() << " ms" << std::endl;
+    }
+
+    {
+        LoadProfiler::Scope scope("LoadTextures");
+        LoadTextures();
+    }
     LoadMaterials();
 
-    m_GltfModel.meshes.reserve(m_GltfModel.data->meshes_count);
+    // Lay out every mesh/primitive slot up front so workers write to fixed locations
+    // and the final order (and therefore the global offsets) matches the glTF order.
+    struct PrimitiveDecodeJob
+    {
+        const cgltf_primitive* source;
+        GLTFPrimitive* target;
+    };
+    std::vector<PrimitiveDecodeJob> decodeJobs;
 
-    // Process meshes
+    m_GltfModel.meshes.resize(m_GltfModel.data->meshes_count);
     for (size_t i = 0; i < m_GltfModel.data->meshes_count; ++i)
     {
         cgltf_mesh* mesh = &m_GltfModel.data->meshes[i];
-        GLTFMesh gltfMesh;
+        GLTFMesh& gltfMesh = m_GltfModel.meshes[i];
         if (mesh->name) gltfMesh.name = mesh->name;
 
+        gltfMesh.primitives.resize(mesh->primitives_count);
         for (size_t j = 0; j < mesh->primitives_count; ++j)
         {
-            cgltf_primitive* primitive = &mesh->primitives[j];
-
-            GLTFPrimitive gltfPrim;
+            decodeJobs.push_back({ &mesh->primitives[j], &gltfMesh.primitives[j] });
+        }
+    }
 
-            // Process material
-            if (primitive->material)
-            {
-                cgltf_material* material = primitive->material;
-                gltfPrim.materialIndex = static_cast<UINT>(material - m_GltfModel.data->materials);
-
-                // Set alpha mode
-                if (material->alpha_mode == cgltf_alpha_mode_opaque)
-                     gltfPrim.alphaMode = AlphaMode::Opaque;
-                else if (material->alpha_mode == cgltf_alpha_mode_mask)
-                    gltfPrim.alphaMode = AlphaMode::Mask;
-                else if (material->alpha_mode == cgltf_alpha_mode_blend)
-                    gltfPrim.alphaMode = AlphaMode::Blend;
-            }
+    // Sizing pass: give every primitive its final slice of the global arrays so the
+    // decode pass writes in place and nothing is copied afterwards
+    auto decodeStart = std::chrono::high_resolution_clock::now();
+    uint64_t totalVertices = 0;
+    uint64_t totalIndices[IndexPool_Count] = {};
+    uint64_t totalSkinVertices = 0;
+    for (auto& job : decodeJobs)
+    {
+        GLTFPrimitive& prim = *job.target;
+        SizePrimitive(job.source, prim);
+        prim.globalVertexOffset = static_cast<uint32_t>(totalVertices);
+        prim.globalIndexOffset = static_cast<uint32_t>(totalIndices[prim.indexPool]);
+        totalVertices += prim.vertexCount;
+        totalIndices[prim.indexPool] += prim.indexCount;
+        prim.firstSkinVertex = static_cast<uint32_t>(totalSkinVertices);
+        if (prim.skinned)
+            totalSkinVertices += prim.vertexCount;
+    }
 
-            // Process attributes
-            cgltf_accessor* positionAccessor = nullptr;
-            cgltf_accessor* normalAccessor = nullptr;
-            cgltf_accessor* texCoordAccessor = nullptr;
+    if (totalVertices > UINT32_MAX || totalIndices[IndexPool_32] > UINT32_MAX || totalIndices[IndexPool_16] > UINT32_MAX)
+    {
+        std::cerr << "GLTF geometry exceeds 32-bit vertex/index range: " << filepath << std::endl;
+        return false;
+    }
 
-            for (size_t k = 0; k < primitive->attributes_count; ++k)
-            {
-                cgltf_attribute* attribute = &primitive->attributes[k];
-                if (attribute->type == cgltf_attribute_type_position)
-                {
-                    positionAccessor = attribute->data;
-                }
-                else if (attribute->type == cgltf_attribute_type_normal)
-                {
-                    normalAccessor = attribute->data;
-                }
-                else if (attribute->type == cgltf_attribute_type_texcoord && attribute->index == 0)
-                {
-                    texCoordAccessor = attribute->data;
-                }
-            }
+    m_GlobalVertices.resize(static_cast<size_t>(totalVertices));
+    m_SkinVertices.resize(static_cast<size_t>(totalSkinVertices));
+    m_GlobalIndices.resize(static_cast<size_t>(totalIndices[IndexPool_32]));
+    // Even length so the path tracer's 4-byte loads never run past the end of the 16-bit pool
+    m_GlobalIndices16.resize(static_cast<size_t>((totalIndices[IndexPool_16] + 1) & ~1ull));
 
-            if (!positionAccessor)
-            {
-                std::cerr << "GLTF mesh missing position data" << std::endl;
-                continue;
-            }
+    // Per-primitive passes run across the worker pool, or serially for load-time comparisons
+    auto forEachPrimitive = [&](const std::function<void(size_t)>& job)
+    {
+        if (m_ParallelDecode)
+        {
+            JobSystem::Get().ParallelFor(decodeJobs.size(), job);
+        }
+        else
+        {
+            for (size_t i = 0; i < decodeJobs.size(); ++i)
+                job(i);
+        }
+    };
 
-            // Read vertices
-            size_t vertexCount = positionAccessor->count;
-            gltfPrim.vertices.resize(vertexCount);
+    // Decode primitives across the worker pool
+    std::atomic<bool> decodeFailed{ false };
+    auto decodeJob = [&](size_t jobIndex)
+    {
+        GLTFPrimitive& prim = *decodeJobs[jobIndex].target;
+        void* indices = prim.indexPool == IndexPool_16
+            ? static_cast<void*>(m_GlobalIndices16.data() + prim.globalIndexOffset)
+            : static_cast<void*>(m_GlobalIndices.data() + prim.globalIndexOffset);
+        if (!DecodePrimitive(m_GltfModel.data, decodeJobs[jobIndex].source, prim,
+            m_GlobalVertices.data() + prim.globalVertexOffset, indices))
+            decodeFailed = true;
+        else if (prim.skinned && !DecodeSkinVertices(decodeJobs[jobIndex].source, m_GlobalVertices.data() + prim.globalVertexOffset,
+            prim.vertexCount, m_SkinVertices.data() + prim.firstSkinVertex))
+            decodeFailed = true;
+    };
+    forEachPrimitive(decodeJob);
+
+    if (decodeFailed)
+    {
+        std::cerr << "Failed to decode GLTF geometry: " << filepath << std::endl;
+        return false;
+    }
 
-            // Read positions
-            for (size_t k = 0; k < vertexCount; ++k)
-            {
-                if (!cgltf_accessor_read_float(positionAccessor, k, gltfPrim.vertices[k].position, 3))
-                {
-                    std::cerr << "Failed to read position data from GLTF buffer" << std::endl;
-                    return false;
-                }
-            }
+    auto decodeEnd = std::chrono::high_resolution_clock::now();
+    LoadProfiler::Get().Record("DecodeMeshes", std::string(), decodeStart, decodeEnd,
+        m_GlobalVertices.size() * sizeof(GLTFVertex) + m_GlobalIndices.size() * sizeof(uint32_t) + m_GlobalIndices16.size() * sizeof(uint16_t));
+    std::cout << "Decoded " << decodeJobs.size() << " primitives in "
+        << std::chrono::duration<double, std::milli>(decodeEnd - decodeStart).count() << " ms ("
+        << (m_ParallelDecode ? "parallel, " + std::to_string(JobSystem::Get().GetWorkerCount() + 1) + " threads" : std::string("serial"))
+        << ")" << std::endl;
+    std::cout << "Index pools: " << totalIndices[IndexPool_16] << " 16-bit, " << totalIndices[IndexPool_32] << " 32-bit indices" << std::endl;
+
+    // Weld duplicate vertices; survivors are compacted to the front of each primitive's slice.
+    // Skinned primitives keep their vertices as decoded (welding ignores joints and weights).
+    if (m_WeldVertices)
+    {
+        auto weldStart = std::chrono::high_resolution_clock::now();
+        std::vector<WeldStats> primitiveStats(decodeJobs.size());
+        forEachPrimitive([&](size_t jobIndex)
+        {
+            GLTFPrimitive& prim = *decodeJobs[jobIndex].target;
+            if (prim.skinned)
+                return;
+            GLTFVertex* vertices = m_GlobalVertices.data() + prim.globalVertexOffset;
+            if (prim.indexPool == IndexPool_16)
+                WeldPrimitive(vertices, prim.vertexCount, m_GlobalIndices16.data() + prim.globalIndexOffset, prim.indexCount, m_WeldSettings, primitiveStats[jobIndex]);
+            else
+                WeldPrimitive(vertices, prim.vertexCount, m_GlobalIndices.data() + prim.globalIndexOffset, prim.indexCount, m_WeldSettings, primitiveStats[jobIndex]);
+        });
+
+        WeldStats stats;
+        for (const auto& primitiveStat : primitiveStats)
+            stats.Merge(primitiveStat);
+
+        auto weldEnd = std::chrono::high_resolution_clock::now();
+        LoadProfiler::Get().Record("WeldVertices", std::string(), weldStart, weldEnd);
+        std::cout << "Welded " << stats.verticesBefore << " vertices to " << stats.verticesAfter << " in "
+            << std::chrono::duration<double, std::milli>(weldEnd - weldStart).count() << " ms ("
+            << (stats.verticesBefore ? 100.0 * (stats.verticesBefore - stats.verticesAfter) / stats.verticesBefore : 0.0) << "% fewer)" << std::endl;
+    }
 
-            // Compute AABB
-            DirectX::XMFLOAT3 minPos, maxPos;
-            if (positionAccessor->has_min && positionAccessor->has_max)
-            {
-                minPos.x = positionAccessor->min[0];
-                minPos.y = positionAccessor->min[1];
-                minPos.z = positionAccessor->min[2];
-                maxPos.x = positionAccessor->max[0];
-                maxPos.y = positionAccessor->max[1];
-                maxPos.z = positionAccessor->max[2];
-            }
+    // Optimize each primitive in its slice; the scene cache then stores the optimized geometry.
+    // Skinned primitives are skipped too: the fetch reorder would separate them from their influences.
+    if (m_OptimizeMeshes)
+    {
+        auto optimizeStart = std::chrono::high_resolution_clock::now();
+        std::vector<MeshOptimizationStats> primitiveStats(decodeJobs.size());
+        forEachPrimitive([&](size_t jobIndex)
+        {
+            GLTFPrimitive& prim = *decodeJobs[jobIndex].target;
+            if (prim.skinned)
+                return;
+            GLTFVertex* vertices = m_GlobalVertices.data() + prim.globalVertexOffset;
+            if (prim.indexPool == IndexPool_16)
+                OptimizePrimitive(vertices, prim.vertexCount, m_GlobalIndices16.data() + prim.globalIndexOffset, prim.indexCount, primitiveStats[jobIndex]);
             else
-            {
-                minPos = {FLT_MAX, FLT_MAX, FLT_MAX};
-                maxPos = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
-                for (const auto& v : gltfPrim.vertices)
-                {
-                    minPos.x = std::min(minPos.x, v.position[0]);
-                    minPos.y = std::min(minPos.y, v.position[1]);
-                    minPos.z = std::min(minPos.z, v.position[2]);
-                    maxPos.x = std::max(maxPos.x, v.position[0]);
-                    maxPos.y = std::max(maxPos.y, v.position[1]);
-                    maxPos.z = std::max(maxPos.z, v.position[2]);
-                }
-            }
-            DirectX::XMFLOAT3 center = {
-                (minPos.x + maxPos.x) * 0.5f,
-                (minPos.y + maxPos.y) * 0.5f,
-                (minPos.z + maxPos.z) * 0.5f
-            };
-            DirectX::XMFLOAT3 extents = {
-                (maxPos.x - minPos.x) * 0.5f,
-                (maxPos.y - minPos.y) * 0.5f,
-                (maxPos.z - minPos.z) * 0.5f
-            };
-            gltfPrim.aabb = DirectX::BoundingBox(center, extents);
-
-            // Read normals (if available)
-            if (normalAccessor)
-            {
-                for (size_t k = 0; k < vertexCount; ++k)
-                {
-                    cgltf_accessor_read_float(normalAccessor, k,
-                        gltfPrim.vertices[k].normal, 3);
-                }
-            }
+                OptimizePrimitive(vertices, prim.vertexCount, m_GlobalIndices.data() + prim.globalIndexOffset, prim.indexCount, primitiveStats[jobIndex]);
+        });
+
+        MeshOptimizationStats stats;
+        for (const auto& primitiveStat : primitiveStats)
+            stats.Merge(primitiveStat);
+
+        auto optimizeEnd = std::chrono::high_resolution_clock::now();
+        LoadProfiler::Get().Record("OptimizeMeshes", std::string(), optimizeStart, optimizeEnd);
+        std::cout << "Optimized " << stats.after.triangles << " triangles in "
+            << std::chrono::duration<double, std::milli>(optimizeEnd - optimizeStart).count() << " ms (ACMR "
+            << stats.before.GetACMR() << " -> " << stats.after.GetACMR() << ", ATVR "
+            << stats.before.GetATVR() << " -> " << stats.after.GetATVR() << ", cache size " << VertexCacheSize << ")" << std::endl;
+    }
+
+    // Split primitives into meshlets; this reorders each primitive's triangles into meshlet order
+    m_Meshlets.clear();
+    if (m_BuildMeshlets)
+    {
+        auto meshletStart = std::chrono::high_resolution_clock::now();
+        std::vector<std::vector<Meshlet>> primitiveMeshlets(decodeJobs.size());
+        forEachPrimitive([&](size_t jobIndex)
+        {
+            GLTFPrimitive& prim = *decodeJobs[jobIndex].target;
+            const GLTFVertex* vertices = m_GlobalVertices.data() + prim.globalVertexOffset;
+            if (prim.indexPool == IndexPool_16)
+                BuildMeshlets(vertices, prim.vertexCount, m_GlobalIndices16.data() + prim.globalIndexOffset, prim.indexCount, primitiveMeshlets[jobIndex]);
             else
-            {
-                // Generate default normals
-                for (size_t k = 0; k < vertexCount; ++k)
-                {
-                    gltfPrim.vertices[k].normal[0] = 0.0f;
-                    gltfPrim.vertices[k].normal[1] = 1.0f;
-                    gltfPrim.vertices[k].normal[2] = 0.0f;
-                }
-            }
+                BuildMeshlets(vertices, prim.vertexCount, m_GlobalIndices.data() + prim.globalIndexOffset, prim.indexCount, primitiveMeshlets[jobIndex]);
+        });
 
-            // Read texture coordinates (if available)
-            if (texCoordAccessor)
-            {
-                for (size_t k = 0; k < vertexCount; ++k)
-                {
-                    cgltf_accessor_read_float(texCoordAccessor, k,
-                        gltfPrim.vertices[k].texCoord, 2);
-                }
-            }
+        for (size_t i = 0; i < decodeJobs.size(); ++i)
+        {
+            GLTFPrimitive& prim = *decodeJobs[i].target;
+            prim.firstMeshlet = static_cast<uint32_t>(m_Meshlets.size());
+            prim.meshletCount = static_cast<uint32_t>(primitiveMeshlets[i].size());
+            m_Meshlets.insert(m_Meshlets.end(), primitiveMeshlets[i].begin(), primitiveMeshlets[i].end());
+        }
+
+        auto meshletEnd = std::chrono::high_resolution_clock::now();
+        LoadProfiler::Get().Record("BuildMeshlets", std::string(), meshletStart, meshletEnd, m_Meshlets.size() * sizeof(Meshlet));
+        std::cout << "Built " << m_Meshlets.size() << " meshlets (" << MaxMeshletVertices << " vertices / " << MaxMeshletTriangles << " triangles max) in "
+            << std::chrono::duration<double, std::milli>(meshletEnd - meshletStart).count() << " ms" << std::endl;
+    }
+
+    // Simplified LODs index the same vertices and are appended to the end of the primitive's index pool
+    for (auto& job : decodeJobs)
+    {
+        GLTFPrimitive& prim = *job.target;
+        prim.lods[0] = { prim.globalIndexOffset, prim.indexCount, 0.0f };
+        prim.lodCount = 1;
+    }
+    if (m_BuildLods)
+    {
+        auto lodStart = std::chrono::high_resolution_clock::now();
+        std::vector<std::vector<SimplifiedLod>> primitiveLods(decodeJobs.size());
+        std::vector<LodStats> primitiveStats(decodeJobs.size());
+        forEachPrimitive([&](size_t jobIndex)
+        {
+            const GLTFPrimitive& prim = *decodeJobs[jobIndex].target;
+            const GLTFVertex* vertices = m_GlobalVertices.data() + prim.globalVertexOffset;
+            if (prim.indexPool == IndexPool_16)
+                BuildLods(vertices, prim.vertexCount, m_GlobalIndices16.data() + prim.globalIndexOffset, prim.indexCount, primitiveLods[jobIndex], primitiveStats[jobIndex]);
             else
-            {
-                // Generate default texture coordinates
-                for (size_t k = 0; k < vertexCount; ++k)
-                {
-                    gltfPrim.vertices[k].texCoord[0] = 0.0f;
-                    gltfPrim.vertices[k].texCoord[1] = 0.0f;
-                }
-            }
+                BuildLods(vertices, prim.vertexCount, m_GlobalIndices.data() + prim.globalIndexOffset, prim.indexCount, primitiveLods[jobIndex], primitiveStats[jobIndex]);
+        });
 
-            // Read indices
-            if (primitive->indices)
+        // Drop the 16-bit pool's even-length padding while appending, then restore it
+        m_GlobalIndices16.resize(static_cast<size_t>(totalIndices[IndexPool_16]));
+        for (size_t i = 0; i < decodeJobs.size(); ++i)
+        {
+            GLTFPrimitive& prim = *decodeJobs[i].target;
+            for (const SimplifiedLod& lod : primitiveLods[i])
             {
-                size_t indexCount = primitive->indices->count;
-                gltfPrim.indices.resize(indexCount);
-
-                for (size_t k = 0; k < indexCount; ++k)
-                {
-                    gltfPrim.indices[k] = static_cast<uint32_t>(cgltf_accessor_read_index(primitive->indices, k));
-                }
+                const size_t offset = prim.indexPool == IndexPool_16 ? m_GlobalIndices16.size() : m_GlobalIndices.size();
+                if (offset + lod.indices.size() > UINT32_MAX)
+                    break;
+                if (prim.indexPool == IndexPool_16)
+                    m_GlobalIndices16.insert(m_GlobalIndices16.end(), lod.indices.begin(), lod.indices.end());
+                else
+                    m_GlobalIndices.insert(m_GlobalIndices.end(), lod.indices.begin(), lod.indices.end());
+                prim.lods[prim.lodCount++] = { static_cast<uint32_t>(offset), static_cast<uint32_t>(lod.indices.size()), lod.error };
             }
-
-            gltfMesh.primitives.push_back(std::move(gltfPrim));
         }
+        m_GlobalIndices16.resize((m_GlobalIndices16.size() + 1) & ~size_t(1));
+
+        LodStats stats;
+        for (const auto& primitiveStat : primitiveStats)
+            stats.Merge(primitiveStat);
+
+        auto lodEnd = std::chrono::high_resolution_clock::now();
+        LoadProfiler::Get().Record("BuildLods", std::string(), lodStart, lodEnd);
+        std::cout << "Built LODs in " << std::chrono::duration<double, std::milli>(lodEnd - lodStart).count() << " ms (triangles per level:";
+        for (uint32_t level = 0; level < MaxLodCount; ++level)
+            std::cout << " " << stats.triangles[level] << " [" << stats.primitives[level] << " primitives]";
+        std::cout << ")" << std::endl;
+        if (stats.violations > 0)
+            std::cerr << stats.violations << " LOD levels failed the reduction or index range checks and were dropped" << std::endl;
+    }
 
-        m_GltfModel.meshes.push_back(std::move(gltfMesh));
+    // Welding and fetch optimization shrink primitives in place; close the gaps they left.
+    // Slices only move down, in ascending order, so each move reads data not yet overwritten.
+    if (m_WeldVertices || m_OptimizeMeshes)
+    {
+        uint32_t packedVertices = 0;
+        for (auto& job : decodeJobs)
+        {
+            GLTFPrimitive& prim = *job.target;
+            if (prim.globalVertexOffset != packedVertices && prim.vertexCount > 0)
+                memmove(&m_GlobalVertices[packedVertices], &m_GlobalVertices[prim.globalVertexOffset], prim.vertexCount * sizeof(GLTFVertex));
+            prim.globalVertexOffset = packedVertices;
+            packedVertices += prim.vertexCount;
+        }
+        m_GlobalVertices.resize(packedVertices);
+        m_GlobalVertices.shrink_to_fit();
     }
 
+    // Drop primitives that were skipped (e.g. missing positions), preserving order
+    for (auto& mesh : m_GltfModel.meshes)
+    {
+        mesh.primitives.erase(std::remove_if(mesh.primitives.begin(), mesh.primitives.end(),
+            [](const GLTFPrimitive& prim) { return prim.vertexCount == 0; }), mesh.primitives.end());
+    }
 
     std::cout << "Successfully loaded GLTF model: " << filepath << " (" << m_GltfModel.meshes.size() << " meshes)" << std::endl;
 
-    BuildNodeHierarchy();
-    LoadAnimations();
+    {
+        LoadProfiler::Scope scope("BuildNodeHierarchy");
+        BuildNodeHierarchy();
+    }
+    {
+        LoadProfiler::Scope scope("LoadSkins");
+        LoadSkins();
+    }
+    {
+        LoadProfiler::Scope scope("LoadAnimations");
+        LoadAnimations();
+    }
+    if (m_CompressAnimations)
+        CompressAnimations();
     if (!m_GltfModel.animations.empty())
-        m_CurrentAnimation = &m_GltfModel.animations[0];
+        PlayAnimation(0);
+
+    m_VertexData = m_GlobalVertices.data();
+    m_VertexCount = m_GlobalVertices.size();
+    m_IndexData = m_GlobalIndices.data();
+    m_IndexCount = m_GlobalIndices.size();
+    m_Index16Data = m_GlobalIndices16.data();
+    m_Index16Count = m_GlobalIndices16.size();
 
     // Create DirectX 12 resources for the loaded model
-    CreateGLTFResources(renderer);
+    BuildDrawCommands();
+    if (!CreateGLTFResources(renderer))
+        return false;
+
+    if (m_UseSceneCache)
+        WriteSceneCache(dir, fileName, cachePath);
 
     return true;
 }
 
-void Model::CreateGLTFResources(Renderer* renderer)
+bool Model::LoadFromSceneCache(Renderer* renderer, const std::string& directory, const std::string& cachePath)
 {
-    // Gather all vertices and indices into global buffers
-    m_GlobalVertices.clear();
-    m_GlobalIndices.clear();
+    auto loadStart = std::chrono::high_resolution_clock::now();
 
-    for (auto& mesh : m_GltfModel.meshes)
-    {
-        for (auto& prim : mesh.primitives)
-        {
-            prim.globalVertexOffset = static_cast<uint32_t>(m_GlobalVertices.size());
-            prim.globalIndexOffset = static_cast<uint32_t>(m_GlobalIndices.size());
+    if (!m_SceneCache.Open(cachePath, directory, HashImportSettings()))
+        return false;
 
-            m_GlobalVertices.insert(m_GlobalVertices.end(), prim.vertices.begin(), prim.vertices.end());
-            m_GlobalIndices.insert(m_GlobalIndices.end(), prim.indices.begin(), prim.indices.end());
-        }
+    // Geometry is uploaded straight out of the mapping
+    m_VertexData = m_SceneCache.GetArray<GLTFVertex>(SceneCache::Section_Vertices, m_VertexCount);
+    m_IndexData = m_SceneCache.GetArray<uint32_t>(SceneCache::Section_Indices, m_IndexCount);
+    m_Index16Data = m_SceneCache.GetArray<uint16_t>(SceneCache::Section_Indices16, m_Index16Count);
+
+    size_t meshletCount = 0;
+    const Meshlet* meshlets = m_SceneCache.GetArray<Meshlet>(SceneCache::Section_Meshlets, meshletCount);
+    m_Meshlets.assign(meshlets, meshlets + meshletCount);
+
+    // Copied: skinning reads them every frame, long after the mapping is released
+    size_t skinVertexCount = 0;
+    const SkinVertex* skinVertices = m_SceneCache.GetArray<SkinVertex>(SceneCache::Section_SkinVertices, skinVertexCount);
+    m_SkinVertices.assign(skinVertices, skinVertices + skinVertexCount);
+
+    size_t drawNodeCount = 0;
+    const DrawNodeData* drawNodes = m_SceneCache.GetArray<DrawNodeData>(SceneCache::Section_DrawNodes, drawNodeCount);
+    m_DrawNodeData.assign(drawNodes, drawNodes + drawNodeCount);
+
+    const SceneCache::Section opaqueSections[IndexPool_Count] = { SceneCache::Section_OpaqueCommands, SceneCache::Section_OpaqueCommands16 };
+    const SceneCache::Section transparentSections[IndexPool_Count] = { SceneCache::Section_TransparentCommands, SceneCache::Section_TransparentCommands16 };
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
+    {
+        size_t opaqueCount = 0, transparentCount = 0;
+        const IndirectDrawCommand* opaqueCommands = m_SceneCache.GetArray<IndirectDrawCommand>(opaqueSections[pool], opaqueCount);
+        const IndirectDrawCommand* transparentCommands = m_SceneCache.GetArray<IndirectDrawCommand>(transparentSections[pool], transparentCount);
+        m_OpaqueCommands[pool].assign(opaqueCommands, opaqueCommands + opaqueCount);
+        m_TransparentCommands[pool].assign(transparentCommands, transparentCommands + transparentCount);
     }
 
-    // Create global vertex buffer
-    if (!m_GlobalVertices.empty())
+    auto commandsValid = [this](const std::vector<IndirectDrawCommand>& commands, IndexPool pool)
     {
-        if (!renderer->CreateStructuredBuffer(m_GlobalVertexBuffer, sizeof(GLTFVertex), m_GlobalVertices.size(), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON))
+        const size_t indexCount = pool == IndexPool_16 ? m_Index16Count : m_IndexCount;
+        for (const auto& cmd : commands)
         {
-            std::cerr << "Failed to create global vertex buffer" << std::endl;
-            return;
+            if (uint64_t(cmd.drawArgs.StartInstanceLocation) + cmd.drawArgs.InstanceCount > m_DrawNodeData.size() ||
+                uint64_t(cmd.drawArgs.StartIndexLocation) + cmd.drawArgs.IndexCountPerInstance > indexCount)
+                return false;
         }
-    }
-
-    // Create global index buffer
-    if (!m_GlobalIndices.empty())
+        return true;
+    };
+
+    uint64_t metaSize = 0;
+    const uint8_t* meta = m_SceneCache.GetSection(SceneCache::Section_Meta, metaSize);
+    bool valid = ReadSceneCacheMeta(meta, metaSize);
+    for (uint32_t pool = 0; pool < IndexPool_Count && valid; ++pool)
+        valid = commandsValid(m_OpaqueCommands[pool], IndexPool(pool)) && commandsValid(m_TransparentCommands[pool], IndexPool(pool));
+    if (!valid)
     {
-        if (!renderer->CreateStructuredBuffer(m_GlobalIndexBuffer, sizeof(uint32_t), m_GlobalIndices.size(), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON))
+        std::cerr << "Scene cache contents invalid, rebuilding: " << cachePath << std::endl;
+        m_GltfModel = GLTFModel();
+        m_MaterialConstants.clear();
+        m_MaterialImages.clear();
+        m_DrawNodeData.clear();
+        m_Meshlets.clear();
+        m_SkinVertices.clear();
+        for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
         {
-            std::cerr << "Failed to create global index buffer" << std::endl;
-            return;
+            m_OpaqueCommands[pool].clear();
+            m_TransparentCommands[pool].clear();
+        }
+        m_VertexData = nullptr;
+        m_VertexCount = 0;
+        m_IndexData = nullptr;
+        m_IndexCount = 0;
+        m_Index16Data = nullptr;
+        m_Index16Count = 0;
+        m_SceneCache.Close();
+        return false;
+    }
+
+    // Set debug counters
+    m_TotalNodes = m_GltfModel.nodes.size();
+    m_TotalRootNodes = m_GltfModel.rootNodes.size();
+
+    // World matrices and AABBs
+    BuildHierarchy();
+
+    if (!m_GltfModel.animations.empty())
+        PlayAnimation(0);
+
+    if (!CreateGLTFResources(renderer))
+        return false;
+
+    auto loadEnd = std::chrono::high_resolution_clock::now();
+    LoadProfiler::Get().Record("LoadSceneCache", std::string(), loadStart, loadEnd,
+        m_VertexCount * sizeof(GLTFVertex) + m_IndexCount * sizeof(uint32_t) + m_Index16Count * sizeof(uint16_t));
+    std::cout << "Scene cache load took " << std::chrono::duration<double, std::milli>(loadEnd - loadStart).count() << " ms" << std::endl;
+    return true;
+}
+
+bool Model::ReadSceneCacheMeta(const uint8_t* data, uint64_t size)
+{
+    CacheReader reader(data, size);
+
+    // Materials
+    if (!reader.ReadArray(m_MaterialConstants) || !reader.ReadArray(m_MaterialImages) ||
+        m_MaterialConstants.empty() || m_MaterialImages.size() != m_MaterialConstants.size())
+        return false;
+
+    // Images
+    uint64_t imageDataSize = 0;
+    const uint8_t* imageData = m_SceneCache.GetSection(SceneCache::Section_ImageData, imageDataSize);
+    uint32_t imageCount = 0;
+    if (!reader.Read(imageCount))
+        return false;
+    m_GltfModel.images.resize(imageCount);
+    for (auto& image : m_GltfModel.images)
+    {
+        CachedImage cached;
+        if (!reader.Read(cached) || !reader.ReadString(image.uri))
+            return false;
+        if (cached.kind == 2)
+        {
+            if (cached.dataOffset > imageDataSize || cached.dataSize > imageDataSize - cached.dataOffset)
+                return false;
+            image.embeddedData = imageData + cached.dataOffset;
+            image.embeddedSize = static_cast<size_t>(cached.dataSize);
+        }
+    }
+
+    for (const auto& images : m_MaterialImages)
+    {
+        for (int imageIndex : { images.baseColor, images.normal, images.metallicRoughness })
+        {
+            if (imageIndex < -1 || imageIndex >= static_cast<int>(imageCount))
+                return false;
+        }
+    }
+
+    // Meshes
+    uint32_t meshCount = 0;
+    if (!reader.Read(meshCount))
+        return false;
+    m_GltfModel.meshes.resize(meshCount);
+    for (auto& mesh : m_GltfModel.meshes)
+    {
+        std::vector<CachedPrimitive> primitives;
+        if (!reader.ReadString(mesh.name) || !reader.ReadArray(primitives))
+            return false;
+
+        mesh.primitives.resize(primitives.size());
+        for (size_t i = 0; i < primitives.size(); ++i)
+        {
+            const CachedPrimitive& cached = primitives[i];
+            if (cached.materialIndex >= m_MaterialConstants.size() || cached.alphaMode > uint32_t(AlphaMode::Blend) ||
+                cached.indexPool >= IndexPool_Count ||
+                uint64_t(cached.globalVertexOffset) + cached.vertexCount > m_VertexCount ||
+                uint64_t(cached.globalIndexOffset) + cached.indexCount > (cached.indexPool == IndexPool_16 ? m_Index16Count : m_IndexCount) ||
+                uint64_t(cached.firstMeshlet) + cached.meshletCount > m_Meshlets.size() ||
+                (cached.skinned && uint64_t(cached.firstSkinVertex) + cached.vertexCount > m_SkinVertices.size()))
+                return false;
+
+            for (uint32_t m = cached.firstMeshlet; m < cached.firstMeshlet + cached.meshletCount; ++m)
+            {
+                if (uint64_t(m_Meshlets[m].firstIndex) + m_Meshlets[m].indexCount > cached.indexCount)
+                    return false;
+            }
+
+            if (cached.lodCount == 0 || cached.lodCount > MaxLodCount)
+                return false;
+            for (uint32_t lod = 0; lod < cached.lodCount; ++lod)
+            {
+                if (uint64_t(cached.lods[lod].globalIndexOffset) + cached.lods[lod].indexCount > (cached.indexPool == IndexPool_16 ? m_Index16Count : m_IndexCount))
+                    return false;
+            }
+
+            GLTFPrimitive& prim = mesh.primitives[i];
+            prim.materialIndex = cached.materialIndex;
+            prim.alphaMode = static_cast<AlphaMode>(cached.alphaMode);
+            prim.indexPool = static_cast<IndexPool>(cached.indexPool);
+            prim.globalVertexOffset = cached.globalVertexOffset;
+            prim.globalIndexOffset = cached.globalIndexOffset;
+            prim.vertexCount = cached.vertexCount;
+            prim.indexCount = cached.indexCount;
+            prim.firstMeshlet = cached.firstMeshlet;
+            prim.meshletCount = cached.meshletCount;
+            prim.lodCount = cached.lodCount;
+            std::copy(cached.lods, cached.lods + MaxLodCount, prim.lods);
+            prim.firstDrawNode = cached.firstDrawNode;
+            prim.skinned = cached.skinned != 0;
+            prim.firstSkinVertex = cached.firstSkinVertex;
+            prim.aabb = DirectX::BoundingBox(cached.aabbCenter, cached.aabbExtents);
+        }
+    }
+
+    // Node hierarchy
+    uint32_t nodeCount = 0;
+    if (!reader.Read(nodeCount))
+        return false;
+    m_GltfModel.nodes.resize(nodeCount);
+    std::vector<CachedNode> cachedNodes(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        if (!reader.ReadString(m_GltfModel.nodes[i].name) || !reader.Read(cachedNodes[i]))
+            return false;
+    }
+
+    std::vector<uint32_t> childIndices;
+    std::vector<uint32_t> rootIndices;
+    if (!reader.ReadArray(childIndices) || !reader.ReadArray(rootIndices))
+        return false;
+
+    // Skins
+    uint32_t skinCount = 0;
+    if (!reader.Read(skinCount))
+        return false;
+    m_GltfModel.skins.resize(skinCount);
+    for (auto& skin : m_GltfModel.skins)
+    {
+        std::vector<uint32_t> jointIndices;
+        if (!reader.ReadString(skin.name) || !reader.ReadArray(jointIndices) || !reader.ReadArray(skin.inverseBindMatrices) ||
+            skin.inverseBindMatrices.size() != jointIndices.size())
+            return false;
+
+        skin.joints.resize(jointIndices.size());
+        for (size_t j = 0; j < jointIndices.size(); ++j)
+        {
+            if (jointIndices[j] >= nodeCount)
+                return false;
+            skin.joints[j] = &m_GltfModel.nodes[jointIndices[j]];
         }
     }
 
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        const CachedNode& cached = cachedNodes[i];
+        GLTFNode& node = m_GltfModel.nodes[i];
+        if (cached.meshIndex < -1 || cached.meshIndex >= static_cast<int32_t>(meshCount) ||
+            cached.skinIndex < -1 || cached.skinIndex >= static_cast<int32_t>(skinCount) ||
+            cached.parentIndex < -1 || cached.parentIndex >= static_cast<int32_t>(nodeCount) ||
+            uint64_t(cached.firstChild) + cached.childCount > childIndices.size())
+            return false;
+
+        node.mesh = cached.meshIndex >= 0 ? &m_GltfModel.meshes[cached.meshIndex] : nullptr;
+        node.skin = cached.skinIndex >= 0 ? &m_GltfModel.skins[cached.skinIndex] : nullptr;
+        node.parent = cached.parentIndex >= 0 ? &m_GltfModel.nodes[cached.parentIndex] : nullptr;
+        node.meshInstance = cached.meshInstance;
+        node.transform = cached.transform;
+        node.translation = cached.translation;
+        node.rotation = cached.rotation;
+        node.scale = cached.scale;
+        if (node.mesh)
+            node.mesh->instanceCount = std::max(node.mesh->instanceCount, node.meshInstance + 1);
+
+        node.children.resize(cached.childCount);
+        for (uint32_t j = 0; j < cached.childCount; ++j)
+        {
+            const uint32_t childIndex = childIndices[cached.firstChild + j];
+            if (childIndex >= nodeCount)
+                return false;
+            node.children[j] = &m_GltfModel.nodes[childIndex];
+        }
+    }
+
+    for (const auto& mesh : m_GltfModel.meshes)
+    {
+        for (const auto& prim : mesh.primitives)
+        {
+            if (mesh.instanceCount > 0 && uint64_t(prim.firstDrawNode) + mesh.instanceCount > m_DrawNodeData.size())
+                return false;
+        }
+    }
+
+    m_GltfModel.rootNodes.resize(rootIndices.size());
+    for (size_t i = 0; i < rootIndices.size(); ++i)
+    {
+        if (rootIndices[i] >= nodeCount)
+            return false;
+        m_GltfModel.rootNodes[i] = &m_GltfModel.nodes[rootIndices[i]];
+    }
+
+    // Animations
+    uint32_t animationCount = 0;
+    if (!reader.Read(animationCount))
+        return false;
+    m_GltfModel.animations.resize(animationCount);
+    for (auto& animation : m_GltfModel.animations)
+    {
+        uint32_t channelCount = 0;
+        if (!reader.ReadString(animation.name) || !reader.Read(channelCount))
+            return false;
+
+        animation.channels.resize(channelCount);
+        for (auto& channel : animation.channels)
+        {
+            CachedChannel cached;
+            if (!reader.Read(cached) || cached.targetNode >= nodeCount || cached.type > GLTFAnimationChannel::Scale ||
+                !reader.ReadArray(channel.times) || !reader.ReadArray(channel.translations) ||
+                !reader.ReadArray(channel.rotations) || !reader.ReadArray(channel.scales) ||
+                !reader.ReadArray(channel.compressedKeys.values))
+                return false;
+
+            channel.type = static_cast<GLTFAnimationChannel::Type>(cached.type);
+            channel.targetNode = &m_GltfModel.nodes[cached.targetNode];
+            std::copy(cached.quantizationOffset, cached.quantizationOffset + 3, channel.compressedKeys.offset);
+            std::copy(cached.quantizationScale, cached.quantizationScale + 3, channel.compressedKeys.scale);
+
+            // UpdateAnimation indexes the value array with the key index
+            if (GetKeyCount(channel) < channel.times.size())
+                return false;
+        }
+        PrepareAnimation(animation);
+    }
+
+    return true;
+}
+
+void Model::WriteSceneCache(const std::string& directory, const std::string& fileName, const std::string& cachePath)
+{
+    // Files the cache was built from; external images are still decoded from their source on a warm start
+    std::vector<std::string> dependencies;
+    dependencies.push_back(fileName);
+    for (size_t i = 0; i < m_GltfModel.data->buffers_count; ++i)
+    {
+        const char* uri = m_GltfModel.data->buffers[i].uri;
+        if (uri && strncmp(uri, "data:", 5) != 0)
+            dependencies.push_back(uri);
+    }
+    for (const auto& image : m_GltfModel.images)
+    {
+        if (!image.uri.empty() && image.uri.compare(0, 5, "data:") != 0)
+            dependencies.push_back(image.uri);
+    }
+
+    CacheWriter meta;
+    CacheWriter imageData;
+
+    // Materials
+    meta.WriteArray(m_MaterialConstants);
+    meta.WriteArray(m_MaterialImages);
+
+    // Images
+    meta.Write(static_cast<uint32_t>(m_GltfModel.images.size()));
+    for (const auto& image : m_GltfModel.images)
+    {
+        CachedImage cached = {};
+        if (!image.uri.empty())
+        {
+            cached.kind = 1;
+        }
+        else if (image.embeddedData)
+        {
+            cached.kind = 2;
+            cached.dataOffset = imageData.GetData().size();
+            cached.dataSize = image.embeddedSize;
+            imageData.WriteBytes(image.embeddedData, image.embeddedSize);
+        }
+        meta.Write(cached);
+        meta.WriteString(image.uri);
+    }
+
+    // Meshes
+    meta.Write(static_cast<uint32_t>(m_GltfModel.meshes.size()));
+    for (const auto& mesh : m_GltfModel.meshes)
+    {
+        std::vector<CachedPrimitive> primitives;
+        for (const auto& prim : mesh.primitives)
+        {
+            CachedPrimitive cached;
+            cached.materialIndex = prim.materialIndex;
+            cached.alphaMode = static_cast<uint32_t>(prim.alphaMode);
+            cached.globalVertexOffset = prim.globalVertexOffset;
+            cached.globalIndexOffset = prim.globalIndexOffset;
+            cached.vertexCount = prim.vertexCount;
+            cached.indexCount = prim.indexCount;
+            cached.indexPool = prim.indexPool;
+            cached.firstMeshlet = prim.firstMeshlet;
+            cached.meshletCount = prim.meshletCount;
+            cached.lodCount = prim.lodCount;
+            std::copy(prim.lods, prim.lods + MaxLodCount, cached.lods);
+            cached.firstDrawNode = prim.firstDrawNode;
+            cached.skinned = prim.skinned ? 1 : 0;
+            cached.firstSkinVertex = prim.firstSkinVertex;
+            cached.aabbCenter = prim.aabb.Center;
+            cached.aabbExtents = prim.aabb.Extents;
+            primitives.push_back(cached);
+        }
+        meta.WriteString(mesh.name);
+        meta.WriteArray(primitives);
+    }
+
+    // Node hierarchy
+    auto getNodeIndex = [this](const GLTFNode* node) { return static_cast<uint32_t>(node - m_GltfModel.nodes.data()); };
+    std::vector<uint32_t> childIndices;
+    meta.Write(static_cast<uint32_t>(m_GltfModel.nodes.size()));
+    for (const auto& node : m_GltfModel.nodes)
+    {
+        CachedNode cached;
+        cached.meshIndex = node.mesh ? static_cast<int32_t>(node.mesh - m_GltfModel.meshes.data()) : -1;
+        cached.skinIndex = node.skin ? static_cast<int32_t>(node.skin - m_GltfModel.skins.data()) : -1;
+        cached.parentIndex = node.parent ? static_cast<int32_t>(getNodeIndex(node.parent)) : -1;
+        cached.firstChild = static_cast<uint32_t>(childIndices.size());
+        cached.childCount = static_cast<uint32_t>(node.children.size());
+        cached.meshInstance = node.meshInstance;
+        cached.transform = node.transform;
+        cached.translation = node.translation;
+        cached.rotation = node.rotation;
+        cached.scale = node.scale;
+        for (const auto* child : node.children)
+            childIndices.push_back(getNodeIndex(child));
+
+        meta.WriteString(node.name);
+        meta.Write(cached);
+    }
+
+    std::vector<uint32_t> rootIndices;
+    for (const auto* rootNode : m_GltfModel.rootNodes)
+        rootIndices.push_back(getNodeIndex(rootNode));
+    meta.WriteArray(childIndices);
+    meta.WriteArray(rootIndices);
+
+    // Skins
+    meta.Write(static_cast<uint32_t>(m_GltfModel.skins.size()));
+    for (const auto& skin : m_GltfModel.skins)
+    {
+        std::vector<uint32_t> jointIndices;
+        for (const auto* joint : skin.joints)
+            jointIndices.push_back(getNodeIndex(joint));
+        meta.WriteString(skin.name);
+        meta.WriteArray(jointIndices);
+        meta.WriteArray(skin.inverseBindMatrices);
+    }
+
+    // Animations
+    meta.Write(static_cast<uint32_t>(m_GltfModel.animations.size()));
+    for (const auto& animation : m_GltfModel.animations)
+    {
+        meta.WriteString(animation.name);
+        meta.Write(static_cast<uint32_t>(animation.channels.size()));
+        for (const auto& channel : animation.channels)
+        {
+            CachedChannel cached;
+            cached.type = static_cast<uint32_t>(channel.type);
+            cached.targetNode = getNodeIndex(channel.targetNode);
+            std::copy(channel.compressedKeys.offset, channel.compressedKeys.offset + 3, cached.quantizationOffset);
+            std::copy(channel.compressedKeys.scale, channel.compressedKeys.scale + 3, cached.quantizationScale);
+            meta.Write(cached);
+            meta.WriteArray(channel.times);
+            meta.WriteArray(channel.translations);
+            meta.WriteArray(channel.rotations);
+            meta.WriteArray(channel.scales);
+            meta.WriteArray(channel.compressedKeys.values);
+        }
+    }
+
+    SceneCache::SectionData sections[SceneCache::Section_Count];
+    sections[SceneCache::Section_Meta] = { meta.GetData().data(), meta.GetData().size() };
+    sections[SceneCache::Section_Vertices] = { m_VertexData, m_VertexCount * sizeof(GLTFVertex) };
+    sections[SceneCache::Section_Indices] = { m_IndexData, m_IndexCount * sizeof(uint32_t) };
+    sections[SceneCache::Section_Indices16] = { m_Index16Data, m_Index16Count * sizeof(uint16_t) };
+    sections[SceneCache::Section_Meshlets] = { m_Meshlets.data(), m_Meshlets.size() * sizeof(Meshlet) };
+    sections[SceneCache::Section_DrawNodes] = { m_DrawNodeData.data(), m_DrawNodeData.size() * sizeof(DrawNodeData) };
+    sections[SceneCache::Section_OpaqueCommands] = { m_OpaqueCommands[IndexPool_32].data(), m_OpaqueCommands[IndexPool_32].size() * sizeof(IndirectDrawCommand) };
+    sections[SceneCache::Section_OpaqueCommands16] = { m_OpaqueCommands[IndexPool_16].data(), m_OpaqueCommands[IndexPool_16].size() * sizeof(IndirectDrawCommand) };
+    sections[SceneCache::Section_TransparentCommands] = { m_TransparentCommands[IndexPool_32].data(), m_TransparentCommands[IndexPool_32].size() * sizeof(IndirectDrawCommand) };
+    sections[SceneCache::Section_TransparentCommands16] = { m_TransparentCommands[IndexPool_16].data(), m_TransparentCommands[IndexPool_16].size() * sizeof(IndirectDrawCommand) };
+    sections[SceneCache::Section_ImageData] = { imageData.GetData().data(), imageData.GetData().size() };
+    sections[SceneCache::Section_SkinVertices] = { m_SkinVertices.data(), m_SkinVertices.size() * sizeof(SkinVertex) };
+
+    SceneCache::Write(cachePath, directory, dependencies, HashImportSettings(), sections);
+}
+
+uint64_t Model::HashImportSettings() const
+{
+    // Field by field, so padding never reaches the hash
+    uint64_t hash = HashData(&m_WeldVertices, sizeof(m_WeldVertices));
+    auto add = [&hash](const auto& value) { hash = HashData(&value, sizeof(value), hash); };
+    add(m_WeldSettings.positionEpsilon);
+    add(m_WeldSettings.normalEpsilon);
+    add(m_WeldSettings.texCoordEpsilon);
+    add(m_OptimizeMeshes);
+    add(m_BuildMeshlets);
+    add(m_BuildLods);
+    add(m_CompressAnimations);
+    add(m_AnimationCompressionSettings.rotationTolerance);
+    add(m_AnimationCompressionSettings.translationTolerance);
+    add(m_AnimationCompressionSettings.scaleTolerance);
+    return hash;
+}
+
+void Model::BuildDrawCommands()
+{
     // Pre-calculate node data for all node-primitive pairs
     m_DrawNodeData.clear();
-    m_OpaqueCommands.clear();
-    m_TransparentCommands.clear();
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
+    {
+        m_OpaqueCommands[pool].clear();
+        m_TransparentCommands[pool].clear();
+    }
 
-    for (uint32_t i = 0; i < static_cast<uint32_t>(m_GltfModel.nodes.size()); ++i)
+    // Number the nodes referencing each mesh
+    for (auto& mesh : m_GltfModel.meshes)
+        mesh.instanceCount = 0;
+    for (auto& node : m_GltfModel.nodes)
     {
-        GLTFNode& node = m_GltfModel.nodes[i];
-        node.nodeDataOffset = static_cast<uint32_t>(m_DrawNodeData.size());
         if (node.mesh)
+            node.meshInstance = node.mesh->instanceCount++;
+    }
+
+    // One instanced draw per primitive; its instances' node data is contiguous so the vertex
+    // shader finds it at SV_StartInstanceLocation + SV_InstanceID
+    for (auto& mesh : m_GltfModel.meshes)
+    {
+        for (auto& prim : mesh.primitives)
         {
-            for (auto& prim : node.mesh->primitives)
-            {
-                DrawNodeData data;
-                DirectX::XMStoreFloat4x4(&data.world, DirectX::XMMatrixIdentity());
-                data.vertexOffset = prim.globalVertexOffset;
-                data.indexOffset = prim.globalIndexOffset;
-                data.materialID = prim.materialIndex;
-                m_DrawNodeData.push_back(data);
-
-                // Create indirect command for this primitive (Indexed)
-                IndirectDrawCommand cmd;
-                cmd.drawArgs.IndexCountPerInstance = static_cast<UINT>(prim.indices.size());
-                cmd.drawArgs.InstanceCount = 1;
-                cmd.drawArgs.StartIndexLocation = prim.globalIndexOffset;
-                cmd.drawArgs.BaseVertexLocation = 0;
-                cmd.drawArgs.StartInstanceLocation = static_cast<UINT>(m_DrawNodeData.size() - 1);
-                
-                if (prim.alphaMode == AlphaMode::Opaque || prim.alphaMode == AlphaMode::Mask)
-                    m_OpaqueCommands.push_back(cmd);
-                else
-                    m_TransparentCommands.push_back(cmd);
-            }
+            prim.firstDrawNode = static_cast<uint32_t>(m_DrawNodeData.size());
+            if (mesh.instanceCount == 0)
+                continue;
+
+            DrawNodeData data;
+            DirectX::XMStoreFloat4x4(&data.world, DirectX::XMMatrixIdentity());
+            data.vertexOffset = prim.globalVertexOffset;
+            data.indexOffset = prim.globalIndexOffset;
+            data.materialID = prim.materialIndex;
+            data.indexPool = prim.indexPool;
+            const PositionQuantization quantization = GetPositionQuantization(prim.aabb);
+            data.positionOffset = { quantization.offset[0], quantization.offset[1], quantization.offset[2], 0.0f };
+            data.positionScale = { quantization.scale[0], quantization.scale[1], quantization.scale[2], 0.0f };
+            m_DrawNodeData.insert(m_DrawNodeData.end(), mesh.instanceCount, data);
+
+            // Create indirect command for this primitive (Indexed)
+            IndirectDrawCommand cmd;
+            cmd.drawArgs.IndexCountPerInstance = prim.indexCount;
+            cmd.drawArgs.InstanceCount = mesh.instanceCount;
+            cmd.drawArgs.StartIndexLocation = prim.globalIndexOffset;
+            cmd.drawArgs.BaseVertexLocation = 0;
+            cmd.drawArgs.StartInstanceLocation = prim.firstDrawNode;
+
+            if (prim.alphaMode == AlphaMode::Opaque || prim.alphaMode == AlphaMode::Mask)
+                m_OpaqueCommands[prim.indexPool].push_back(cmd);
+            else
+                m_TransparentCommands[prim.indexPool].push_back(cmd);
+        }
+    }
+
+    size_t commandCount = 0;
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
+        commandCount += m_OpaqueCommands[pool].size() + m_TransparentCommands[pool].size();
+    std::cout << "Built " << commandCount << " instanced draws for " << m_DrawNodeData.size() << " node primitives" << std::endl;
+}
+
+bool Model::CreateGLTFResources(Renderer* renderer)
+{
+    LoadProfiler::Scope scope("CreateGLTFResources");
+    m_VertexFormat = renderer->GetVertexFormat();
+    m_DrawNodePrimitives.clear();
+    GetDrawNodePrimitives(m_DrawNodePrimitives);
+
+    // Skinned vertices are staged here every frame a joint moves, pooled or not
+    if (!BuildSkinInstances())
+        return false;
+    if (!m_SkinInstances.empty() &&
+        !renderer->CreateBuffer(m_SkinnedVertexUpload, m_SkinVertices.size() * sizeof(GLTFVertex), D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ))
+    {
+        std::cerr << "Failed to create skinning upload buffer" << std::endl;
+        return false;
+    }
+
+    // A Scene owns the buffers of pooled models
+    if (m_Pooled)
+    {
+        UpdateNodeBuffer();
+        return true;
+    }
+
+    // Create global vertex buffer
+    if (m_VertexCount > 0)
+    {
+        if (!renderer->CreateStructuredBuffer(m_GlobalVertexBuffer, GetVertexStride(), m_VertexCount, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON))
+        {
+            std::cerr << "Failed to create global vertex buffer" << std::endl;
+            return false;
+        }
+    }
+
+    // Create global index buffer
+    if (m_IndexCount > 0)
+    {
+        if (!renderer->CreateStructuredBuffer(m_GlobalIndexBuffer, sizeof(uint32_t), m_IndexCount, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON))
+        {
+            std::cerr << "Failed to create global index buffer" << std::endl;
+            return false;
+        }
+    }
+
+    // Create 16-bit global index buffer (bound as an index buffer and a raw root SRV only, so no descriptor)
+    if (m_Index16Count > 0)
+    {
+        if (!renderer->CreateBuffer(m_GlobalIndex16Buffer, m_Index16Count * sizeof(uint16_t), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, false))
+        {
+            std::cerr << "Failed to create 16-bit global index buffer" << std::endl;
+            return false;
         }
     }
 
@@ -330,28 +1274,33 @@ void Model::CreateGLTFResources(Renderer* renderer)
         if (!renderer->CreateStructuredBuffer(m_DrawNodeBuffer, sizeof(DrawNodeData), m_DrawNodeData.size(), D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ))
         {
             std::cerr << "Failed to create draw node buffer" << std::endl;
-            return;
+            return false;
         }
 
-        // Create opaque command buffer
-        if (!m_OpaqueCommands.empty())
+        for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
         {
-            const UINT64 cmdSize = m_OpaqueCommands.size() * sizeof(IndirectDrawCommand);
-            if (!renderer->CreateBuffer(m_OpaqueCommandBuffer, cmdSize, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, false))
+            // Create opaque command buffer (upload heap: UpdateLods rewrites it every frame)
+            if (!m_OpaqueCommands[pool].empty())
             {
-                std::cerr << "Failed to create opaque indirect draw buffer" << std::endl;
-                return;
+                const UINT64 cmdSize = m_OpaqueCommands[pool].size() * sizeof(IndirectDrawCommand);
+                if (!renderer->CreateBuffer(m_OpaqueCommandBuffers[pool], cmdSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, false))
+                {
+                    std::cerr << "Failed to create opaque indirect draw buffer" << std::endl;
+                    return false;
+                }
+                memcpy(m_OpaqueCommandBuffers[pool].cpuPtr, m_OpaqueCommands[pool].data(), cmdSize);
             }
-        }
 
-        // Create transparent command buffer
-        if (!m_TransparentCommands.empty())
-        {
-            const UINT64 cmdSize = m_TransparentCommands.size() * sizeof(IndirectDrawCommand);
-            if (!renderer->CreateBuffer(m_TransparentCommandBuffer, cmdSize, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, false))
+            // Create transparent command buffer
+            if (!m_TransparentCommands[pool].empty())
             {
-                std::cerr << "Failed to create transparent indirect draw buffer" << std::endl;
-                return;
+                const UINT64 cmdSize = m_TransparentCommands[pool].size() * sizeof(IndirectDrawCommand);
+                if (!renderer->CreateBuffer(m_TransparentCommandBuffers[pool], cmdSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, false))
+                {
+                    std::cerr << "Failed to create transparent indirect draw buffer" << std::endl;
+                    return false;
+                }
+                memcpy(m_TransparentCommandBuffers[pool].cpuPtr, m_TransparentCommands[pool].data(), cmdSize);
             }
         }
 
@@ -365,59 +1314,33 @@ void Model::CreateGLTFResources(Renderer* renderer)
         if (!renderer->CreateStructuredBuffer(m_MaterialBuffer, sizeof(MaterialConstants), m_MaterialConstants.size(), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON))
         {
             std::cerr << "Failed to create material buffer" << std::endl;
-            return;
+            return false;
         }
     }
+
+    return true;
 }
 
-void Model::LoadTextures(Renderer* renderer)
+void Model::LoadTextures()
 {
-    // First load images
+    // First record where each image comes from
     m_GltfModel.images.resize(m_GltfModel.data->images_count);
     for (size_t i = 0; i < m_GltfModel.data->images_count; ++i)
     {
         cgltf_image* img = &m_GltfModel.data->images[i];
         GLTFImage& gltfImg = m_GltfModel.images[i];
 
-        DirectX::ScratchImage image;
         if (img->uri)
         {
             // External image
-            std::string uri = img->uri;
-            std::string dirStr(this->fileDirectory.begin(), this->fileDirectory.end());
-            std::string fullPath = dirStr + uri;
-            std::wstring wuri(fullPath.begin(), fullPath.end());
-            CHECK_HR(DirectX::LoadFromWICFile(wuri.c_str(), DirectX::WIC_FLAGS_NONE, nullptr, image), "Load external image failed");
-            gltfImg.image = new DirectX::ScratchImage(std::move(image));
+            gltfImg.uri = img->uri;
         }
         else if (img->buffer_view)
         {
             // Embedded image, assume PNG or use WIC
             cgltf_buffer_view* bv = img->buffer_view;
-            unsigned char* data = (unsigned char*)bv->buffer->data + bv->offset;
-            size_t size = bv->size;
-            CHECK_HR(DirectX::LoadFromWICMemory(data, size, DirectX::WIC_FLAGS_NONE, nullptr, image), "Load embedded image failed");
-            gltfImg.image = new DirectX::ScratchImage(std::move(image));
-        }
-        else
-        {
-            continue;
-        }
-
-        const DirectX::TexMetadata& metaData = gltfImg.image->GetMetadata();
-        DXGI_FORMAT format = metaData.format;
-
-        if (!renderer->CreateTexture(gltfImg.texture,
-            UINT(metaData.width),
-            UINT(metaData.height),
-            format,
-            D3D12_RESOURCE_FLAG_NONE,
-            D3D12_RESOURCE_STATE_COMMON,
-            nullptr, // clearColor
-            UINT(metaData.mipLevels)))
-        {
-            std::cerr << "Failed to create texture resource for image: " << i << std::endl;
-            continue;
+            gltfImg.embeddedData = (const uint8_t*)bv->buffer->data + bv->offset;
+            gltfImg.embeddedSize = bv->size;
         }
     }
 
@@ -437,11 +1360,21 @@ void Model::LoadTextures(Renderer* renderer)
 void Model::LoadMaterials()
 {
     m_MaterialConstants.resize(m_GltfModel.data->materials_count);
+    m_MaterialImages.assign(m_GltfModel.data->materials_count, MaterialImageRefs());
+
+    // glTF image index behind a texture view, or -1
+    auto getImageIndex = [this](const cgltf_texture_view& view) -> int
+    {
+        if (!view.texture || !view.texture->image)
+            return -1;
+        return static_cast<int>(view.texture->image - m_GltfModel.data->images);
+    };
 
     for (size_t i = 0; i < m_GltfModel.data->materials_count; ++i)
     {
         cgltf_material* material = &m_GltfModel.data->materials[i];
         MaterialConstants& mc = m_MaterialConstants[i];
+        MaterialImageRefs& images = m_MaterialImages[i];
 
         // Default values
         mc.baseColorFactor = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
@@ -450,6 +1383,7 @@ void Model::LoadMaterials()
         mc.baseColorTextureIndex = -1;
         mc.normalTextureIndex = -1;
         mc.metallicRoughnessTextureIndex = -1;
+        mc.flags = 0;
 
         if (material->has_pbr_metallic_roughness)
         {
@@ -461,45 +1395,11 @@ void Model::LoadMaterials()
             mc.metallicFactor = material->pbr_metallic_roughness.metallic_factor;
             mc.roughnessFactor = material->pbr_metallic_roughness.roughness_factor;
 
-            if (material->pbr_metallic_roughness.base_color_texture.texture)
-            {
-                size_t texIndex = material->pbr_metallic_roughness.base_color_texture.texture - m_GltfModel.data->textures;
-                if (texIndex < m_GltfModel.textures.size())
-                {
-                    GLTFTexture* baseColorTexture = &m_GltfModel.textures[texIndex];
-                    if (baseColorTexture->source)
-                    {
-                        mc.baseColorTextureIndex = baseColorTexture->source->texture.srvIndex;
-                    }
-                }
-            }
-
-            if (material->pbr_metallic_roughness.metallic_roughness_texture.texture)
-            {
-                size_t texIndex = material->pbr_metallic_roughness.metallic_roughness_texture.texture - m_GltfModel.data->textures;
-                if (texIndex < m_GltfModel.textures.size())
-                {
-                    GLTFTexture* mrTexture = &m_GltfModel.textures[texIndex];
-                    if (mrTexture->source)
-                    {
-                        mc.metallicRoughnessTextureIndex = mrTexture->source->texture.srvIndex;
-                    }
-                }
-            }
+            images.baseColor = getImageIndex(material->pbr_metallic_roughness.base_color_texture);
+            images.metallicRoughness = getImageIndex(material->pbr_metallic_roughness.metallic_roughness_texture);
         }
 
-        if (material->normal_texture.texture)
-        {
-            size_t texIndex = material->normal_texture.texture - m_GltfModel.data->textures;
-            if (texIndex < m_GltfModel.textures.size())
-            {
-                GLTFTexture* normalTexture = &m_GltfModel.textures[texIndex];
-                if (normalTexture->source)
-                {
-                    mc.normalTextureIndex = normalTexture->source->texture.srvIndex;
-                }
-            }
-        }
+        images.normal = getImageIndex(material->normal_texture);
     }
 
     if (m_MaterialConstants.empty())
@@ -511,7 +1411,36 @@ void Model::LoadMaterials()
         mc.baseColorTextureIndex = -1;
         mc.normalTextureIndex = -1;
         mc.metallicRoughnessTextureIndex = -1;
+        mc.flags = 0;
         m_MaterialConstants.push_back(mc);
+        m_MaterialImages.push_back(MaterialImageRefs());
+    }
+}
+
+void Model::ResolveMaterialTextures()
+{
+    // Point each material at the bindless SRV of its images
+    auto getSrvIndex = [this](int imageIndex) -> int
+    {
+        if (imageIndex < 0 || imageIndex >= static_cast<int>(m_GltfModel.images.size()))
+            return -1;
+        const GLTFImage& image = m_GltfModel.images[imageIndex];
+        if (image.streamHandle >= 0)
+            return static_cast<int>(m_TextureStreamer.GetSRVIndex(image.streamHandle));
+        return image.texture.resource ? static_cast<int>(image.texture.srvIndex) : -1;
+    };
+
+    for (size_t i = 0; i < m_MaterialConstants.size(); ++i)
+    {
+        MaterialConstants& mc = m_MaterialConstants[i];
+        const MaterialImageRefs& images = m_MaterialImages[i];
+        mc.baseColorTextureIndex = getSrvIndex(images.baseColor);
+        mc.normalTextureIndex = getSrvIndex(images.normal);
+        mc.metallicRoughnessTextureIndex = getSrvIndex(images.metallicRoughness);
+
+        mc.flags = 0;
+        if (mc.metallicRoughnessTextureIndex >= 0 && m_GltfModel.images[images.metallicRoughness].packedMetallicRoughness)
+            mc.flags |= MaterialFlag_PackedMetallicRoughness;
     }
 }
 
@@ -581,18 +1510,20 @@ void Model::BuildNodeHierarchy()
     m_TotalNodes = m_GltfModel.nodes.size();
     m_TotalRootNodes = m_GltfModel.rootNodes.size();
 
-    // Compute world AABBs
-    for (auto* rootNode : m_GltfModel.rootNodes)
-    {
-        ComputeWorldAABBs(rootNode, DirectX::XMMatrixIdentity());
-    }
+    // World matrices and AABBs
+    BuildHierarchy();
 }
 
 void Model::UpdateNodeBuffer()
 {
-    for (auto* rootNode : m_GltfModel.rootNodes)
+    const NodeHierarchy& hierarchy = m_GltfModel.hierarchy;
+    for (size_t i = 0; i < hierarchy.nodes.size(); ++i)
     {
-        UpdateNodeBufferRecursive(rootNode, DirectX::XMMatrixIdentity());
+        const GLTFNode& node = *hierarchy.nodes[i];
+        if (!node.mesh)
+            continue;
+        for (uint32_t j = 0; j < static_cast<uint32_t>(node.mesh->primitives.size()); ++j)
+            m_DrawNodeData[GetDrawNodeIndex(node, j)].world = hierarchy.worlds[i];
     }
 
     if (m_DrawNodeBuffer.cpuPtr)
@@ -601,77 +1532,85 @@ void Model::UpdateNodeBuffer()
     }
 }
 
-void Model::UpdateNodeBufferRecursive(GLTFNode* node, DirectX::XMMATRIX parentTransform)
+void Model::BuildHierarchy()
 {
-    DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&node->transform) * parentTransform;
-
-    if (node->mesh)
+    LoadProfiler::Scope scope("BuildHierarchy");
+    NodeHierarchy& hierarchy = m_GltfModel.hierarchy;
+    hierarchy = NodeHierarchy();
+    const size_t nodeCount = m_GltfModel.nodes.size();
+    hierarchy.nodes.reserve(nodeCount);
+    hierarchy.parents.reserve(nodeCount);
+    hierarchy.locals.reserve(nodeCount);
+
+    // Depth-first pre-order. Nodes outside the scene's trees follow as roots of their own, so
+    // every node has a slot; a node reached twice (a malformed, cyclic file) keeps its first.
+    std::vector<uint8_t> visited(nodeCount, 0);
+    std::vector<std::pair<GLTFNode*, int32_t>> stack;
+    auto flatten = [&](GLTFNode* root)
     {
-        for (uint32_t i = 0; i < static_cast<uint32_t>(node->mesh->primitives.size()); ++i)
+        stack.push_back({ root, -1 });
+        while (!stack.empty())
         {
-            uint32_t nodeDataIndex = node->nodeDataOffset + i;
-            DirectX::XMStoreFloat4x4(&m_DrawNodeData[nodeDataIndex].world, world);
+            const auto [node, parent] = stack.back();
+            stack.pop_back();
+            const size_t nodeIndex = node - m_GltfModel.nodes.data();
+            if (visited[nodeIndex])
+                continue;
+            visited[nodeIndex] = 1;
+
+            node->hierarchyIndex = static_cast<uint32_t>(hierarchy.nodes.size());
+            hierarchy.nodes.push_back(node);
+            hierarchy.parents.push_back(parent);
+            hierarchy.locals.push_back(node->transform);
+            for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+                stack.push_back({ *it, static_cast<int32_t>(node->hierarchyIndex) });
         }
+    };
+    for (auto* rootNode : m_GltfModel.rootNodes)
+        flatten(rootNode);
+    for (auto& node : m_GltfModel.nodes)
+    {
+        if (!visited[&node - m_GltfModel.nodes.data()])
+            flatten(&node);
     }
 
-    for (auto* child : node->children)
+    const size_t count = hierarchy.nodes.size();
+    hierarchy.subtreeEnds.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        hierarchy.subtreeEnds[i] = static_cast<uint32_t>(i + 1);
+    for (size_t i = count; i-- > 0;)
     {
-        UpdateNodeBufferRecursive(child, world);
+        if (hierarchy.parents[i] >= 0)
+            hierarchy.subtreeEnds[hierarchy.parents[i]] = std::max(hierarchy.subtreeEnds[hierarchy.parents[i]], hierarchy.subtreeEnds[i]);
     }
+
+    hierarchy.worlds.resize(count);
+    hierarchy.worldAabbs.resize(count);
+    hierarchy.meshAabbs.resize(count);
+    hierarchy.dirty.assign(count, 1);
+    hierarchy.states.assign(count, 0);
+    PropagateTransforms(false);
 }
 
-void Model::ComputeWorldAABBs(GLTFNode* node, DirectX::XMMATRIX parentTransform)
+void Model::PropagateTransforms(bool writeDrawNodes)
 {
-    DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&node->transform) * parentTransform;
-
-    // Recurse FIRST (Post-order) so children's worldAabbs are calculated
-    for (auto* child : node->children)
-    {
-        ComputeWorldAABBs(child, world);
-    }
-
-    // Now compute this node's world AABB including its meshes and all children
-    bool initialized = false;
-    if (node->mesh)
-    {
-        for (auto& prim : node->mesh->primitives)
-        {
-            DirectX::BoundingBox transformedAabb;
-            prim.aabb.Transform(transformedAabb, world);
-            if (!initialized)
-            {
-                node->worldAabb = transformedAabb;
-                initialized = true;
-            }
-            else
-            {
-                DirectX::BoundingBox::CreateMerged(node->worldAabb, node->worldAabb, transformedAabb);
-            }
-        }
-    }
+    NodeHierarchy& hierarchy = m_GltfModel.hierarchy;
+    PropagateNodeTransforms(hierarchy);
+    if (!writeDrawNodes)
+        return;
 
-    for (auto* child : node->children)
+    for (size_t i = 0; i < hierarchy.nodes.size(); ++i)
     {
-        if (!initialized)
-        {
-            node->worldAabb = child->worldAabb;
-            initialized = true;
-        }
-        else
+        const GLTFNode& node = *hierarchy.nodes[i];
+        if (!(hierarchy.states[i] & NodeState_Moved) || !node.mesh)
+            continue;
+        for (uint32_t j = 0; j < static_cast<uint32_t>(node.mesh->primitives.size()); ++j)
         {
-            DirectX::BoundingBox::CreateMerged(node->worldAabb, node->worldAabb, child->worldAabb);
+            const uint32_t nodeDataIndex = GetDrawNodeIndex(node, j);
+            m_DrawNodeData[nodeDataIndex].world = hierarchy.worlds[i];
+            m_DirtyDrawNodes.push_back(nodeDataIndex);
         }
     }
-
-    if (!initialized)
-    {
-        // If no mesh and no children, set a default AABB at the node's position
-        DirectX::XMVECTOR scale, rot, trans;
-        DirectX::XMMatrixDecompose(&scale, &rot, &trans, world);
-        DirectX::XMFLOAT3 pos;
-        DirectX::XMStoreFloat3(&pos, trans);
-        node->worldAabb = DirectX::BoundingBox(pos, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
-    }
 }
 
 void Model::LoadAnimations()
@@ -684,21 +1623,29 @@ void Model::LoadAnimations()
         GLTFAnimation& gltfAnim = m_GltfModel.animations[i];
         if (anim->name)
             gltfAnim.name = anim->name;
-        gltfAnim.channels.resize(anim->channels_count);
+        gltfAnim.channels.reserve(anim->channels_count);
         for (size_t j = 0; j < anim->channels_count; ++j)
         {
             cgltf_animation_channel* channel = &anim->channels[j];
-            GLTFAnimationChannel& gltfChannel = gltfAnim.channels[j];
-            // Target node
-            size_t nodeIndex = channel->target_node - m_GltfModel.data->nodes;
-            gltfChannel.targetNode = &m_GltfModel.nodes[nodeIndex];
-            // Type
+            // Only node TRS is animated: morph target weights (and channels without a target
+            // node) are not loaded at all
+            GLTFAnimationChannel::Type type;
             if (channel->target_path == cgltf_animation_path_type_translation)
-                gltfChannel.type = GLTFAnimationChannel::Translation;
+                type = GLTFAnimationChannel::Translation;
             else if (channel->target_path == cgltf_animation_path_type_rotation)
-                gltfChannel.type = GLTFAnimationChannel::Rotation;
+                type = GLTFAnimationChannel::Rotation;
             else if (channel->target_path == cgltf_animation_path_type_scale)
-                gltfChannel.type = GLTFAnimationChannel::Scale;
+                type = GLTFAnimationChannel::Scale;
+            else
+                continue;
+            if (!channel->target_node)
+                continue;
+
+            GLTFAnimationChannel& gltfChannel = gltfAnim.channels.emplace_back();
+            gltfChannel.type = type;
+            // Target node
+            size_t nodeIndex = channel->target_node - m_GltfModel.data->nodes;
+            gltfChannel.targetNode = &m_GltfModel.nodes[nodeIndex];
             // Times
             cgltf_accessor* timeAccessor = channel->sampler->input;
             gltfChannel.times.resize(timeAccessor->count);
@@ -745,247 +1692,954 @@ void Model::LoadAnimations()
                 }
             }
         }
+        PrepareAnimation(gltfAnim);
+    }
+}
+
+void Model::CompressAnimations()
+{
+    if (m_GltfModel.animations.empty())
+        return;
+
+    auto compressStart = std::chrono::high_resolution_clock::now();
+    AnimationCompressionStats totals;
+    for (GLTFAnimation& animation : m_GltfModel.animations)
+    {
+        std::vector<AnimationCompressionStats> channelStats(animation.channels.size());
+        JobSystem::Get().ParallelFor(animation.channels.size(), [&](size_t i)
+        {
+            CompressAnimationChannel(animation.channels[i], m_AnimationCompressionSettings, channelStats[i]);
+        });
+        PrepareAnimation(animation);
+
+        AnimationCompressionStats stats;
+        for (const auto& channelStat : channelStats)
+            stats.Merge(channelStat);
+        totals.Merge(stats);
+        std::cout << "Animation '" << animation.name << "': " << stats.keysBefore << " keys to " << stats.keysAfter << ", "
+            << stats.bytesBefore / 1024.0 << " KB to " << stats.bytesAfter / 1024.0 << " KB, max error "
+            << stats.rotationError << " rad, " << stats.translationError << " translation, " << stats.scaleError << " scale" << std::endl;
+        if (stats.uncompressedChannels > 0)
+        {
+            std::cout << "Animation '" << animation.name << "': " << stats.uncompressedChannels
+                << " channel(s) left uncompressed, their range is too wide for 16-bit keys within the tolerance" << std::endl;
+        }
+    }
+
+    auto compressEnd = std::chrono::high_resolution_clock::now();
+    LoadProfiler::Get().Record("CompressAnimations", std::string(), compressStart, compressEnd, totals.bytesBefore);
+    std::cout << "Compressed " << m_GltfModel.animations.size() << " animations from " << totals.bytesBefore / 1024.0 << " KB to "
+        << totals.bytesAfter / 1024.0 << " KB in " << std::chrono::duration<double, std::milli>(compressEnd - compressStart).count() << " ms ("
+        << (totals.bytesBefore ? 100.0 * (totals.bytesBefore - totals.bytesAfter) / totals.bytesBefore : 0.0) << "% smaller)" << std::endl;
+}
+
+void Model::LoadSkins()
+{
+    m_GltfModel.skins.resize(m_GltfModel.data->skins_count);
+    for (size_t i = 0; i < m_GltfModel.data->skins_count; ++i)
+    {
+        const cgltf_skin* skin = &m_GltfModel.data->skins[i];
+        GLTFSkin& gltfSkin = m_GltfModel.skins[i];
+        if (skin->name)
+            gltfSkin.name = skin->name;
+
+        gltfSkin.joints.resize(skin->joints_count);
+        DirectX::XMFLOAT4X4 identity;
+        DirectX::XMStoreFloat4x4(&identity, DirectX::XMMatrixIdentity());
+        gltfSkin.inverseBindMatrices.assign(skin->joints_count, identity);
+        for (size_t j = 0; j < skin->joints_count; ++j)
+        {
+            gltfSkin.joints[j] = &m_GltfModel.nodes[skin->joints[j] - m_GltfModel.data->nodes];
+            // Column-major glTF matrices are DirectXMath's row-vector layout as they are
+            if (skin->inverse_bind_matrices && j < skin->inverse_bind_matrices->count &&
+                !cgltf_accessor_read_float(skin->inverse_bind_matrices, j, &gltfSkin.inverseBindMatrices[j].m[0][0], 16))
+                std::cerr << "Failed to read inverse bind matrix " << j << " of skin " << gltfSkin.name << std::endl;
+        }
+    }
+
+    for (size_t i = 0; i < m_GltfModel.data->nodes_count; ++i)
+    {
+        const cgltf_skin* skin = m_GltfModel.data->nodes[i].skin;
+        if (skin)
+            m_GltfModel.nodes[i].skin = &m_GltfModel.skins[skin - m_GltfModel.data->skins];
+    }
+}
+
+bool Model::BuildSkinInstances()
+{
+    m_SkinInstances.clear();
+    m_JointPalette.clear();
+
+    for (auto& node : m_GltfModel.nodes)
+    {
+        if (!node.skin || !node.mesh)
+            continue;
+
+        bool hasSkinnedPrimitive = false;
+        bool jointsValid = true;
+        for (const auto& prim : node.mesh->primitives)
+        {
+            if (!prim.skinned)
+                continue;
+            hasSkinnedPrimitive = true;
+            for (uint32_t v = 0; v < prim.vertexCount && jointsValid; ++v)
+            {
+                const SkinVertex& vertex = m_SkinVertices[prim.firstSkinVertex + v];
+                for (uint32_t i = 0; i < 4; ++i)
+                    jointsValid &= vertex.weights[i] == 0.0f || vertex.joints[i] < node.skin->joints.size();
+            }
+        }
+        if (!hasSkinnedPrimitive)
+            continue;
+
+        // Skinned vertices overwrite the mesh's one vertex range, so only a single node may draw it
+        const char* unsupported = m_VertexFormat != VertexFormat::Full ? "skinning needs the full vertex format"
+            : node.mesh->instanceCount > 1 ? "its mesh is drawn by several nodes"
+            : !jointsValid ? "its vertices reference joints outside the skin" : nullptr;
+        if (unsupported)
+        {
+            std::cerr << "Cannot skin node '" << node.name << "': " << unsupported << std::endl;
+            m_SkinInstances.clear();
+            m_JointPalette.clear();
+            return false;
+        }
+
+        SkinInstance instance;
+        instance.node = &node;
+        instance.skin = node.skin;
+        instance.firstPaletteMatrix = static_cast<uint32_t>(m_JointPalette.size());
+        m_SkinInstances.push_back(instance);
+        m_JointPalette.resize(m_JointPalette.size() + node.skin->joints.size());
+    }
+
+    if (!m_SkinInstances.empty())
+        std::cout << "Skinning " << m_SkinInstances.size() << " nodes (" << m_SkinVertices.size() << " skin vertices, " << m_JointPalette.size() << " joints)" << std::endl;
+    return true;
+}
+
+uint32_t Model::PlayAnimation(size_t animation, float weight, float speed, float startTime)
+{
+    if (animation >= m_GltfModel.animations.size())
+        return 0;
+
+    AnimationInstance instance;
+    instance.id = m_NextAnimationInstanceId++;
+    instance.animation = &m_GltfModel.animations[animation];
+    instance.time = startTime;
+    instance.speed = speed;
+    instance.weight = weight;
+    instance.cursors.assign(instance.animation->channels.size(), 0);
+    m_AnimationInstances.push_back(std::move(instance));
+    return m_AnimationInstances.back().id;
+}
+
+void Model::StopAnimation(uint32_t instance)
+{
+    m_AnimationInstances.erase(std::remove_if(m_AnimationInstances.begin(), m_AnimationInstances.end(),
+        [instance](const AnimationInstance& playing) { return playing.id == instance; }), m_AnimationInstances.end());
+}
+
+void Model::SetAnimationWeight(uint32_t instance, float weight)
+{
+    for (AnimationInstance& playing : m_AnimationInstances)
+    {
+        if (playing.id == instance)
+            playing.weight = weight;
+    }
+}
+
+size_t Model::GetAnimatedChannelCount() const
+{
+    size_t count = 0;
+    for (const AnimationInstance& instance : m_AnimationInstances)
+        count += instance.animation->channels.size();
+    return count;
+}
+
+void Model::UpdateAnimation(float deltaTime)
+{
+    AdvanceAnimations(deltaTime);
+    JobSystem::Get().ParallelFor(m_AnimationInstances.size(), [this](size_t i) { SampleAnimation(i); });
+    ApplyAnimations();
+}
+
+void Model::AdvanceAnimations(float deltaTime)
+{
+    // For simplicity, every instance loops
+    for (AnimationInstance& instance : m_AnimationInstances)
+    {
+        instance.time += deltaTime * instance.speed;
+        const float duration = instance.animation->duration;
+        if (duration > 0.0f)
+        {
+            instance.time = fmod(instance.time, duration);
+            if (instance.time < 0.0f)
+                instance.time += duration;
+        }
+    }
+}
+
+void Model::SampleAnimation(size_t instanceIndex)
+{
+    // Sample each channel type in batches of four; the results stay in the instance's lanes
+    auto sampleStart = std::chrono::high_resolution_clock::now();
+    AnimationInstance& instance = m_AnimationInstances[instanceIndex];
+    const GLTFAnimation& animation = *instance.animation;
+    for (uint32_t type = 0; type < GLTFAnimationChannel::TypeCount; ++type)
+    {
+        if (animation.typeChannels[type].empty())
+            continue;
+
+        AnimationSampleLanes& lanes = instance.lanes[type];
+        GatherKeyframes(animation, GLTFAnimationChannel::Type(type), instance.time, instance.cursors, lanes);
+        if (type == GLTFAnimationChannel::Rotation)
+            SlerpLanes(lanes);
+        else
+            LerpLanes(lanes, 3);
+    }
+    auto sampleEnd = std::chrono::high_resolution_clock::now();
+    instance.sampleMs = std::chrono::duration<float, std::milli>(sampleEnd - sampleStart).count();
+}
+
+void Model::ApplyAnimations()
+{
+    if (m_AnimationInstances.empty())
+        return;
+
+    auto applyStart = std::chrono::high_resolution_clock::now();
+    if (m_AnimationBlends.size() != m_GltfModel.hierarchy.nodes.size())
+        m_AnimationBlends.assign(m_GltfModel.hierarchy.nodes.size(), AnimationBlend());
+
+    // Weighted sums per node and channel type, rotations sign-aligned to the first one summed
+    float sampleMs = 0.0f;
+    m_AnimationTargets.clear();
+    for (const AnimationInstance& instance : m_AnimationInstances)
+    {
+        sampleMs += instance.sampleMs;
+        if (instance.weight <= 0.0f)
+            continue;
+
+        const GLTFAnimation& animation = *instance.animation;
+        for (uint32_t type = 0; type < GLTFAnimationChannel::TypeCount; ++type)
+        {
+            const std::vector<uint32_t>& channels = animation.typeChannels[type];
+            const auto& lanes = instance.lanes[type].from;
+            for (size_t i = 0; i < channels.size(); ++i)
+            {
+                GLTFNode* node = animation.channels[channels[i]].targetNode;
+                AnimationBlend& blend = m_AnimationBlends[node->hierarchyIndex];
+                if (!blend.targeted)
+                {
+                    blend.targeted = true;
+                    m_AnimationTargets.push_back(node);
+                }
+
+                const float w = instance.weight;
+                if (type == GLTFAnimationChannel::Translation)
+                {
+                    blend.translation.x += lanes[0][i] * w;
+                    blend.translation.y += lanes[1][i] * w;
+                    blend.translation.z += lanes[2][i] * w;
+                }
+                else if (type == GLTFAnimationChannel::Rotation)
+                {
+                    const float dot = blend.rotation.x * lanes[0][i] + blend.rotation.y * lanes[1][i] + blend.rotation.z * lanes[2][i] + blend.rotation.w * lanes[3][i];
+                    const float sw = dot < 0.0f ? -w : w;
+                    blend.rotation.x += lanes[0][i] * sw;
+                    blend.rotation.y += lanes[1][i] * sw;
+                    blend.rotation.z += lanes[2][i] * sw;
+                    blend.rotation.w += lanes[3][i] * sw;
+                }
+                else
+                {
+                    blend.scale.x += lanes[0][i] * w;
+                    blend.scale.y += lanes[1][i] * w;
+                    blend.scale.z += lanes[2][i] * w;
+                }
+                blend.weights[type] += w;
+            }
+        }
+    }
+
+    // Normalize into the nodes (types no instance animates keep their value) and compose each
+    // animated node's matrix once, however many channels target it
+    for (GLTFNode* node : m_AnimationTargets)
+    {
+        AnimationBlend& blend = m_AnimationBlends[node->hierarchyIndex];
+        if (blend.weights[GLTFAnimationChannel::Translation] > 0.0f)
+        {
+            DirectX::XMStoreFloat3(&node->translation, DirectX::XMVectorScale(DirectX::XMLoadFloat3(&blend.translation), 1.0f / blend.weights[GLTFAnimationChannel::Translation]));
+        }
+        if (blend.weights[GLTFAnimationChannel::Rotation] > 0.0f)
+        {
+            DirectX::XMStoreFloat4(&node->rotation, DirectX::XMQuaternionNormalize(DirectX::XMLoadFloat4(&blend.rotation)));
+        }
+        if (blend.weights[GLTFAnimationChannel::Scale] > 0.0f)
+        {
+            DirectX::XMStoreFloat3(&node->scale, DirectX::XMVectorScale(DirectX::XMLoadFloat3(&blend.scale), 1.0f / blend.weights[GLTFAnimationChannel::Scale]));
+        }
+        blend = AnimationBlend();
+
+        DirectX::XMMATRIX t = DirectX::XMMatrixTranslation(node->translation.x, node->translation.y, node->translation.z);
+        DirectX::XMMATRIX r = DirectX::XMMatrixRotationQuaternion(DirectX::XMVectorSet(node->rotation.x, node->rotation.y, node->rotation.z, node->rotation.w));
+        DirectX::XMMATRIX s = DirectX::XMMatrixScaling(node->scale.x, node->scale.y, node->scale.z);
+        DirectX::XMStoreFloat4x4(&node->transform, s * r * t);
+        MarkTransformDirty(node);
+    }
+    auto applyEnd = std::chrono::high_resolution_clock::now();
+    m_AnimationSampleMs = sampleMs + std::chrono::duration<float, std::milli>(applyEnd - applyStart).count();
+
+    // Only the animated subtrees and their ancestors' AABBs are updated
+    UpdateTransforms();
+}
+
+void Model::MarkTransformDirty(GLTFNode* node)
+{
+    NodeHierarchy& hierarchy = m_GltfModel.hierarchy;
+    hierarchy.locals[node->hierarchyIndex] = node->transform;
+    hierarchy.dirty[node->hierarchyIndex] = 1;
+    m_TransformsDirty = true;
+}
+
+void Model::UpdateTransforms()
+{
+    if (!m_TransformsDirty)
+        return;
+    m_TransformsDirty = false;
+    PropagateTransforms(true);
+
+    // Skins follow their node and joints; PropagateTransforms left the moved nodes flagged
+    const NodeHierarchy& hierarchy = m_GltfModel.hierarchy;
+    auto moved = [&](const GLTFNode* node) { return (hierarchy.states[node->hierarchyIndex] & NodeState_Moved) != 0; };
+    for (SkinInstance& instance : m_SkinInstances)
+    {
+        if (instance.dirty || moved(instance.node))
+        {
+            instance.dirty = true;
+            continue;
+        }
+        for (const GLTFNode* joint : instance.skin->joints)
+        {
+            if (moved(joint))
+            {
+                instance.dirty = true;
+                break;
+            }
+        }
+    }
+
+    // Pooled models leave the records to their Scene
+    if (m_DrawNodeBuffer.cpuPtr && !m_DirtyDrawNodes.empty())
+    {
+        TakeDirtyDrawNodes(m_DirtyDrawNodeRanges);
+        for (const DrawNodeRange& range : m_DirtyDrawNodeRanges)
+            memcpy(static_cast<DrawNodeData*>(m_DrawNodeBuffer.cpuPtr) + range.first, &m_DrawNodeData[range.first], range.count * sizeof(DrawNodeData));
+    }
+}
+
+void Model::TakeDirtyDrawNodes(std::vector<DrawNodeRange>& ranges)
+{
+    ranges.clear();
+    std::sort(m_DirtyDrawNodes.begin(), m_DirtyDrawNodes.end());
+    for (size_t i = 0; i < m_DirtyDrawNodes.size(); ++i)
+    {
+        const uint32_t index = m_DirtyDrawNodes[i];
+        if (!ranges.empty() && index < ranges.back().first + ranges.back().count)
+            continue; // Duplicate
+        if (!ranges.empty() && index == ranges.back().first + ranges.back().count)
+            ++ranges.back().count;
+        else
+            ranges.push_back({ index, 1 });
+    }
+    m_DirtyDrawNodes.clear();
+}
+
+bool Model::SkinVertices()
+{
+    m_SkinnedPrimitives.clear();
+    m_SkinnedVertexCount = 0;
+    if (!m_SkinnedVertexUpload.cpuPtr)
+        return false;
+
+    std::vector<SkinInstance*> dirtyInstances;
+    for (SkinInstance& instance : m_SkinInstances)
+    {
+        if (instance.dirty)
+            dirtyInstances.push_back(&instance);
+    }
+    if (dirtyInstances.empty())
+        return false;
+
+    auto skinningStart = std::chrono::high_resolution_clock::now();
+    const NodeHierarchy& hierarchy = m_GltfModel.hierarchy;
+
+    // Joint palettes: inverseBind * jointWorld * inverse(nodeWorld)
+    JobSystem::Get().ParallelFor(dirtyInstances.size(), [&](size_t i)
+    {
+        const SkinInstance& instance = *dirtyInstances[i];
+        const DirectX::XMMATRIX nodeWorld = DirectX::XMLoadFloat4x4(&hierarchy.worlds[instance.node->hierarchyIndex]);
+        const DirectX::XMMATRIX inverseNodeWorld = DirectX::XMMatrixInverse(nullptr, nodeWorld);
+        const GLTFSkin& skin = *instance.skin;
+        for (size_t j = 0; j < skin.joints.size(); ++j)
+        {
+            const DirectX::XMMATRIX jointWorld = DirectX::XMLoadFloat4x4(&hierarchy.worlds[skin.joints[j]->hierarchyIndex]);
+            const DirectX::XMMATRIX inverseBind = DirectX::XMLoadFloat4x4(&skin.inverseBindMatrices[j]);
+            DirectX::XMStoreFloat4x4(&m_JointPalette[instance.firstPaletteMatrix + j], inverseBind * jointWorld * inverseNodeWorld);
+        }
+    });
+
+    // Vertices, in batches so large meshes and many small ones both fill the workers
+    struct SkinningBatch
+    {
+        const DirectX::XMFLOAT4X4* palette;
+        uint32_t firstVertex; // Into m_SkinVertices
+        uint32_t vertexCount;
+    };
+    std::vector<SkinningBatch> batches;
+    for (SkinInstance* instance : dirtyInstances)
+    {
+        instance->dirty = false;
+        for (const auto& prim : instance->node->mesh->primitives)
+        {
+            if (!prim.skinned)
+                continue;
+            m_SkinnedPrimitives.push_back(&prim);
+            m_SkinnedVertexCount += prim.vertexCount;
+            for (uint32_t first = 0; first < prim.vertexCount; first += SkinningBatchSize)
+                batches.push_back({ &m_JointPalette[instance->firstPaletteMatrix], prim.firstSkinVertex + first, std::min(SkinningBatchSize, prim.vertexCount - first) });
+        }
+    }
+
+    GLTFVertex* skinned = static_cast<GLTFVertex*>(m_SkinnedVertexUpload.cpuPtr);
+    JobSystem::Get().ParallelFor(batches.size(), [&](size_t i)
+    {
+        const SkinningBatch& batch = batches[i];
+        SkinVertexRange(m_SkinVertices.data() + batch.firstVertex, batch.vertexCount, batch.palette, skinned + batch.firstVertex);
+    });
+
+    if (m_ValidateSkinning)
+    {
+        for (const SkinningBatch& batch : batches)
+        {
+            m_SkinningError = std::max(m_SkinningError,
+                CompareSkinnedVertices(m_SkinVertices.data() + batch.firstVertex, batch.vertexCount, batch.palette, skinned + batch.firstVertex));
+        }
+    }
+
+    auto skinningEnd = std::chrono::high_resolution_clock::now();
+    m_SkinningMs = std::chrono::duration<float, std::milli>(skinningEnd - skinningStart).count();
+    return true;
+}
+
+void Model::CopySkinnedVertices(ID3D12GraphicsCommandList* cmdList, GPUBuffer& vertexBuffer, uint32_t vertexBase)
+{
+    if (m_SkinnedPrimitives.empty())
+        return;
+
+    vertexBuffer.Transition(cmdList, D3D12_RESOURCE_STATE_COPY_DEST);
+    for (const GLTFPrimitive* prim : m_SkinnedPrimitives)
+    {
+        cmdList->CopyBufferRegion(vertexBuffer.resource.Get(), UINT64(vertexBase + prim->globalVertexOffset) * sizeof(GLTFVertex),
+            m_SkinnedVertexUpload.resource.Get(), UINT64(prim->firstSkinVertex) * sizeof(GLTFVertex), UINT64(prim->vertexCount) * sizeof(GLTFVertex));
+    }
+}
+
+void Model::UpdateSkinning(ID3D12GraphicsCommandList* cmdList)
+{
+    if (!SkinVertices())
+        return;
+    CopySkinnedVertices(cmdList, m_GlobalVertexBuffer, 0);
+    m_GlobalVertexBuffer.Transition(cmdList, D3D12_RESOURCE_STATE_GENERIC_READ);
+}
+
+void Model::UploadTextures(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, ID3D12CommandQueue* cmdQueue, ID3D12CommandAllocator* cmdAllocator, Renderer* renderer)
+{
+    LoadProfiler::Scope scope("UploadTextures");
+
+    // Reset the command list
+    CHECK_HR(cmdList->Reset(cmdAllocator, nullptr), "Reset command list failed");
+
+    srvDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+    CHECK_HR(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)), "Create fence failed");
+    UINT64 fenceValue = 0;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> uploadBuffers;
+    UINT64 stagedBytes = 0;
+
+    // Submit what has been recorded, wait, and recycle the staging buffers
+    auto flushUploads = [&]()
+    {
+        CHECK_HR(cmdList->Close(), "Close command list failed");
+        ID3D12CommandList* commandLists[] = { cmdList };
+        cmdQueue->ExecuteCommandLists(1, commandLists);
+
+        HANDLE eventHandle = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        CHECK_HR(cmdQueue->Signal(fence.Get(), ++fenceValue), "Signal fence failed");
+        CHECK_HR(fence->SetEventOnCompletion(fenceValue, eventHandle), "Set event on completion failed");
+        WaitForSingleObject(eventHandle, INFINITE);
+        CloseHandle(eventHandle);
+
+        uploadBuffers.clear();
+        stagedBytes = 0;
+        CHECK_HR(cmdAllocator->Reset(), "Reset command allocator failed");
+        CHECK_HR(cmdList->Reset(cmdAllocator, nullptr), "Reset command list failed");
+    };
+
+    // Texture pipeline: workers decode images while this thread creates the textures, copies
+    // each decoded image into staging and frees it right away. Each job reads its image's header
+    // first and reports the decoded size; the next decode is only started once that size is known
+    // and the estimated decoded bytes in flight are still under the budget.
+    auto texturesStart = std::chrono::high_resolution_clock::now();
+    const std::string directory(fileDirectory.begin(), fileDirectory.end());
+    const size_t imageCount = m_GltfModel.images.size();
+    m_TexturesUploaded = 0;
+    m_TextureCount = imageCount;
+
+    // Pick each image's compression from the material slots that use it
+    std::vector<uint32_t> usageMasks(imageCount, 0);
+    for (const auto& images : m_MaterialImages)
+    {
+        if (images.baseColor >= 0) usageMasks[images.baseColor] |= 1u << uint32_t(TextureUsage::Color);
+        if (images.normal >= 0) usageMasks[images.normal] |= 1u << uint32_t(TextureUsage::Normal);
+        if (images.metallicRoughness >= 0) usageMasks[images.metallicRoughness] |= 1u << uint32_t(TextureUsage::MetallicRoughness);
+    }
+    for (size_t i = 0; i < imageCount; ++i)
+    {
+        // Images shared between different slots keep every channel
+        GLTFImage& image = m_GltfModel.images[i];
+        image.usage = TextureUsage::Color;
+        if (usageMasks[i] == 1u << uint32_t(TextureUsage::Normal))
+            image.usage = TextureUsage::Normal;
+        else if (usageMasks[i] == 1u << uint32_t(TextureUsage::MetallicRoughness))
+            image.usage = TextureUsage::MetallicRoughness;
+    }
+
+    std::unique_ptr<TextureCooker> cooker;
+    if (m_CookTextures)
+        cooker = std::make_unique<TextureCooker>(directory + "TextureCache");
+
+    // Streaming reads mips straight out of the cooked DDS files
+    const bool streamTextures = cooker && m_StreamTextures;
+    m_TextureStreamer.Initialize(renderer);
+
+    struct DecodedImage
+    {
+        size_t index;
+        bool succeeded;
+        DirectX::ScratchImage image;
+        // Set when `image` is only the mip tail of this cooked file
+        std::string streamPath;
+        DirectX::TexMetadata fullMetadata;
+        uint32_t tailMip = 0;
+    };
+
+    // Shared with the jobs, so one still notifying after the last image was taken never touches
+    // a dead stack frame
+    struct DecodePipeline
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<std::pair<size_t, size_t>> sizes; // Image and estimated decoded bytes, reported before decoding
+        std::deque<DecodedImage> decoded;
+    };
+    auto pipeline = std::make_shared<DecodePipeline>();
+
+    std::vector<size_t> estimatedBytes(imageCount, 0);
+    size_t nextImage = 0;
+    size_t completedImages = 0;
+    size_t bytesInFlight = 0;
+    size_t peakBytesInFlight = 0;
+    bool sizePending = false;
+    while (completedImages < imageCount)
+    {
+        // Always allow one decode so an image larger than the budget still loads
+        if (!sizePending && nextImage < imageCount && (bytesInFlight == 0 || bytesInFlight < m_TextureDecodeBudget))
+        {
+            sizePending = true;
+            const size_t index = nextImage++;
+            JobSystem::Get().Submit([&, pipeline, index]()
+            {
+                const GLTFImage& image = m_GltfModel.images[index];
+                const size_t size = EstimateDecodedSize(image, directory);
+                {
+                    std::lock_guard<std::mutex> lock(pipeline->mutex);
+                    pipeline->sizes.emplace_back(index, size);
+                    pipeline->condition.notify_one();
+                }
+
+                DecodedImage result;
+                result.index = index;
+                result.succeeded = streamTextures &&
+                    DecodeImageTail(image, directory, *cooker, result.streamPath, result.fullMetadata, result.image, result.tailMip);
+                if (!result.succeeded)
+                {
+                    // Fall back to uploading every mip
+                    result.streamPath.clear();
+                    result.succeeded = DecodeImage(image, directory, cooker.get(), result.image);
+                }
+
+                std::lock_guard<std::mutex> lock(pipeline->mutex);
+                pipeline->decoded.push_back(std::move(result));
+                pipeline->condition.notify_one();
+            });
+        }
+
+        DecodedImage item;
+        bool haveItem = false;
+        {
+            std::unique_lock<std::mutex> lock(pipeline->mutex);
+            pipeline->condition.wait(lock, [&]() { return !pipeline->sizes.empty() || !pipeline->decoded.empty(); });
+            for (const auto& size : pipeline->sizes)
+            {
+                estimatedBytes[size.first] = size.second;
+                bytesInFlight += size.second;
+                peakBytesInFlight = std::max(peakBytesInFlight, bytesInFlight);
+                sizePending = false;
+            }
+            pipeline->sizes.clear();
+            if (!pipeline->decoded.empty())
+            {
+                item = std::move(pipeline->decoded.front());
+                pipeline->decoded.pop_front();
+                haveItem = true;
+            }
+        }
+        if (!haveItem)
+            continue;
+
+        GLTFImage& gltfImg = m_GltfModel.images[item.index];
+        if (item.succeeded)
+        {
+            const DirectX::TexMetadata& metaData = item.image.GetMetadata();
+            if (renderer->CreateTexture(gltfImg.texture,
+                UINT(metaData.width),
+                UINT(metaData.height),
+                metaData.format,
+                D3D12_RESOURCE_FLAG_NONE,
+                D3D12_RESOURCE_STATE_COMMON,
+                nullptr, // clearColor
+                UINT(metaData.mipLevels)))
+            {
+                gltfImg.packedMetallicRoughness = gltfImg.usage == TextureUsage::MetallicRoughness && TextureCooker::IsPackedMetallicRoughness(metaData.format);
+
+                Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer;
+                const UINT64 textureBytes = StageTexture(device, cmdList, gltfImg.texture.resource.Get(), item.image, uploadBuffer);
+                stagedBytes += textureBytes;
+                scope.AddBytes(textureBytes);
+                uploadBuffers.push_back(uploadBuffer);
+
+                if (!item.streamPath.empty())
+                {
+                    const uint32_t streamHandle = m_TextureStreamer.Add(item.streamPath, item.fullMetadata, item.tailMip, std::move(gltfImg.texture));
+                    if (streamHandle != TextureStreamer::InvalidHandle)
+                        gltfImg.streamHandle = static_cast<int>(streamHandle);
+                }
+            }
+            else
+            {
+                std::cerr << "Failed to create texture resource for image: " << item.index << std::endl;
+            }
+        }
+
+        // The decoded pixels are in staging now
+        item.image.Release();
+        bytesInFlight -= estimatedBytes[item.index];
+        ++completedImages;
+        ++m_TexturesUploaded;
+
+        // Bound the staging memory by the same budget
+        if (stagedBytes > m_TextureDecodeBudget)
+            flushUploads();
+    }
+
+    auto texturesEnd = std::chrono::high_resolution_clock::now();
+    std::cout << "Decoded and staged " << imageCount << " images in "
+        << std::chrono::duration<double, std::milli>(texturesEnd - texturesStart).count() << " ms (peak "
+        << peakBytesInFlight / (1024 * 1024) << " MB decoding, budget " << m_TextureDecodeBudget / (1024 * 1024) << " MB)" << std::endl;
+
+    // Materials can only reference textures once their SRVs exist
+    ResolveMaterialTextures();
+
+    // Streaming switches material texture indices later on
+    if (m_TextureStreamer.GetStats().textureCount > 0 && !m_MaterialConstants.empty())
+        renderer->CreateBuffer(m_MaterialUploadBuffer, m_MaterialConstants.size() * sizeof(MaterialConstants), D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
+
+    // Execute the remaining texture upload commands (which were recorded into cmdList)
+    CHECK_HR(cmdList->Close(), "Close command list failed");
+    ID3D12CommandList* commandLists[] = { cmdList };
+    cmdQueue->ExecuteCommandLists(1, commandLists);
+
+    // Wait for completion (for textures)
+    HANDLE eventHandle = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    CHECK_HR(cmdQueue->Signal(fence.Get(), ++fenceValue), "Signal fence failed");
+    CHECK_HR(fence->SetEventOnCompletion(fenceValue, eventHandle), "Set event on completion failed");
+    WaitForSingleObject(eventHandle, INFINITE);
+    CloseHandle(eventHandle);
+
+    // The command list is left closed
+
+    // Materials were uploaded untextured with the geometry; point them at the textures only
+    // now that those are resident, since frames may already be drawing the model
+    if (m_MaterialBuffer.resource)
+    {
+        ResourceUploadBatch batch(renderer);
+        batch.Begin();
+        batch.Upload(m_MaterialBuffer, m_MaterialConstants.data(), m_MaterialConstants.size() * sizeof(MaterialConstants));
+        batch.Transition(m_MaterialBuffer, D3D12_RESOURCE_STATE_GENERIC_READ);
+        batch.End();
     }
+
+    const size_t residentBefore = GetMemoryStats().GetTotal();
+    ReleaseCPUData();
+    const size_t residentAfter = GetMemoryStats().GetTotal();
+    std::cout << "Model CPU memory after upload: " << residentAfter / 1024 << " KB (released " << (residentBefore - residentAfter) / 1024 << " KB)" << std::endl;
 }
 
-void Model::UpdateAnimation(float deltaTime)
+void Model::UploadGeometry(Renderer* renderer)
 {
-    if (!m_CurrentAnimation)
+    LoadProfiler::Scope scope("UploadGeometry");
+    if (!StageGeometry(renderer))
         return;
 
-    m_AnimationTime += deltaTime;
+    // Use ResourceUploadBatch for buffers
+    ResourceUploadBatch batch(renderer);
+    batch.Begin();
 
-    // For simplicity, loop the animation
-    float animDuration = 0.0f;
-    for (auto& channel : m_CurrentAnimation->channels)
+    if (m_MaterialBuffer.resource)
     {
-        if (!channel.times.empty())
-            animDuration = std::max(animDuration, channel.times.back());
+        batch.Upload(m_MaterialBuffer, m_MaterialConstants.data(), m_MaterialConstants.size() * sizeof(MaterialConstants));
+        batch.Transition(m_MaterialBuffer, D3D12_RESOURCE_STATE_GENERIC_READ);
     }
-    if (animDuration > 0.0f)
-        m_AnimationTime = fmod(m_AnimationTime, animDuration);
 
-    // Update each channel
-    for (auto& channel : m_CurrentAnimation->channels)
-    {
-        if (channel.times.empty())
-            continue;
-
-        // Find the two keyframes
-        size_t key0 = 0, key1 = 0;
-        for (size_t i = 0; i < channel.times.size() - 1; ++i)
-        {
-            if (m_AnimationTime >= channel.times[i] && m_AnimationTime <= channel.times[i + 1])
-            {
-                key0 = i;
-                key1 = i + 1;
-                break;
-            }
-        }
+    GPUBuffer* const indexBuffers[IndexPool_Count] = { &m_GlobalIndexBuffer, &m_GlobalIndex16Buffer };
+    CopyGeometry(batch, m_GlobalVertexBuffer, indexBuffers, ModelPlacement());
+    batch.End();
+    ReleaseGeometryUpload();
+}
 
-        float t0 = channel.times[key0];
-        float t1 = channel.times[key1];
-        float factor = (m_AnimationTime - t0) / (t1 - t0);
-        factor = std::clamp(factor, 0.0f, 1.0f);
+bool Model::StageGeometry(Renderer* renderer)
+{
+    LoadProfiler::Scope scope("StageGeometry");
 
-        if (channel.type == GLTFAnimationChannel::Translation)
-        {
-            DirectX::XMFLOAT3 v0 = channel.translations[key0];
-            DirectX::XMFLOAT3 v1 = channel.translations[key1];
-            channel.targetNode->translation.x = v0.x + (v1.x - v0.x) * factor;
-            channel.targetNode->translation.y = v0.y + (v1.y - v0.y) * factor;
-            channel.targetNode->translation.z = v0.z + (v1.z - v0.z) * factor;
-        }
-        else if (channel.type == GLTFAnimationChannel::Rotation)
-        {
-            DirectX::XMFLOAT4 q0 = channel.rotations[key0];
-            DirectX::XMFLOAT4 q1 = channel.rotations[key1];
-            // Simple linear interpolation for testing
-            channel.targetNode->rotation.x = q0.x + (q1.x - q0.x) * factor;
-            channel.targetNode->rotation.y = q0.y + (q1.y - q0.y) * factor;
-            channel.targetNode->rotation.z = q0.z + (q1.z - q0.z) * factor;
-            channel.targetNode->rotation.w = q0.w + (q1.w - q0.w) * factor;
-        }
-        else if (channel.type == GLTFAnimationChannel::Scale)
-        {
-            DirectX::XMFLOAT3 v0 = channel.scales[key0];
-            DirectX::XMFLOAT3 v1 = channel.scales[key1];
-            channel.targetNode->scale.x = v0.x + (v1.x - v0.x) * factor;
-            channel.targetNode->scale.y = v0.y + (v1.y - v0.y) * factor;
-            channel.targetNode->scale.z = v0.z + (v1.z - v0.z) * factor;
-        }
+    std::vector<CompactVertex> compactVertices;
+    const void* vertexData = m_VertexData;
+    UINT64 vertexBytes = UINT64(m_VertexCount) * sizeof(GLTFVertex);
+    if (m_VertexCount > 0 && m_VertexFormat == VertexFormat::Compact)
+    {
+        EncodeCompactVertices(compactVertices);
+        vertexData = compactVertices.data();
+        vertexBytes = compactVertices.size() * sizeof(CompactVertex);
+    }
 
-        // Recompute matrix
-        DirectX::XMMATRIX t = DirectX::XMMatrixTranslation(channel.targetNode->translation.x, channel.targetNode->translation.y, channel.targetNode->translation.z);
-        DirectX::XMMATRIX r = DirectX::XMMatrixRotationQuaternion(DirectX::XMVectorSet(channel.targetNode->rotation.x, channel.targetNode->rotation.y, channel.targetNode->rotation.z, channel.targetNode->rotation.w));
-        DirectX::XMMATRIX s = DirectX::XMMatrixScaling(channel.targetNode->scale.x, channel.targetNode->scale.y, channel.targetNode->scale.z);
-        DirectX::XMMATRIX m = s * r * t;
-        DirectX::XMStoreFloat4x4(&channel.targetNode->transform, m);
+    const void* data[1 + IndexPool_Count] = { vertexData, m_IndexData, m_Index16Data };
+    UINT64 totalBytes = 0;
+    for (uint32_t i = 0; i < 1 + IndexPool_Count; ++i)
+    {
+        m_GeometryUploadSizes[i] = i == 0 ? vertexBytes : UINT64(GetIndexCount(IndexPool(i - 1))) * GetIndexSize(IndexPool(i - 1));
+        m_GeometryUploadOffsets[i] = totalBytes;
+        totalBytes += m_GeometryUploadSizes[i];
     }
+    if (totalBytes == 0)
+        return true;
 
-    // Recompute world AABBs and update GPU node buffer after all local transforms are updated
-    for (auto* rootNode : m_GltfModel.rootNodes)
+    if (!renderer->CreateBuffer(m_GeometryUpload, totalBytes, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ))
+    {
+        std::cerr << "Failed to create geometry upload buffer" << std::endl;
+        return false;
+    }
+    for (uint32_t i = 0; i < 1 + IndexPool_Count; ++i)
     {
-        ComputeWorldAABBs(rootNode, DirectX::XMMatrixIdentity());
+        if (m_GeometryUploadSizes[i] > 0)
+            memcpy(static_cast<uint8_t*>(m_GeometryUpload.cpuPtr) + m_GeometryUploadOffsets[i], data[i], m_GeometryUploadSizes[i]);
     }
-    
-    UpdateNodeBuffer();
+    scope.AddBytes(totalBytes);
+    return true;
 }
 
-void Model::UploadTextures(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, ID3D12CommandQueue* cmdQueue, ID3D12CommandAllocator* cmdAllocator, Renderer* renderer)
+void Model::CopyGeometry(ResourceUploadBatch& batch, GPUBuffer& vertexBuffer, GPUBuffer* const (&indexBuffers)[IndexPool_Count], const ModelPlacement& placement)
 {
-    // Reset the command list
-    CHECK_HR(cmdList->Reset(cmdAllocator, nullptr), "Reset command list failed");
-
-    srvDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    if (!m_GeometryUpload.resource)
+        return;
 
-    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> uploadBuffers;
+    if (vertexBuffer.resource && m_GeometryUploadSizes[0] > 0)
+    {
+        batch.Copy(vertexBuffer, m_GeometryUpload, m_GeometryUploadSizes[0], UINT64(placement.vertexBase) * GetVertexStride(), m_GeometryUploadOffsets[0]);
+        batch.Transition(vertexBuffer, D3D12_RESOURCE_STATE_GENERIC_READ);
+    }
 
-    for (size_t i = 0; i < m_GltfModel.images.size(); ++i)
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
     {
-        auto& gltfImg = m_GltfModel.images[i];
-        if (!gltfImg.image || !gltfImg.texture.resource)
+        if (!indexBuffers[pool]->resource || m_GeometryUploadSizes[1 + pool] == 0)
             continue;
 
-        const DirectX::TexMetadata& metaData = gltfImg.image->GetMetadata();
+        batch.Copy(*indexBuffers[pool], m_GeometryUpload, m_GeometryUploadSizes[1 + pool], UINT64(placement.indexBase[pool]) * GetIndexSize(IndexPool(pool)), m_GeometryUploadOffsets[1 + pool]);
+        batch.Transition(*indexBuffers[pool], D3D12_RESOURCE_STATE_INDEX_BUFFER);
+    }
+}
 
-        // Transition texture to COPY_DEST
-        D3D12_RESOURCE_BARRIER barrier = {};
-        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        barrier.Transition.pResource = gltfImg.texture.resource.Get();
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
-        cmdList->ResourceBarrier(1, &barrier);
+void Model::EncodeCompactVertices(std::vector<CompactVertex>& result) const
+{
+    auto start = std::chrono::high_resolution_clock::now();
 
-        const UINT numSubResources = UINT(metaData.mipLevels * metaData.arraySize);
-        D3D12_PLACED_SUBRESOURCE_FOOTPRINT* layouts = (D3D12_PLACED_SUBRESOURCE_FOOTPRINT*)_alloca(sizeof(D3D12_PLACED_SUBRESOURCE_FOOTPRINT) * numSubResources);
-        UINT* numRows = (UINT*)_alloca(sizeof(UINT) * numSubResources);
-        UINT64* rowSizes = (UINT64*)_alloca(sizeof(UINT64) * numSubResources);
+    // Each primitive quantizes its own slice against its AABB (the same offset/scale its DrawNodeData carries)
+    std::vector<const GLTFPrimitive*> primitives;
+    GetAllPrimitives(primitives);
 
-        UINT64 textureMemSize = 0;
-        D3D12_RESOURCE_DESC textureDesc = gltfImg.texture.resource->GetDesc();
-        device->GetCopyableFootprints(&textureDesc, 0, numSubResources, 0, layouts, numRows, rowSizes, &textureMemSize);
+    result.assign(m_VertexCount, CompactVertex());
+    std::vector<VertexErrorStats> primitiveStats(primitives.size());
+    JobSystem::Get().ParallelFor(primitives.size(), [&](size_t i)
+    {
+        const GLTFPrimitive* prim = primitives[i];
+        ::EncodeCompactVertices(m_VertexData + prim->globalVertexOffset, prim->vertexCount, GetPositionQuantization(prim->aabb),
+            result.data() + prim->globalVertexOffset, primitiveStats[i]);
+    });
+
+    VertexErrorStats stats;
+    for (const auto& primitiveStat : primitiveStats)
+        stats.Merge(primitiveStat);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Encoded " << m_VertexCount << " compact vertices in " << std::chrono::duration<double, std::milli>(end - start).count()
+        << " ms (max error: position " << stats.position << ", normal " << stats.normalAngle << " rad, uv " << stats.texCoord << ")" << std::endl;
+    if (stats.violations > 0)
+        std::cerr << stats.violations << " compact vertices exceed the round-trip error bounds" << std::endl;
+}
 
-        // Create upload buffer
-        D3D12_HEAP_PROPERTIES uploadHeapProps = {};
-        uploadHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
-        D3D12_RESOURCE_DESC uploadDesc = {};
-        uploadDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-        uploadDesc.Width = textureMemSize;
-        uploadDesc.Height = 1;
-        uploadDesc.DepthOrArraySize = 1;
-        uploadDesc.MipLevels = 1;
-        uploadDesc.Format = DXGI_FORMAT_UNKNOWN;
-        uploadDesc.SampleDesc.Count = 1;
-        uploadDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+void Model::ReleaseDescriptors(Renderer* renderer)
+{
+    m_TextureStreamer.ReleaseDescriptors();
+    // Streamed images' moved-from textures still carry the index the streamer just released
+    for (GLTFImage& image : m_GltfModel.images)
+    {
+        if (image.streamHandle < 0)
+            renderer->FreeDescriptor(image.texture.srvIndex);
+        image.texture.srvIndex = Renderer::InvalidDescriptor;
+    }
+}
 
-        Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer;
-        CHECK_HR(device->CreateCommittedResource(&uploadHeapProps, D3D12_HEAP_FLAG_NONE, &uploadDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&uploadBuffer)), "Create upload buffer failed");
+bool Model::UpdateTextureStreaming(ID3D12GraphicsCommandList* cmdList, const DirectX::BoundingFrustum& frustum, const DirectX::XMFLOAT3& cameraPosition, float fovY, float viewportHeight)
+{
+    if (!m_MaterialUploadBuffer.resource)
+        return false;
 
-        uploadBuffers.push_back(uploadBuffer);
+    // Projected size of each visible node decides the mips its materials want
+    const float pixelsPerUnit = viewportHeight / (2.0f * std::tan(fovY * 0.5f)); // At distance 1
+    const DirectX::XMVECTOR eye = DirectX::XMLoadFloat3(&cameraPosition);
+    for (const auto& node : m_GltfModel.nodes)
+    {
+        if (!node.mesh || !frustum.Intersects(GetWorldAabb(node)))
+            continue;
 
-        // Copy data to upload buffer
-        uint8_t* uploadMem;
-        uploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&uploadMem));
+        const DirectX::BoundingBox& worldAabb = GetWorldAabb(node);
+        const DirectX::XMVECTOR center = DirectX::XMLoadFloat3(&worldAabb.Center);
+        const float radius = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMLoadFloat3(&worldAabb.Extents)));
+        const float distance = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(center, eye)));
+        const float projectedSize = 2.0f * radius * pixelsPerUnit / std::max(distance - radius, 0.01f);
 
-        for (UINT arrayIdx = 0; arrayIdx < UINT(metaData.arraySize); ++arrayIdx)
+        for (const auto& prim : node.mesh->primitives)
         {
-            for (UINT mipIdx = 0; mipIdx < UINT(metaData.mipLevels); ++mipIdx)
+            if (prim.materialIndex >= m_MaterialImages.size())
+                continue;
+            const MaterialImageRefs& images = m_MaterialImages[prim.materialIndex];
+            for (int imageIndex : { images.baseColor, images.normal, images.metallicRoughness })
             {
-                const UINT subResourceIdx = mipIdx + (arrayIdx * UINT(metaData.mipLevels));
-                const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& subResourceLayout = layouts[subResourceIdx];
-                uint8_t* dstSubResourceMem = uploadMem + subResourceLayout.Offset;
-                const DirectX::Image* subImage = gltfImg.image->GetImage(mipIdx, arrayIdx, 0);
-                for (UINT z = 0; z < subResourceLayout.Footprint.Depth; ++z)
-                {
-                    uint8_t* dst = dstSubResourceMem;
-                    const uint8_t* src = subImage->pixels;
-                    for (UINT y = 0; y < numRows[subResourceIdx]; ++y)
-                    {
-                        memcpy(dst, src, rowSizes[subResourceIdx]);
-                        dst += subResourceLayout.Footprint.RowPitch;
-                        src += subImage->rowPitch;
-                    }
-                }
+                if (imageIndex >= 0 && m_GltfModel.images[imageIndex].streamHandle >= 0)
+                    m_TextureStreamer.Request(m_GltfModel.images[imageIndex].streamHandle, projectedSize);
             }
         }
-        uploadBuffer->Unmap(0, nullptr);
+    }
 
-        // Copy to texture
-        for (UINT subResourceIdx = 0; subResourceIdx < numSubResources; ++subResourceIdx)
-        {
-            D3D12_TEXTURE_COPY_LOCATION dst = {};
-            dst.pResource = gltfImg.texture.resource.Get();
-            dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-            dst.SubresourceIndex = subResourceIdx;
-            D3D12_TEXTURE_COPY_LOCATION src = {};
-            src.pResource = uploadBuffer.Get();
-            src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-            src.PlacedFootprint = layouts[subResourceIdx];
-            cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
-        }
+    if (!m_TextureStreamer.Update(cmdList))
+        return false;
 
-        // Transition to PIXEL_SHADER_RESOURCE
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-        cmdList->ResourceBarrier(1, &barrier);
+    // Point materials at the new SRVs. The GPU is idle between frames, so the upload buffer is free to rewrite.
+    ResolveMaterialTextures();
+    if (!m_MaterialBuffer.resource)
+        return true;
 
-        // Clean up
-        delete gltfImg.image;
-        gltfImg.image = nullptr;
-    }
+    const UINT64 size = m_MaterialConstants.size() * sizeof(MaterialConstants);
+    memcpy(m_MaterialUploadBuffer.cpuPtr, m_MaterialConstants.data(), static_cast<size_t>(size));
+    m_MaterialBuffer.Transition(cmdList, D3D12_RESOURCE_STATE_COPY_DEST);
+    cmdList->CopyBufferRegion(m_MaterialBuffer.resource.Get(), 0, m_MaterialUploadBuffer.resource.Get(), 0, size);
+    m_MaterialBuffer.Transition(cmdList, D3D12_RESOURCE_STATE_GENERIC_READ);
+    return true;
+}
 
-    // Use ResourceUploadBatch for buffers
-    ResourceUploadBatch batch(renderer);
-    batch.Begin();
+void Model::ReleaseCPUData()
+{
+    if (m_ResidencyPolicy == ResidencyPolicy::KeepAll)
+        return;
 
-    if (m_MaterialBuffer.resource)
+    // Embedded image bytes live in the glTF buffers or the cache mapping
+    for (auto& image : m_GltfModel.images)
     {
-        batch.Upload(m_MaterialBuffer, m_MaterialConstants.data(), m_MaterialConstants.size() * sizeof(MaterialConstants));
-        batch.Transition(m_MaterialBuffer, D3D12_RESOURCE_STATE_GENERIC_READ);
+        image.embeddedData = nullptr;
+        image.embeddedSize = 0;
     }
 
-    if (m_OpaqueCommandBuffer.resource)
+    if (m_GltfModel.data)
     {
-        batch.Upload(m_OpaqueCommandBuffer, m_OpaqueCommands.data(), m_OpaqueCommands.size() * sizeof(IndirectDrawCommand));
-        batch.Transition(m_OpaqueCommandBuffer, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+        cgltf_free(m_GltfModel.data);
+        m_GltfModel.data = nullptr;
     }
 
-    if (m_TransparentCommandBuffer.resource)
+    if (m_ResidencyPolicy == ResidencyPolicy::ReleaseAfterUpload)
     {
-        batch.Upload(m_TransparentCommandBuffer, m_TransparentCommands.data(), m_TransparentCommands.size() * sizeof(IndirectDrawCommand));
-        batch.Transition(m_TransparentCommandBuffer, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+        // Counts stay valid; they describe the GPU buffers
+        std::vector<GLTFVertex>().swap(m_GlobalVertices);
+        std::vector<uint32_t>().swap(m_GlobalIndices);
+        std::vector<uint16_t>().swap(m_GlobalIndices16);
+        m_VertexData = nullptr;
+        m_IndexData = nullptr;
+        m_Index16Data = nullptr;
+        m_SceneCache.Close();
     }
+}
 
-    if (m_GlobalVertexBuffer.resource)
+ModelMemoryStats Model::GetMemoryStats() const
+{
+    ModelMemoryStats stats;
+
+    stats.geometryBytes = m_GlobalVertices.capacity() * sizeof(GLTFVertex) + m_GlobalIndices.capacity() * sizeof(uint32_t) +
+        m_GlobalIndices16.capacity() * sizeof(uint16_t) + m_Meshlets.capacity() * sizeof(Meshlet) + m_SkinVertices.capacity() * sizeof(SkinVertex);
+    stats.sceneCacheBytes = m_SceneCache.IsOpen() ? static_cast<size_t>(m_SceneCache.GetFileSize()) : 0;
+
+    if (m_GltfModel.data)
     {
-        batch.Upload(m_GlobalVertexBuffer, m_GlobalVertices.data(), m_GlobalVertices.size() * sizeof(GLTFVertex));
-        batch.Transition(m_GlobalVertexBuffer, D3D12_RESOURCE_STATE_GENERIC_READ);
+        stats.gltfSourceBytes = m_GltfModel.data->json_size;
+        for (size_t i = 0; i < m_GltfModel.data->buffers_count; ++i)
+            stats.gltfSourceBytes += m_GltfModel.data->buffers[i].size;
     }
 
-    if (m_GlobalIndexBuffer.resource)
+    for (const auto& mesh : m_GltfModel.meshes)
+        stats.sceneBytes += mesh.primitives.capacity() * sizeof(GLTFPrimitive);
+    for (const auto& node : m_GltfModel.nodes)
+        stats.sceneBytes += sizeof(GLTFNode) + node.children.capacity() * sizeof(GLTFNode*);
+    const NodeHierarchy& hierarchy = m_GltfModel.hierarchy;
+    stats.sceneBytes += hierarchy.nodes.capacity() * (sizeof(GLTFNode*) + sizeof(int32_t) + sizeof(uint32_t) + 2 * sizeof(DirectX::XMFLOAT4X4) +
+        2 * sizeof(DirectX::BoundingBox) + 2 * sizeof(uint8_t));
+    stats.sceneBytes += m_DrawNodeData.capacity() * sizeof(DrawNodeData);
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
+        stats.sceneBytes += (m_OpaqueCommands[pool].capacity() + m_TransparentCommands[pool].capacity()) * sizeof(IndirectDrawCommand);
+    stats.sceneBytes += m_MaterialConstants.capacity() * sizeof(MaterialConstants) + m_MaterialImages.capacity() * sizeof(MaterialImageRefs);
+
+    for (const auto& animation : m_GltfModel.animations)
     {
-        batch.Upload(m_GlobalIndexBuffer, m_GlobalIndices.data(), m_GlobalIndices.size() * sizeof(uint32_t));
-        batch.Transition(m_GlobalIndexBuffer, D3D12_RESOURCE_STATE_INDEX_BUFFER);
+        for (const auto& channel : animation.channels)
+        {
+            stats.animationBytes += channel.times.capacity() * sizeof(float);
+            stats.animationBytes += channel.translations.capacity() * sizeof(DirectX::XMFLOAT3);
+            stats.animationBytes += channel.rotations.capacity() * sizeof(DirectX::XMFLOAT4);
+            stats.animationBytes += channel.scales.capacity() * sizeof(DirectX::XMFLOAT3);
+            stats.animationBytes += channel.compressedKeys.values.capacity() * sizeof(uint16_t);
+        }
     }
+    for (const auto& skin : m_GltfModel.skins)
+        stats.animationBytes += skin.joints.capacity() * sizeof(GLTFNode*) + skin.inverseBindMatrices.capacity() * sizeof(DirectX::XMFLOAT4X4);
+    stats.animationBytes += m_SkinInstances.capacity() * sizeof(SkinInstance) + m_JointPalette.capacity() * sizeof(DirectX::XMFLOAT4X4);
 
-    batch.End();
-
-    // Execute the texture upload commands (which were recorded into cmdList)
-    CHECK_HR(cmdList->Close(), "Close command list failed");
-    ID3D12CommandList* commandLists[] = { cmdList };
-    cmdQueue->ExecuteCommandLists(1, commandLists);
-
-    // Wait for completion (for textures)
-    Microsoft::WRL::ComPtr<ID3D12Fence> fence;
-    CHECK_HR(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)), "Create fence failed");
-    HANDLE eventHandle = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    CHECK_HR(fence->SetEventOnCompletion(1, eventHandle), "Set event on completion failed");
-    cmdQueue->Signal(fence.Get(), 1);
-    WaitForSingleObject(eventHandle, INFINITE);
-    CloseHandle(eventHandle);
-
-    // The command list remains closed; BeginFrame will reset it
+    return stats;
 }
 
 void Model::Render(ID3D12GraphicsCommandList* commandList, Renderer* renderer, const DirectX::BoundingFrustum& frustum, AlphaMode mode)
@@ -1011,36 +2665,36 @@ void Model::Render(ID3D12GraphicsCommandList* commandList, Renderer* renderer, c
         commandList->SetGraphicsRootShaderResourceView(7, m_GlobalVertexBuffer.gpuAddress);
     }
 
-    // Bind global index buffer to IA
-    if (m_GlobalIndexBuffer.resource)
-    {
-        D3D12_INDEX_BUFFER_VIEW ibv = {};
-        ibv.BufferLocation = m_GlobalIndexBuffer.gpuAddress;
-        ibv.SizeInBytes = static_cast<UINT>(m_GlobalIndexBuffer.size);
-        ibv.Format = DXGI_FORMAT_R32_UINT;
-        commandList->IASetIndexBuffer(&ibv);
-    }
-
     // Unbind IA vertex buffers (using vertex pulling)
     commandList->IASetVertexBuffers(0, 0, nullptr);
 
-    // Execute indirect draw
-    ID3D12Resource* cmdBuffer = nullptr;
-    UINT cmdCount = 0;
-
-    if (mode == AlphaMode::Opaque || mode == AlphaMode::Mask)
-    {
-        cmdBuffer = m_OpaqueCommandBuffer.resource.Get();
-        cmdCount = static_cast<UINT>(m_OpaqueCommands.size());
-    }
-    else
+    // Execute indirect draws, one batch per index pool with its index buffer bound to IA
+    const GPUBuffer* indexBuffers[IndexPool_Count] = { &m_GlobalIndexBuffer, &m_GlobalIndex16Buffer };
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
     {
-        cmdBuffer = m_TransparentCommandBuffer.resource.Get();
-        cmdCount = static_cast<UINT>(m_TransparentCommands.size());
-    }
+        ID3D12Resource* cmdBuffer = nullptr;
+        UINT cmdCount = 0;
+
+        if (mode == AlphaMode::Opaque || mode == AlphaMode::Mask)
+        {
+            cmdBuffer = m_OpaqueCommandBuffers[pool].resource.Get();
+            cmdCount = static_cast<UINT>(m_OpaqueCommands[pool].size());
+        }
+        else
+        {
+            cmdBuffer = m_TransparentCommandBuffers[pool].resource.Get();
+            cmdCount = static_cast<UINT>(m_TransparentCommands[pool].size());
+        }
+
+        if (!cmdBuffer || cmdCount == 0 || !indexBuffers[pool]->resource)
+            continue;
+
+        D3D12_INDEX_BUFFER_VIEW ibv = {};
+        ibv.BufferLocation = indexBuffers[pool]->gpuAddress;
+        ibv.SizeInBytes = static_cast<UINT>(indexBuffers[pool]->size);
+        ibv.Format = GetIndexFormat(IndexPool(pool));
+        commandList->IASetIndexBuffer(&ibv);
 
-    if (cmdBuffer && cmdCount > 0)
-    {
         commandList->ExecuteIndirect(
             renderer->GetCommandSignature(),
             cmdCount,
@@ -1051,38 +2705,231 @@ void Model::Render(ID3D12GraphicsCommandList* commandList, Renderer* renderer, c
     }
 }
 
-// RenderNode recursively (Keep it for debugging or future culling, but not used by ExecuteIndirect right now)
-void Model::RenderNode(ID3D12GraphicsCommandList* commandList, GLTFNode* node, DirectX::XMMATRIX parentTransform, Renderer* renderer, const DirectX::BoundingFrustum& frustum, AlphaMode mode)
+void Model::GetFullDetailCommands(IndexPool pool, std::vector<IndirectDrawCommand>& commands) const
 {
-    // Frustum culling
-    if (node->worldAabb.Intersects(frustum) == false)
+    commands = m_OpaqueCommands[pool];
+    if (m_DrawNodePrimitives.size() != m_DrawNodeData.size())
+        return; // UpdateLods leaves the commands at LOD0 then
+
+    for (auto& cmd : commands)
     {
+        const GLTFPrimitive& prim = *m_DrawNodePrimitives[cmd.drawArgs.StartInstanceLocation];
+        cmd.drawArgs.StartIndexLocation = prim.lods[0].globalIndexOffset;
+        cmd.drawArgs.IndexCountPerInstance = prim.lods[0].indexCount;
+    }
+}
+
+void Model::UpdateLods(const DirectX::XMFLOAT3& cameraPosition, float fovY, float viewportHeight)
+{
+    std::fill(std::begin(m_LodDrawCounts), std::end(m_LodDrawCounts), 0);
+    if (m_DrawNodePrimitives.size() != m_DrawNodeData.size())
         return;
+
+    const float pixelsPerUnit = viewportHeight / (2.0f * std::tan(fovY * 0.5f)); // At distance 1
+    const DirectX::XMVECTOR eye = DirectX::XMLoadFloat3(&cameraPosition);
+
+    auto selectLod = [&](uint32_t drawNodeIndex) -> uint32_t
+    {
+        const GLTFPrimitive& prim = *m_DrawNodePrimitives[drawNodeIndex];
+        if (prim.lodCount == 1)
+            return 0;
+
+        // Errors are local; the largest axis scale bounds how far the world transform stretches them
+        const DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&m_DrawNodeData[drawNodeIndex].world);
+        const float scale = std::max({ DirectX::XMVectorGetX(DirectX::XMVector3Length(world.r[0])),
+            DirectX::XMVectorGetX(DirectX::XMVector3Length(world.r[1])), DirectX::XMVectorGetX(DirectX::XMVector3Length(world.r[2])) });
+
+        DirectX::BoundingSphere sphere;
+        DirectX::BoundingSphere::CreateFromBoundingBox(sphere, prim.aabb);
+        sphere.Transform(sphere, world);
+        const float centerDistance = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&sphere.Center), eye)));
+        const float distance = std::max(centerDistance - sphere.Radius, 1e-3f);
+        const float pixelsPerError = scale * pixelsPerUnit / distance;
+
+        for (uint32_t lod = prim.lodCount - 1; lod > 0; --lod)
+        {
+            if (prim.lods[lod].error * pixelsPerError <= m_LodErrorThreshold)
+                return lod;
+        }
+        return 0;
+    };
+
+    auto retarget = [&](std::vector<IndirectDrawCommand>& commands, GPUBuffer& buffer)
+    {
+        for (auto& cmd : commands)
+        {
+            // Instances share the draw, so it takes the finest level any of them needs
+            const GLTFPrimitive& prim = *m_DrawNodePrimitives[cmd.drawArgs.StartInstanceLocation];
+            uint32_t level = prim.lodCount - 1;
+            for (uint32_t instance = 0; instance < cmd.drawArgs.InstanceCount && level > 0; ++instance)
+                level = std::min(level, selectLod(cmd.drawArgs.StartInstanceLocation + instance));
+
+            cmd.drawArgs.StartIndexLocation = prim.lods[level].globalIndexOffset;
+            cmd.drawArgs.IndexCountPerInstance = prim.lods[level].indexCount;
+            ++m_LodDrawCounts[level];
+        }
+
+        // The Renderer waits for the GPU at the end of every frame, so the buffer is idle here
+        if (buffer.cpuPtr)
+            memcpy(buffer.cpuPtr, commands.data(), commands.size() * sizeof(IndirectDrawCommand));
+    };
+
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
+    {
+        retarget(m_OpaqueCommands[pool], m_OpaqueCommandBuffers[pool]);
+        retarget(m_TransparentCommands[pool], m_TransparentCommandBuffers[pool]);
     }
+}
+
+bool Model::CullMeshlets(const DirectX::BoundingFrustum& frustum, const DirectX::XMFLOAT3& cameraPosition, MeshletCullResult& result) const
+{
+    result.indices.clear();
+    result.commands.clear();
+    result.stats = MeshletCullStats();
+    MeshletCullStats& stats = result.stats;
 
-    // Increment debug counter
-    ++m_NodesSurviveFrustum;
+    const bool compact = (m_IndexData || m_IndexCount == 0) && (m_Index16Data || m_Index16Count == 0);
+    const DirectX::XMVECTOR eye = DirectX::XMLoadFloat3(&cameraPosition);
 
-    DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&node->transform) * parentTransform;
+    // Appends [first, first + count) of a primitive's indices to the compacted list
+    auto appendIndices = [&](const GLTFPrimitive& prim, uint32_t first, uint32_t count)
+    {
+        if (!compact)
+            return;
+        const uint32_t start = prim.globalIndexOffset + first;
+        if (prim.indexPool == IndexPool_16)
+            result.indices.insert(result.indices.end(), m_Index16Data + start, m_Index16Data + start + count);
+        else
+            result.indices.insert(result.indices.end(), m_IndexData + start, m_IndexData + start + count);
+    };
 
-    if (node->mesh)
+    for (const auto& node : m_GltfModel.nodes)
     {
-        for (uint32_t i = 0; i < static_cast<uint32_t>(node->mesh->primitives.size()); ++i)
+        if (!node.mesh)
+            continue;
+
+        const bool nodeVisible = GetWorldAabb(node).Intersects(frustum);
+        for (uint32_t i = 0; i < static_cast<uint32_t>(node.mesh->primitives.size()); ++i)
         {
-            auto& prim = node->mesh->primitives[i];
-            if (prim.alphaMode != mode)
+            const GLTFPrimitive& prim = node.mesh->primitives[i];
+            const uint32_t drawNodeIndex = GetDrawNodeIndex(node, i);
+            ++stats.drawsTested;
+            stats.trianglesTotal += prim.indexCount / 3;
+            stats.meshletsTested += prim.meshletCount;
+
+            if (!nodeVisible)
+            {
+                stats.frustumCulled += prim.meshletCount;
                 continue;
+            }
 
-            // Render the mesh using programmable vertex pulling
-            // StartInstanceLocation serves as our index into m_DrawNodeBuffer
-            uint32_t nodeDataIndex = node->nodeDataOffset + i;
-            commandList->DrawIndexedInstanced(static_cast<UINT>(prim.indices.size()), 1, prim.globalIndexOffset, 0, nodeDataIndex);
+            IndirectDrawCommand cmd = {};
+            cmd.drawArgs.InstanceCount = 1;
+            cmd.drawArgs.StartIndexLocation = static_cast<UINT>(result.indices.size());
+            cmd.drawArgs.StartInstanceLocation = drawNodeIndex;
+
+            if (prim.meshletCount == 0)
+            {
+                // Not split: the node test is all we have
+                appendIndices(prim, 0, prim.indexCount);
+                cmd.drawArgs.IndexCountPerInstance = prim.indexCount;
+            }
+            else
+            {
+                const DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&m_DrawNodeData[drawNodeIndex].world);
+
+                // Cone tests run in primitive-local space, where the sign of dot(normal, position - eye) is unchanged by
+                // the world transform. Mirroring transforms flip the rasterized winding, so their cones are not trusted.
+                DirectX::XMVECTOR determinant;
+                const DirectX::XMMATRIX worldInverse = DirectX::XMMatrixInverse(&determinant, world);
+                const bool coneCulling = prim.alphaMode != AlphaMode::Blend && DirectX::XMVectorGetX(determinant) > 0.0f;
+                const DirectX::XMVECTOR localEye = DirectX::XMVector3TransformCoord(eye, worldInverse);
+
+                for (uint32_t m = prim.firstMeshlet; m < prim.firstMeshlet + prim.meshletCount; ++m)
+                {
+                    const Meshlet& meshlet = m_Meshlets[m];
+
+                    if (coneCulling)
+                    {
+                        const DirectX::XMVECTOR toApex = DirectX::XMVector3Normalize(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&meshlet.coneApex), localEye));
+                        if (DirectX::XMVectorGetX(DirectX::XMVector3Dot(toApex, DirectX::XMLoadFloat3(&meshlet.coneAxis))) >= meshlet.coneCutoff)
+                        {
+                            ++stats.backfaceCulled;
+                            continue;
+                        }
+                    }
+
+                    // Sphere first (cheap), then the tighter box
+                    DirectX::BoundingSphere sphere(meshlet.center, meshlet.radius);
+                    sphere.Transform(sphere, world);
+                    bool visible = frustum.Intersects(sphere);
+                    if (visible)
+                    {
+                        DirectX::BoundingBox box;
+                        DirectX::BoundingBox::CreateFromPoints(box, DirectX::XMLoadFloat3(&meshlet.aabbMin), DirectX::XMLoadFloat3(&meshlet.aabbMax));
+                        DirectX::BoundingOrientedBox orientedBox;
+                        DirectX::BoundingOrientedBox::CreateFromBoundingBox(orientedBox, box);
+                        orientedBox.Transform(orientedBox, world);
+                        visible = frustum.Intersects(orientedBox);
+                    }
+                    if (!visible)
+                    {
+                        ++stats.frustumCulled;
+                        continue;
+                    }
+
+                    appendIndices(prim, meshlet.firstIndex, meshlet.indexCount);
+                    cmd.drawArgs.IndexCountPerInstance += meshlet.indexCount;
+                }
+            }
+
+            stats.trianglesVisible += cmd.drawArgs.IndexCountPerInstance / 3;
+            if (compact && cmd.drawArgs.IndexCountPerInstance > 0)
+                result.commands.push_back(cmd);
         }
     }
 
-    for (auto* child : node->children)
+    return compact;
+}
+
+// Draw nodes one at a time in hierarchy order (kept for debugging or future culling, not used by ExecuteIndirect right now)
+void Model::RenderNodes(ID3D12GraphicsCommandList* commandList, const DirectX::BoundingFrustum& frustum, AlphaMode mode)
+{
+    const NodeHierarchy& hierarchy = m_GltfModel.hierarchy;
+    for (size_t i = 0; i < hierarchy.nodes.size();)
     {
-        RenderNode(commandList, child, world, renderer, frustum, mode);
+        // Frustum culling skips the whole subtree
+        if (hierarchy.worldAabbs[i].Intersects(frustum) == false)
+        {
+            i = hierarchy.subtreeEnds[i];
+            continue;
+        }
+
+        // Increment debug counter
+        ++m_NodesSurviveFrustum;
+
+        const GLTFNode* node = hierarchy.nodes[i++];
+        if (!node->mesh)
+            continue;
+
+        for (uint32_t j = 0; j < static_cast<uint32_t>(node->mesh->primitives.size()); ++j)
+        {
+            auto& prim = node->mesh->primitives[j];
+            if (prim.alphaMode != mode)
+                continue;
+
+            // Render the mesh using programmable vertex pulling
+            // StartInstanceLocation serves as our index into m_DrawNodeBuffer
+            const GPUBuffer& indexBuffer = prim.indexPool == IndexPool_16 ? m_GlobalIndex16Buffer : m_GlobalIndexBuffer;
+            D3D12_INDEX_BUFFER_VIEW ibv = {};
+            ibv.BufferLocation = indexBuffer.gpuAddress;
+            ibv.SizeInBytes = static_cast<UINT>(indexBuffer.size);
+            ibv.Format = GetIndexFormat(prim.indexPool);
+            commandList->IASetIndexBuffer(&ibv);
+
+            uint32_t nodeDataIndex = GetDrawNodeIndex(*node, j);
+            commandList->DrawIndexedInstanced(prim.indexCount, 1, prim.globalIndexOffset, 0, nodeDataIndex);
+        }
     }
 }
 
@@ -1099,15 +2946,12 @@ void Model::GetAllPrimitives(std::vector<const GLTFPrimitive*>& primitives) cons
 
 void Model::GetDrawNodePrimitives(std::vector<const GLTFPrimitive*>& primitives) const
 {
-    for (uint32_t i = 0; i < static_cast<uint32_t>(m_GltfModel.nodes.size()); ++i)
+    // Node data is grouped per primitive, one record per mesh instance
+    for (const auto& mesh : m_GltfModel.meshes)
     {
-        const GLTFNode& node = m_GltfModel.nodes[i];
-        if (node.mesh)
+        for (const auto& prim : mesh.primitives)
         {
-            for (const auto& prim : node.mesh->primitives)
-            {
-                primitives.push_back(&prim);
-            }
+            primitives.insert(primitives.end(), mesh.instanceCount, &prim);
         }
     }
 }
\ No newline at end of file
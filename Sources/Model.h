@@ -3,16 +3,26 @@
 #include <d3d12.h>
 #include <d3dx12.h>
 #include <wrl.h>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <DirectXMath.h>
 #include <DirectXCollision.h>
 #include <DirectXTex.h>
 #include "GraphicsTypes.h"
+#include "SceneTypes.h"
+#include "SceneCache.h"
+#include "TextureCooker.h"
+#include "TextureStreamer.h"
+#include "VertexCompression.h"
+#include "MeshProcessing.h"
+#include "AnimationCompression.h"
+#include "NodeHierarchy.h"
 
 // Forward declarations
 struct cgltf_data;
 class Renderer;
+class ResourceUploadBatch;
 
 // Material constants matching the shader
 struct MaterialConstants
@@ -23,7 +33,12 @@ struct MaterialConstants
     int baseColorTextureIndex;
     int normalTextureIndex;
     int metallicRoughnessTextureIndex;
-    uint32_t padding[1]; // Padding to maintain 16-byte alignment if needed, or just for future-proofing
+    uint32_t flags; // MaterialFlags
+};
+
+enum MaterialFlags : uint32_t
+{
+    MaterialFlag_PackedMetallicRoughness = 1 << 0 // Roughness/metallic in RG (cooked BC5) instead of GB
 };
 
 struct DrawNodeData
@@ -32,25 +47,38 @@ struct DrawNodeData
     uint32_t vertexOffset;
     uint32_t indexOffset;
     uint32_t materialID;
-    uint32_t padding;
+    uint32_t indexPool;               // IndexPool that indexOffset points into
+    DirectX::XMFLOAT4 positionOffset; // Compact vertices: primitive AABB min
+    DirectX::XMFLOAT4 positionScale;  // Compact vertices: primitive AABB size
 };
 
-struct IndirectDrawCommand
+// Where a pooled model's data lives in a Scene's shared buffers, in elements of each buffer
+struct ModelPlacement
 {
-    D3D12_DRAW_INDEXED_ARGUMENTS drawArgs;
+    uint32_t vertexBase = 0;
+    uint32_t indexBase[IndexPool_Count] = {};
+    uint32_t materialBase = 0;
+    uint32_t drawNodeBase = 0;
 };
 
-struct GLTFVertex
+inline UINT GetIndexSize(IndexPool pool) { return pool == IndexPool_16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+inline DXGI_FORMAT GetIndexFormat(IndexPool pool) { return pool == IndexPool_16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT; }
+
+struct IndirectDrawCommand
 {
-    float position[3];
-    float normal[3];
-    float texCoord[2];
+    D3D12_DRAW_INDEXED_ARGUMENTS drawArgs;
 };
 
 struct GLTFImage
 {
     GPUTexture texture;
-    DirectX::ScratchImage* image = nullptr;
+    // Source: an external file (uri, relative to the glTF) or bytes embedded in a glTF buffer
+    std::string uri;
+    const uint8_t* embeddedData = nullptr;
+    size_t embeddedSize = 0;
+    TextureUsage usage = TextureUsage::Color;
+    bool packedMetallicRoughness = false;
+    int streamHandle = -1; // TextureStreamer handle when the mips stream in (the streamer then owns the texture)
 };
 
 struct GLTFTexture
@@ -58,60 +86,81 @@ struct GLTFTexture
     GLTFImage* source = nullptr;
 };
 
-enum class AlphaMode
+// glTF image index behind each material texture slot (-1 = none)
+struct MaterialImageRefs
 {
-    Opaque,
-    Mask,
-    Blend
+    int baseColor = -1;
+    int normal = -1;
+    int metallicRoughness = -1;
 };
 
-struct GLTFPrimitive
+// A node drawing a skinned mesh. Its palette takes bind-pose vertices to the node's own space,
+// so the skinned vertices are drawn with the node's DrawNodeData like any other.
+struct SkinInstance
 {
-    std::vector<GLTFVertex> vertices;
-    std::vector<uint32_t> indices;
-    UINT materialIndex = 0;
-    AlphaMode alphaMode = AlphaMode::Opaque;
-    uint32_t globalVertexOffset = 0;
-    uint32_t globalIndexOffset = 0;
-    DirectX::BoundingBox aabb;
+    GLTFNode* node = nullptr;
+    const GLTFSkin* skin = nullptr;
+    uint32_t firstPaletteMatrix = 0; // Into the model's joint palette, one matrix per skin joint
+    bool dirty = true;               // The node or a joint moved since the primitives were last skinned
 };
 
-struct GLTFMesh
+// Consecutive DrawNodeData records
+struct DrawNodeRange
 {
-    std::string name;
-    std::vector<GLTFPrimitive> primitives;
+    uint32_t first;
+    uint32_t count;
 };
 
-struct GLTFNode
+// One playing clip. A model may play several clips, and one clip several times, at once: each
+// instance samples on its own (in parallel with the others), then all are blended into the nodes.
+struct AnimationInstance
 {
-    std::string name;
-    GLTFMesh* mesh = nullptr;
-    std::vector<GLTFNode*> children;
-    DirectX::XMFLOAT4X4 transform;
-    GLTFNode* parent = nullptr;
-    DirectX::BoundingBox worldAabb;
-    // TRS for animation
-    DirectX::XMFLOAT3 translation = {0.0f, 0.0f, 0.0f};
-    DirectX::XMFLOAT4 rotation = {0.0f, 0.0f, 0.0f, 1.0f};
-    DirectX::XMFLOAT3 scale = {1.0f, 1.0f, 1.0f};
-    uint32_t nodeDataOffset = 0;
+    uint32_t id = 0;
+    const GLTFAnimation* animation = nullptr;
+    float time = 0.0f;
+    float speed = 1.0f;
+    float weight = 1.0f;         // Relative to the other instances animating the same node
+    std::vector<size_t> cursors; // Per channel: key the last sample started from, so playback advances it instead of searching
+    AnimationSampleLanes lanes[GLTFAnimationChannel::TypeCount]; // The last sample, per channel type
+    float sampleMs = 0.0f;
 };
 
-struct GLTFAnimationChannel
+// What CPU-side data a Model keeps once UploadTextures has put everything on the GPU
+enum class ResidencyPolicy
 {
-    enum Type { Translation, Rotation, Scale };
-    Type type;
-    GLTFNode* targetNode = nullptr;
-    std::vector<float> times;
-    std::vector<DirectX::XMFLOAT3> translations; // for translation
-    std::vector<DirectX::XMFLOAT4> rotations; // for rotation
-    std::vector<DirectX::XMFLOAT3> scales; // for scale
+    KeepAll,                // Keep everything, including the parsed glTF and its buffers
+    KeepForCpuRayTracing,   // Keep the global vertex/index arrays, drop the glTF source data
+    ReleaseAfterUpload      // Keep only what rendering and AS builds need (offsets and counts)
 };
 
-struct GLTFAnimation
+// Resident CPU bytes held by a Model, per category
+struct ModelMemoryStats
 {
-    std::string name;
-    std::vector<GLTFAnimationChannel> channels;
+    size_t geometryBytes = 0;   // Global vertex/index arrays
+    size_t sceneCacheBytes = 0; // Mapped scene cache file
+    size_t gltfSourceBytes = 0; // Parsed glTF JSON and loaded buffers
+    size_t sceneBytes = 0;      // Meshes, nodes, draw node data, commands and materials
+    size_t animationBytes = 0;  // Keyframes
+
+    size_t GetTotal() const { return geometryBytes + sceneCacheBytes + gltfSourceBytes + sceneBytes + animationBytes; }
+};
+
+struct MeshletCullStats
+{
+    size_t drawsTested = 0;
+    size_t meshletsTested = 0;
+    size_t frustumCulled = 0;   // Meshlets outside the frustum (including those of culled nodes)
+    size_t backfaceCulled = 0;  // Meshlets whose normal cone faces away from the camera
+    size_t trianglesVisible = 0;
+    size_t trianglesTotal = 0;
+};
+
+// Output of the CPU meshlet culling reference
+struct MeshletCullResult
+{
+    std::vector<uint32_t> indices;              // Surviving triangles (primitive-local indices), compacted
+    std::vector<IndirectDrawCommand> commands;  // One per draw node with survivors; StartIndexLocation points into `indices`
+    MeshletCullStats stats;
 };
 
 struct GLTFModel
@@ -119,9 +168,11 @@ struct GLTFModel
     std::vector<GLTFMesh> meshes;
     std::vector<GLTFNode> nodes;
     std::vector<GLTFAnimation> animations;
+    std::vector<GLTFSkin> skins;
     std::vector<GLTFImage> images;
     std::vector<GLTFTexture> textures;
     std::vector<GLTFNode*> rootNodes;
+    NodeHierarchy hierarchy;
     cgltf_data* data = nullptr; // Raw cgltf data
 };
 
@@ -132,9 +183,116 @@ public:
     ~Model();
 
     bool LoadGLTFModel(Renderer* renderer, const std::string& filepath);
+
+    // Leave the vertex, index, material, draw node and command buffers to a Scene that pools
+    // them (see Scene::Place). Set before loading.
+    void SetPooled(bool pooled) { m_Pooled = pooled; }
+    bool IsPooled() const { return m_Pooled; }
+
+    // Start playing clip `animation` and return the instance's id (0 when there is no such clip).
+    // Where instances animate the same node they are blended by weight. The first clip starts
+    // playing at load.
+    uint32_t PlayAnimation(size_t animation, float weight = 1.0f, float speed = 1.0f, float startTime = 0.0f);
+    void StopAnimation(uint32_t instance);
+    void SetAnimationWeight(uint32_t instance, float weight);
+    size_t GetAnimationCount() const { return m_GltfModel.animations.size(); }
+    size_t GetAnimationInstanceCount() const { return m_AnimationInstances.size(); }
+
+    // One frame of animation in three steps, so a Scene can spread the instances of every model
+    // over the JobSystem: advance the clocks, sample each instance (thread-safe for distinct
+    // instances), then blend the samples into the nodes and propagate the transforms.
+    // UpdateAnimation runs all three for this model alone.
     void UpdateAnimation(float deltaTime);
+    void AdvanceAnimations(float deltaTime);
+    void SampleAnimation(size_t instanceIndex);
+    void ApplyAnimations();
+    // CPU time the last frame spent sampling channels (summed over instances) and blending and
+    // composing node matrices
+    float GetAnimationSampleMs() const { return m_AnimationSampleMs; }
+    size_t GetAnimatedChannelCount() const;
     void Render(ID3D12GraphicsCommandList* commandList, Renderer* renderer, const DirectX::BoundingFrustum& frustum, AlphaMode mode = AlphaMode::Opaque);
+    // Upload vertices, indices and (untextured) materials; the model can be drawn once this returns.
+    // Waits on the GPU with its own command list, so it may run on a loading thread.
+    void UploadGeometry(Renderer* renderer);
+    // Pooled models upload in two halves, so only the thread that records the frames touches the
+    // shared buffers' states: StageGeometry copies vertices and indices into an upload buffer (may
+    // run on a loading thread), CopyGeometry records their copy into the buffers at `placement`.
+    // ReleaseGeometryUpload once the batch has ended.
+    bool StageGeometry(Renderer* renderer);
+    void CopyGeometry(ResourceUploadBatch& batch, GPUBuffer& vertexBuffer, GPUBuffer* const (&indexBuffers)[IndexPool_Count], const ModelPlacement& placement);
+    void ReleaseGeometryUpload() { m_GeometryUpload = GPUBuffer(); }
+    // Upload textures through `cmdList`, re-upload materials pointing at them and release CPU data.
+    // Touches no state the frame loop reads except the material buffer, so it may run on a loading
+    // thread (with its own command list and allocator) while the model is drawn.
     void UploadTextures(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, ID3D12CommandQueue* cmdQueue, ID3D12CommandAllocator* cmdAllocator, Renderer* renderer);
+    // Images uploaded so far by UploadTextures; safe to poll from another thread
+    size_t GetTexturesUploaded() const { return m_TexturesUploaded.load(); }
+    size_t GetTextureCount() const { return m_TextureCount.load(); }
+
+    // Decode primitives on the JobSystem workers (false = serial, for load-time comparisons)
+    void SetParallelDecode(bool enabled) { m_ParallelDecode = enabled; }
+
+    // The import settings below (welding, meshlets, LODs, mesh optimization, animation
+    // compression) are part of the scene cache key: a cache cooked with other settings is rebuilt.
+
+    // Merge duplicate vertices per primitive after decoding
+    void SetWeldVertices(bool enabled) { m_WeldVertices = enabled; }
+    void SetWeldSettings(const WeldSettings& settings) { m_WeldSettings = settings; }
+
+    // Split primitives into meshlets with bounds and normal cones
+    void SetBuildMeshlets(bool enabled) { m_BuildMeshlets = enabled; }
+
+    // Generate simplified LODs per primitive
+    void SetBuildLods(bool enabled) { m_BuildLods = enabled; }
+
+    // Point every indirect draw at the coarsest LOD whose error projects to at most the
+    // threshold (in pixels) from `cameraPosition`. Call once per frame after BeginFrame.
+    void UpdateLods(const DirectX::XMFLOAT3& cameraPosition, float fovY, float viewportHeight);
+    void SetLodErrorThreshold(float pixels) { m_LodErrorThreshold = pixels; }
+    float GetLodErrorThreshold() const { return m_LodErrorThreshold; }
+    size_t GetLodDrawCount(uint32_t lod) const { return m_LodDrawCounts[lod]; }
+
+    // Reorder triangles (vertex cache, overdraw) and vertices (fetch locality) after decoding
+    void SetOptimizeMeshes(bool enabled) { m_OptimizeMeshes = enabled; }
+
+    // Drop animation keys reconstructible within tolerance and quantize the rest
+    void SetCompressAnimations(bool enabled) { m_CompressAnimations = enabled; }
+    void SetAnimationCompressionSettings(const AnimationCompressionSettings& settings) { m_AnimationCompressionSettings = settings; }
+
+    // Load from / write a cooked <file>.trscene next to the glTF so warm starts skip cgltf
+    void SetUseSceneCache(bool enabled) { m_UseSceneCache = enabled; }
+
+    // Cap on decoded image bytes in flight (and staged between submits) while uploading textures
+    void SetTextureDecodeBudget(size_t bytes) { m_TextureDecodeBudget = bytes; }
+
+    // Upload block-compressed, mipmapped textures from the DDS cache (cooking them on a miss) instead of raw WIC output
+    void SetCookTextures(bool enabled) { m_CookTextures = enabled; }
+
+    // Upload only the mip tail of cooked textures and stream finer mips in by screen size (needs cooked textures)
+    void SetStreamTextures(bool enabled) { m_StreamTextures = enabled; }
+
+    // Request mips for the textures of visible nodes and record this frame's streaming uploads.
+    // Call after BeginFrame and before any pass that samples material textures. Returns true
+    // when material texture indices changed (pooled models leave the re-upload to the Scene).
+    bool UpdateTextureStreaming(ID3D12GraphicsCommandList* cmdList, const DirectX::BoundingFrustum& frustum, const DirectX::XMFLOAT3& cameraPosition, float fovY, float viewportHeight);
+    TextureStreamer& GetTextureStreamer() { return m_TextureStreamer; }
+
+    // Shader-visible descriptors UploadTextures may take (at most two per image when streamed)
+    size_t GetTextureDescriptorCount() const { return m_GltfModel.images.size() * 2; }
+    // Return the texture SRV slots to the Renderer; the GPU must be done with them
+    void ReleaseDescriptors(Renderer* renderer);
+
+    // CPU data kept after upload; applied at the end of UploadTextures
+    void SetResidencyPolicy(ResidencyPolicy policy) { m_ResidencyPolicy = policy; }
+    ResidencyPolicy GetResidencyPolicy() const { return m_ResidencyPolicy; }
+    ModelMemoryStats GetMemoryStats() const;
+
+    // CPU reference for cluster culling: rejects meshlets outside `frustum` and, for back-face
+    // culled (non-blend) primitives, meshlets facing away from `cameraPosition`. The compacted
+    // index list needs CPU indices (ResidencyPolicy::KeepAll or KeepForCpuRayTracing); without
+    // them only the stats are filled in and false is returned.
+    bool CullMeshlets(const DirectX::BoundingFrustum& frustum, const DirectX::XMFLOAT3& cameraPosition, MeshletCullResult& result) const;
+    size_t GetMeshletCount() const { return m_Meshlets.size(); }
 
     // Getters for debug counters
     size_t GetTotalNodes() const { return m_TotalNodes; }
@@ -145,9 +303,19 @@ public:
     void GetAllPrimitives(std::vector<const struct GLTFPrimitive*>& primitives) const;
     void GetDrawNodePrimitives(std::vector<const struct GLTFPrimitive*>& primitives) const;
     const std::vector<DrawNodeData>& GetDrawNodeData() const { return m_DrawNodeData; }
+    const std::vector<MaterialConstants>& GetMaterialConstants() const { return m_MaterialConstants; }
+    const std::vector<IndirectDrawCommand>& GetOpaqueCommands(IndexPool pool) const { return m_OpaqueCommands[pool]; }
+    const std::vector<IndirectDrawCommand>& GetTransparentCommands(IndexPool pool) const { return m_TransparentCommands[pool]; }
+    // The opaque commands at LOD0, whatever UpdateLods picked for the camera: for passes drawn
+    // from another viewpoint, such as the shadow map
+    void GetFullDetailCommands(IndexPool pool, std::vector<IndirectDrawCommand>& commands) const;
+    size_t GetVertexCount() const { return m_VertexCount; }
+    size_t GetIndexCount(IndexPool pool) const { return pool == IndexPool_16 ? m_Index16Count : m_IndexCount; }
     
     D3D12_GPU_VIRTUAL_ADDRESS GetGlobalVertexBufferAddress() const { return m_GlobalVertexBuffer.gpuAddress; }
-    D3D12_GPU_VIRTUAL_ADDRESS GetGlobalIndexBufferAddress() const { return m_GlobalIndexBuffer.gpuAddress; }
+    VertexFormat GetVertexFormat() const { return m_VertexFormat; }
+    UINT GetVertexStride() const { return m_VertexFormat == VertexFormat::Compact ? sizeof(CompactVertex) : sizeof(GLTFVertex); }
+    D3D12_GPU_VIRTUAL_ADDRESS GetGlobalIndexBufferAddress(IndexPool pool) const { return pool == IndexPool_16 ? m_GlobalIndex16Buffer.gpuAddress : m_GlobalIndexBuffer.gpuAddress; }
 
     D3D12_GPU_VIRTUAL_ADDRESS GetMaterialBufferAddress() const { return m_MaterialBuffer.gpuAddress; }
     D3D12_GPU_VIRTUAL_ADDRESS GetDrawNodeBufferAddress() const { return m_DrawNodeBuffer.gpuAddress; }
@@ -155,48 +323,153 @@ public:
     // Update node buffer with current node transforms
     void UpdateNodeBuffer();
 
+    // Flag a node whose transform changed; UpdateTransforms then refreshes its subtree
+    void MarkTransformDirty(GLTFNode* node);
+    // Recompute world matrices and DrawNodeData of the marked subtrees, and refit the world
+    // AABBs above them. Does nothing while no node is marked.
+    void UpdateTransforms();
+    const DirectX::BoundingBox& GetWorldAabb(const GLTFNode& node) const { return m_GltfModel.hierarchy.worldAabbs[node.hierarchyIndex]; }
+    // DrawNodeData records UpdateTransforms changed since the last call, sorted and coalesced.
+    // Models with their own draw node buffer write these themselves.
+    void TakeDirtyDrawNodes(std::vector<DrawNodeRange>& ranges);
+
+    // Skin the primitives of every skin instance whose node or joints moved since the last call,
+    // into the skinning upload buffer: joint palettes first, then vertices, both across the
+    // JobSystem workers. Returns false when nothing was skinned. Full vertex format only; a model
+    // with skins fails to load under compact vertices.
+    bool SkinVertices();
+    // Record copies of what the last SkinVertices wrote into `vertexBuffer` (the model's own, or
+    // its Scene's pool with the model at vertexBase). Leaves the buffer in COPY_DEST.
+    void CopySkinnedVertices(ID3D12GraphicsCommandList* cmdList, GPUBuffer& vertexBuffer, uint32_t vertexBase);
+    // Models with their own vertex buffer: both of the above. Call after BeginFrame, before the passes.
+    void UpdateSkinning(ID3D12GraphicsCommandList* cmdList);
+    // Primitives the last SkinVertices rewrote; their BLASes need a refit
+    const std::vector<const GLTFPrimitive*>& GetSkinnedPrimitives() const { return m_SkinnedPrimitives; }
+    size_t GetSkinInstanceCount() const { return m_SkinInstances.size(); }
+    size_t GetSkinnedVertexCount() const { return m_SkinnedVertexCount; } // By the last SkinVertices
+    float GetSkinningMs() const { return m_SkinningMs; }
+    // Compare every SkinVertices result with the scalar reference (slow; for validation)
+    void SetValidateSkinning(bool enabled) { m_ValidateSkinning = enabled; }
+    float GetSkinningError() const { return m_SkinningError; } // Largest position difference seen while validating
+
     // Prevent copying
     Model(const Model&) = delete;
     Model& operator=(const Model&) = delete;
 
 private:
-    void CreateGLTFResources(Renderer* renderer);
-    void RenderNode(ID3D12GraphicsCommandList* commandList, GLTFNode* node, DirectX::XMMATRIX parentTransform, Renderer* renderer, const DirectX::BoundingFrustum& frustum, AlphaMode mode);
-    void ComputeWorldAABBs(GLTFNode* node, DirectX::XMMATRIX parentTransform);
-    void UpdateNodeBufferRecursive(GLTFNode* node, DirectX::XMMATRIX parentTransform);
-    void LoadTextures(Renderer* renderer);
+    bool LoadFromSceneCache(Renderer* renderer, const std::string& directory, const std::string& cachePath);
+    uint64_t HashImportSettings() const; // Part of the scene cache key
+    bool ReadSceneCacheMeta(const uint8_t* data, uint64_t size);
+    void WriteSceneCache(const std::string& directory, const std::string& fileName, const std::string& cachePath);
+    void BuildDrawCommands();
+    bool CreateGLTFResources(Renderer* renderer); // False when a buffer cannot be created or a skin is unsupported
+    void RenderNodes(ID3D12GraphicsCommandList* commandList, const DirectX::BoundingFrustum& frustum, AlphaMode mode);
+    void BuildHierarchy();
+    void PropagateTransforms(bool writeDrawNodes);
+    void LoadTextures();
     void LoadMaterials();
+    void ResolveMaterialTextures();
     void BuildNodeHierarchy();
     void LoadAnimations();
+    void CompressAnimations();
+    void LoadSkins();
+    bool BuildSkinInstances(); // False, with an error, for a skinned mesh outside what SkinVertices supports
+    void ReleaseCPUData();
+    void EncodeCompactVertices(std::vector<CompactVertex>& result) const;
 
     GLTFModel m_GltfModel;
     std::wstring fileDirectory;
+    bool m_Pooled = false;
+    bool m_ParallelDecode = true;
+    bool m_WeldVertices = true;
+    WeldSettings m_WeldSettings;
+    bool m_OptimizeMeshes = true;
+    bool m_CompressAnimations = true;
+    AnimationCompressionSettings m_AnimationCompressionSettings;
+    bool m_BuildMeshlets = true;
+    bool m_BuildLods = true;
+    float m_LodErrorThreshold = 1.0f;
+    size_t m_LodDrawCounts[MaxLodCount] = {};
+    bool m_UseSceneCache = true;
+    ResidencyPolicy m_ResidencyPolicy = ResidencyPolicy::ReleaseAfterUpload;
+    size_t m_TextureDecodeBudget = 256ull * 1024 * 1024;
+    bool m_CookTextures = true;
+    bool m_StreamTextures = true;
+    TextureStreamer m_TextureStreamer;
+    std::atomic<size_t> m_TexturesUploaded{ 0 };
+    std::atomic<size_t> m_TextureCount{ 0 };
+    SceneCache m_SceneCache;
     UINT srvDescriptorSize;
 
     // GPU Materials
     std::vector<MaterialConstants> m_MaterialConstants;
+    std::vector<MaterialImageRefs> m_MaterialImages;
     GPUBuffer m_MaterialBuffer;
+    GPUBuffer m_MaterialUploadBuffer; // Re-uploads materials when streaming switches a texture index
 
     // Draw Node Data (Combined Transform and Draw Metadata)
     std::vector<DrawNodeData> m_DrawNodeData;
+    std::vector<const GLTFPrimitive*> m_DrawNodePrimitives; // Primitive behind each DrawNodeData
     GPUBuffer m_DrawNodeBuffer;
+    std::vector<uint32_t> m_DirtyDrawNodes; // Records UpdateTransforms rewrote, not yet taken
+    std::vector<DrawNodeRange> m_DirtyDrawNodeRanges;
+    bool m_TransformsDirty = false; // Some node was marked since the last UpdateTransforms
 
-    // Indirect Draw Commands
-    std::vector<IndirectDrawCommand> m_OpaqueCommands;
-    GPUBuffer m_OpaqueCommandBuffer;
+    // Indirect Draw Commands, one list per index pool. The buffers live in an upload heap so
+    // UpdateLods can retarget them every frame.
+    std::vector<IndirectDrawCommand> m_OpaqueCommands[IndexPool_Count];
+    GPUBuffer m_OpaqueCommandBuffers[IndexPool_Count];
 
-    std::vector<IndirectDrawCommand> m_TransparentCommands;
-    GPUBuffer m_TransparentCommandBuffer;
+    std::vector<IndirectDrawCommand> m_TransparentCommands[IndexPool_Count];
+    GPUBuffer m_TransparentCommandBuffers[IndexPool_Count];
 
-    // Global Vertex/Index Buffers
+    // Global Vertex/Index Buffers (primitives decode straight into their slice of these)
     std::vector<GLTFVertex> m_GlobalVertices;
     std::vector<uint32_t> m_GlobalIndices;
+    std::vector<uint16_t> m_GlobalIndices16;
+    std::vector<Meshlet> m_Meshlets; // Every primitive's meshlets, in primitive order
+    // What gets uploaded: the vectors above after a cold load, or views into the mapped scene cache
+    const GLTFVertex* m_VertexData = nullptr;
+    size_t m_VertexCount = 0;
+    const uint32_t* m_IndexData = nullptr;
+    size_t m_IndexCount = 0;
+    const uint16_t* m_Index16Data = nullptr;
+    size_t m_Index16Count = 0;
+    VertexFormat m_VertexFormat = VertexFormat::Full; // Taken from the Renderer when the buffers are created
     GPUBuffer m_GlobalVertexBuffer;
     GPUBuffer m_GlobalIndexBuffer;
+    GPUBuffer m_GlobalIndex16Buffer;
+    GPUBuffer m_GeometryUpload; // Vertices, then each index pool, between StageGeometry and ReleaseGeometryUpload
+    UINT64 m_GeometryUploadOffsets[1 + IndexPool_Count] = {};
+    UINT64 m_GeometryUploadSizes[1 + IndexPool_Count] = {};
 
     // Animation
-    GLTFAnimation* m_CurrentAnimation = nullptr;
-    float m_AnimationTime = 0.0f;
+    // Weighted sums of one node's samples while ApplyAnimations blends the instances
+    struct AnimationBlend
+    {
+        DirectX::XMFLOAT3 translation;
+        DirectX::XMFLOAT4 rotation;
+        DirectX::XMFLOAT3 scale;
+        float weights[GLTFAnimationChannel::TypeCount];
+        bool targeted;
+    };
+
+    std::vector<AnimationInstance> m_AnimationInstances;
+    uint32_t m_NextAnimationInstanceId = 1;
+    std::vector<AnimationBlend> m_AnimationBlends; // Per hierarchy index, reused every frame
+    std::vector<GLTFNode*> m_AnimationTargets;
+    float m_AnimationSampleMs = 0.0f;
+
+    // Skinning
+    std::vector<SkinVertex> m_SkinVertices; // Every skinned primitive's vertices, in primitive order
+    std::vector<SkinInstance> m_SkinInstances;
+    std::vector<DirectX::XMFLOAT4X4> m_JointPalette;
+    GPUBuffer m_SkinnedVertexUpload; // GLTFVertex per skin vertex; the GPU is idle between frames, so rewritten in place
+    std::vector<const GLTFPrimitive*> m_SkinnedPrimitives;
+    size_t m_SkinnedVertexCount = 0;
+    float m_SkinningMs = 0.0f;
+    bool m_ValidateSkinning = false;
+    float m_SkinningError = 0.0f;
 
     // Debug counters
     size_t m_TotalNodes = 0;
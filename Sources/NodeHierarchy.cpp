@@ -0,0 +1,76 @@
+#include "NodeHierarchy.h"
+#include "SceneTypes.h"
+
+void PropagateNodeTransforms(NodeHierarchy& hierarchy)
+{
+    const size_t count = hierarchy.nodes.size();
+
+    // Parents first: a node moves when its own local matrix or an ancestor's changed
+    for (size_t i = 0; i < count; ++i)
+    {
+        const int32_t parent = hierarchy.parents[i];
+        const bool moved = hierarchy.dirty[i] || (parent >= 0 && (hierarchy.states[parent] & NodeState_Moved));
+        hierarchy.dirty[i] = 0;
+        hierarchy.states[i] = moved ? NodeState_Moved : 0;
+        if (!moved)
+            continue;
+
+        DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&hierarchy.locals[i]);
+        if (parent >= 0)
+            world = world * DirectX::XMLoadFloat4x4(&hierarchy.worlds[parent]);
+        DirectX::XMStoreFloat4x4(&hierarchy.worlds[i], world);
+
+        const GLTFNode& node = *hierarchy.nodes[i];
+        if (!node.mesh)
+            continue;
+        for (uint32_t j = 0; j < static_cast<uint32_t>(node.mesh->primitives.size()); ++j)
+        {
+            DirectX::BoundingBox transformedAabb;
+            node.mesh->primitives[j].aabb.Transform(transformedAabb, world);
+            if (j == 0)
+                hierarchy.meshAabbs[i] = transformedAabb;
+            else
+                DirectX::BoundingBox::CreateMerged(hierarchy.meshAabbs[i], hierarchy.meshAabbs[i], transformedAabb);
+        }
+    }
+
+    // Children first: every ancestor of a moved node is refit
+    for (size_t i = count; i-- > 0;)
+    {
+        if (hierarchy.states[i] && hierarchy.parents[i] >= 0)
+            hierarchy.states[hierarchy.parents[i]] |= NodeState_Refit;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        const GLTFNode& node = *hierarchy.nodes[i];
+        if (hierarchy.states[i] && node.mesh && !node.mesh->primitives.empty())
+        {
+            hierarchy.worldAabbs[i] = hierarchy.meshAabbs[i];
+            hierarchy.states[i] |= NodeState_Bounded;
+        }
+    }
+
+    // Children first again: a refit node holds its primitives' box and every child's by the time it is reached
+    for (size_t i = count; i-- > 0;)
+    {
+        if (hierarchy.states[i] && !(hierarchy.states[i] & NodeState_Bounded))
+        {
+            // No primitives and no children: a point at the node's position
+            const DirectX::XMFLOAT4X4& world = hierarchy.worlds[i];
+            hierarchy.worldAabbs[i] = DirectX::BoundingBox(DirectX::XMFLOAT3(world._41, world._42, world._43), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+        }
+
+        const int32_t parent = hierarchy.parents[i];
+        if (parent < 0 || !hierarchy.states[parent])
+            continue;
+        if (hierarchy.states[parent] & NodeState_Bounded)
+        {
+            DirectX::BoundingBox::CreateMerged(hierarchy.worldAabbs[parent], hierarchy.worldAabbs[parent], hierarchy.worldAabbs[i]);
+        }
+        else
+        {
+            hierarchy.worldAabbs[parent] = hierarchy.worldAabbs[i];
+            hierarchy.states[parent] |= NodeState_Bounded;
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+struct GLTFNode;
+
+// The node tree flattened in depth-first order, so parents come before their children and
+// every subtree is a contiguous range. Transforms propagate and bounds refit in linear passes
+// over these arrays instead of recursing through GLTFNode pointers.
+struct NodeHierarchy
+{
+    std::vector<GLTFNode*> nodes;
+    std::vector<int32_t> parents;                  // -1 for roots
+    std::vector<uint32_t> subtreeEnds;             // One past the node's last descendant
+    std::vector<DirectX::XMFLOAT4X4> locals;
+    std::vector<DirectX::XMFLOAT4X4> worlds;
+    std::vector<DirectX::BoundingBox> worldAabbs;  // The node's primitives and all its descendants
+    std::vector<DirectX::BoundingBox> meshAabbs;   // The node's primitives only
+    std::vector<uint8_t> dirty;                    // Local matrix changed since the last propagation
+    std::vector<uint8_t> states;                   // Scratch for the propagation passes
+};
+
+// NodeHierarchy::states bits
+enum NodeState : uint8_t
+{
+    NodeState_Moved = 1,   // World matrix recomputed this pass
+    NodeState_Refit = 2,   // A descendant moved
+    NodeState_Bounded = 4, // World AABB holds at least one box during the refit
+};
+
+// Recompute the world matrix of every dirty node and of its descendants, then refit the world
+// AABBs of the nodes that moved and of their ancestors. Moved nodes keep NodeState_Moved in
+// `states` until the next call, so callers can pick up what changed.
+void PropagateNodeTransforms(NodeHierarchy& hierarchy);
@@ -1,11 +1,33 @@
 #include "Renderer.h"
 #include "Model.h"
+#include "Scene.h"
 #include "Utility.h"
+#include "LoadProfiler.h"
 #include <iostream>
 #include <fstream>
 #include <dxcapi.h>
 #include <cassert>
 
+namespace
+{
+    // Triangles of one primitive in the scene pools; compact positions are unorm16 inside the
+    // primitive AABB, and the instance transform maps them back
+    D3D12_RAYTRACING_GEOMETRY_DESC GetGeometryDesc(const Scene& scene, const ModelPlacement& placement, const GLTFPrimitive& prim)
+    {
+        D3D12_RAYTRACING_GEOMETRY_DESC geom = {};
+        geom.Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
+        geom.Triangles.VertexBuffer.StartAddress = scene.GetGlobalVertexBufferAddress() + (UINT64(placement.vertexBase + prim.globalVertexOffset) * scene.GetVertexStride());
+        geom.Triangles.VertexBuffer.StrideInBytes = scene.GetVertexStride();
+        geom.Triangles.VertexFormat = scene.GetVertexFormat() == VertexFormat::Compact ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R32G32B32_FLOAT;
+        geom.Triangles.VertexCount = prim.vertexCount;
+        geom.Triangles.IndexBuffer = scene.GetGlobalIndexBufferAddress(prim.indexPool) + (UINT64(placement.indexBase[prim.indexPool] + prim.globalIndexOffset) * GetIndexSize(prim.indexPool));
+        geom.Triangles.IndexFormat = GetIndexFormat(prim.indexPool);
+        geom.Triangles.IndexCount = prim.indexCount;
+        geom.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE;
+        return geom;
+    }
+}
+
 Renderer::Renderer()
     : m_FrameIndex(0)
     , m_FenceValue(0)
@@ -129,7 +151,7 @@ bool Renderer::Initialize(HWND hwnd)
     // Create SRV descriptor heap for textures
     {
         D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-        srvHeapDesc.NumDescriptors = 4096; // Increased from 1024
+        srvHeapDesc.NumDescriptors = SrvHeapSize;
         srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
         srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 
@@ -192,8 +214,14 @@ bool Renderer::Initialize(HWND hwnd)
     }
 
     // Create root signature and pipeline state
-    CreateRootSignature();
-    CreatePipelineState();
+    {
+        LoadProfiler::Scope scope("CreateRootSignature");
+        CreateRootSignature();
+    }
+    {
+        LoadProfiler::Scope scope("CreatePipelineState");
+        CreatePipelineState();
+    }
 
     // Check for SM 6.8 support
     D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { D3D_SHADER_MODEL_6_8 };
@@ -325,7 +353,7 @@ ID3D12Resource* Renderer::GetCurrentBackBuffer() const
 void Renderer::CreateRootSignature()
 {
     CD3DX12_DESCRIPTOR_RANGE srvRanges[2];
-    srvRanges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 4096, 0, 0); // t0 space0: Bindless textures
+    srvRanges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, SrvHeapSize, 0, 0); // t0 space0: Bindless textures
     //srvRanges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 4096, 0, 2); // t0 space2: Bindless buffers
 
     CD3DX12_DESCRIPTOR_RANGE uavRange0;
@@ -340,7 +368,7 @@ void Renderer::CreateRootSignature()
     CD3DX12_DESCRIPTOR_RANGE uavRange3;
     uavRange3.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 3, 0); // u3 space0: Reservoir Previous
 
-    CD3DX12_ROOT_PARAMETER rootParameters[12];
+    CD3DX12_ROOT_PARAMETER rootParameters[13];
     rootParameters[0].InitAsConstantBufferView(0); // b0: FrameConstants
     rootParameters[1].InitAsConstantBufferView(1); // b1: Light constants
     rootParameters[2].InitAsShaderResourceView(0, 1); // t0 space1: Material Data
@@ -353,6 +381,7 @@ void Renderer::CreateRootSignature()
     rootParameters[9].InitAsDescriptorTable(1, &uavRange1); // u1
     rootParameters[10].InitAsDescriptorTable(1, &uavRange2); // u2
     rootParameters[11].InitAsDescriptorTable(1, &uavRange3); // u3
+    rootParameters[12].InitAsShaderResourceView(5, 1); // t5 space1: 16-bit Indices
 
     CD3DX12_STATIC_SAMPLER_DESC samplers[2];
     samplers[0].Init(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR);
@@ -481,6 +510,7 @@ void Renderer::CreatePipelineState()
 
     if (m_RayTracingSupported)
     {
+        LoadProfiler::Scope scope("CreateRayTracingPipeline");
         CreateRayTracingPipeline();
     }
 
@@ -505,9 +535,9 @@ void Renderer::CreateRayTracingPipeline()
     CHECK_HR(m_Device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&m_PathTracerPSO)), "Failed to create Path Tracer Compute PSO");
 }
 
-void Renderer::DispatchRays(Model* model, const FrameConstants& frame, const LightConstants& light)
+void Renderer::DispatchRays(Scene* scene, const FrameConstants& frame, const LightConstants& light)
 {
-    if (!m_PathTracerPSO || !model) return;
+    if (!m_PathTracerPSO || !scene || !m_TLAS.resource) return;
 
     // Update constant buffers
     memcpy(m_FrameCB.cpuPtr, &frame, sizeof(FrameConstants));
@@ -532,12 +562,12 @@ void Renderer::DispatchRays(Model* model, const FrameConstants& frame, const Lig
 
     m_CommandList->SetComputeRootConstantBufferView(0, m_FrameCB.gpuAddress);
     m_CommandList->SetComputeRootConstantBufferView(1, m_LightCB.gpuAddress);
-    m_CommandList->SetComputeRootShaderResourceView(2, model->GetMaterialBufferAddress());
-    m_CommandList->SetComputeRootShaderResourceView(3, model->GetDrawNodeBufferAddress());
+    m_CommandList->SetComputeRootShaderResourceView(2, scene->GetMaterialBufferAddress());
+    m_CommandList->SetComputeRootShaderResourceView(3, scene->GetDrawNodeBufferAddress());
     m_CommandList->SetComputeRootDescriptorTable(4, GetGPUDescriptorHandle(0)); // Bindless
     m_CommandList->SetComputeRootShaderResourceView(5, m_TLAS.gpuAddress);
-    m_CommandList->SetComputeRootShaderResourceView(6, model->GetGlobalIndexBufferAddress());
-    m_CommandList->SetComputeRootShaderResourceView(7, model->GetGlobalVertexBufferAddress());
+    m_CommandList->SetComputeRootShaderResourceView(6, scene->GetGlobalIndexBufferAddress(IndexPool_32));
+    m_CommandList->SetComputeRootShaderResourceView(7, scene->GetGlobalVertexBufferAddress());
     m_CommandList->SetComputeRootDescriptorTable(8, GetGPUDescriptorHandle(m_AccumulationBuffer.uavIndex));
     m_CommandList->SetComputeRootDescriptorTable(9, GetGPUDescriptorHandle(m_PathTracerOutput.uavIndex));
 
@@ -545,6 +575,7 @@ void Renderer::DispatchRays(Model* model, const FrameConstants& frame, const Lig
     int previousReservoir = 1 - currentReservoir;
     m_CommandList->SetComputeRootDescriptorTable(10, GetGPUDescriptorHandle(m_ReservoirBuffer[currentReservoir].uavIndex));
     m_CommandList->SetComputeRootDescriptorTable(11, GetGPUDescriptorHandle(m_ReservoirBuffer[previousReservoir].uavIndex));
+    m_CommandList->SetComputeRootShaderResourceView(12, scene->GetGlobalIndexBufferAddress(IndexPool_16));
 
     m_CommandList->Dispatch((WINDOW_WIDTH + 7) / 8, (WINDOW_HEIGHT + 7) / 8, 1);
 
@@ -568,15 +599,15 @@ void Renderer::CopyTextureToBackBuffer(const GPUTexture& texture)
     TransitionResource(m_RenderTargets[m_FrameIndex].Get(), m_BackBufferStates[m_FrameIndex], D3D12_RESOURCE_STATE_RENDER_TARGET);
 }
 
-void Renderer::BuildAccelerationStructures(Model* model)
+void Renderer::BuildAccelerationStructures(Scene* scene)
 {
-    if (!m_RayTracingSupported || !model)
+    if (!m_RayTracingSupported || !scene)
         return;
 
+    LoadProfiler::Scope profileScope("BuildAccelerationStructures");
+
     // Keep temporary buffers alive until ExecuteCommandList finishes
     GPUBuffer scratchBuffer;
-    GPUBuffer tlasScratch;
-    GPUBuffer instanceDescBuffer;
 
     // Reset command list for AS build
     m_CommandAllocator->Reset();
@@ -588,9 +619,8 @@ void Renderer::BuildAccelerationStructures(Model* model)
     Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4> cmdList4;
     CHECK_HR(m_CommandList.As(&cmdList4), "Failed to get ID3D12GraphicsCommandList4");
 
-    // 1. Identify all unique primitives and build BLAS for each
-    std::vector<const GLTFPrimitive*> modelPrims;
-    model->GetAllPrimitives(modelPrims);
+    // 1. Build a BLAS for each unique primitive that does not have one yet. Primitives of
+    // models that stay loaded keep theirs (their pool ranges never move).
 
     struct BLASBuildInfo {
         D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs;
@@ -600,37 +630,44 @@ void Renderer::BuildAccelerationStructures(Model* model)
     std::vector<GLTFPrimitive*> primsToBuild;
     UINT64 maxScratchSize = 0;
 
-    for (const auto* cp : modelPrims)
+    std::vector<const GLTFPrimitive*> modelPrims;
+    for (size_t modelIndex = 0; modelIndex < scene->GetModelCount(); ++modelIndex)
     {
-        GLTFPrimitive* prim = const_cast<GLTFPrimitive*>(cp);
-        BLASBuildInfo info = {};
-        info.geom.Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
-        info.geom.Triangles.VertexBuffer.StartAddress = model->GetGlobalVertexBufferAddress() + (prim->globalVertexOffset * sizeof(GLTFVertex));
-        info.geom.Triangles.VertexBuffer.StrideInBytes = sizeof(GLTFVertex);
-        info.geom.Triangles.VertexFormat = DXGI_FORMAT_R32G32B32_FLOAT;
-        info.geom.Triangles.VertexCount = static_cast<UINT>(prim->vertices.size());
-        info.geom.Triangles.IndexBuffer = model->GetGlobalIndexBufferAddress() + (prim->globalIndexOffset * sizeof(uint32_t));
-        info.geom.Triangles.IndexFormat = DXGI_FORMAT_R32_UINT;
-        info.geom.Triangles.IndexCount = static_cast<UINT>(prim->indices.size());
-        info.geom.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE;
-
-        info.inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
-        info.inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
-        info.inputs.NumDescs = 1;
-        info.inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
-        info.inputs.pGeometryDescs = &info.geom;
-
-        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO prebuildInfo = {};
-        device5->GetRaytracingAccelerationStructurePrebuildInfo(&info.inputs, &prebuildInfo);
-
-        maxScratchSize = (maxScratchSize > prebuildInfo.ScratchDataSizeInBytes) ? maxScratchSize : prebuildInfo.ScratchDataSizeInBytes;
-
-        GPUBuffer blasBuffer;
-        if (CreateBuffer(blasBuffer, prebuildInfo.ResultDataMaxSizeInBytes, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE))
+        const ModelPlacement& placement = scene->GetPlacement(modelIndex);
+        modelPrims.clear();
+        scene->GetModel(modelIndex)->GetAllPrimitives(modelPrims);
+        for (const auto* cp : modelPrims)
         {
-            m_BlasPool[prim] = std::move(blasBuffer);
-            buildInfos.push_back(info);
-            primsToBuild.push_back(prim);
+            if (m_BlasPool.count(cp))
+                continue;
+
+            GLTFPrimitive* prim = const_cast<GLTFPrimitive*>(cp);
+            BLASBuildInfo info = {};
+            info.geom = GetGeometryDesc(*scene, placement, *prim);
+
+            // Skinned primitives are refit in place every frame they are re-skinned
+            info.inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+            info.inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
+            if (prim->skinned)
+                info.inputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE;
+            info.inputs.NumDescs = 1;
+            info.inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+            info.inputs.pGeometryDescs = &info.geom;
+
+            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO prebuildInfo = {};
+            device5->GetRaytracingAccelerationStructurePrebuildInfo(&info.inputs, &prebuildInfo);
+
+            maxScratchSize = (maxScratchSize > prebuildInfo.ScratchDataSizeInBytes) ? maxScratchSize : prebuildInfo.ScratchDataSizeInBytes;
+            if (prim->skinned)
+                m_BlasUpdateScratchSize = (m_BlasUpdateScratchSize > prebuildInfo.UpdateScratchDataSizeInBytes) ? m_BlasUpdateScratchSize : prebuildInfo.UpdateScratchDataSizeInBytes;
+
+            GPUBuffer blasBuffer;
+            if (CreateBuffer(blasBuffer, prebuildInfo.ResultDataMaxSizeInBytes, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE))
+            {
+                m_BlasPool[prim] = std::move(blasBuffer);
+                buildInfos.push_back(info);
+                primsToBuild.push_back(prim);
+            }
         }
     }
 
@@ -652,66 +689,181 @@ void Renderer::BuildAccelerationStructures(Model* model)
         }
     }
 
-    // 2. Build TLAS for all draw node instances
-    const auto& nodeData = model->GetDrawNodeData();
-    std::vector<const GLTFPrimitive*> nodePrims;
-    model->GetDrawNodePrimitives(nodePrims);
+    // Refits of skinned BLASes share one scratch buffer that outlives this build
+    if (m_BlasUpdateScratchSize > m_BlasUpdateScratch.size)
+        CreateBuffer(m_BlasUpdateScratch, m_BlasUpdateScratchSize, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+    // 2. Build TLAS for all draw node instances of every model
+    const size_t instanceCount = BuildTopLevelAccelerationStructure(scene);
+
+    ExecuteCommandList();
+    std::cout << "Built acceleration structures for " << primsToBuild.size() << " new primitives, " << instanceCount << " instances." << std::endl;
+}
+
+size_t Renderer::BuildTopLevelAccelerationStructure(Scene* scene)
+{
+    Microsoft::WRL::ComPtr<ID3D12Device5> device5;
+    CHECK_HR(m_Device.As(&device5), "Failed to get ID3D12Device5");
+
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4> cmdList4;
+    CHECK_HR(m_CommandList.As(&cmdList4), "Failed to get ID3D12GraphicsCommandList4");
 
+    // InstanceID is the draw node's index in the scene pool, whose offsets are already rebased
+    const bool compactVertices = scene->GetVertexFormat() == VertexFormat::Compact;
     std::vector<D3D12_RAYTRACING_INSTANCE_DESC> instanceDescs;
-    for (size_t i = 0; i < nodeData.size(); ++i)
+    std::vector<const GLTFPrimitive*> nodePrims;
+    for (size_t modelIndex = 0; modelIndex < scene->GetModelCount(); ++modelIndex)
     {
-        D3D12_RAYTRACING_INSTANCE_DESC inst = {};
-        const auto& world = nodeData[i].world;
-        inst.Transform[0][0] = world._11; inst.Transform[0][1] = world._21; inst.Transform[0][2] = world._31; inst.Transform[0][3] = world._41;
-        inst.Transform[1][0] = world._12; inst.Transform[1][1] = world._22; inst.Transform[1][2] = world._32; inst.Transform[1][3] = world._42;
-        inst.Transform[2][0] = world._13; inst.Transform[2][1] = world._23; inst.Transform[2][2] = world._33; inst.Transform[2][3] = world._43;
-
-        inst.InstanceID = static_cast<UINT>(i);
-        inst.InstanceMask = 0xFF;
-        inst.InstanceContributionToHitGroupIndex = 0;
-        inst.Flags = D3D12_RAYTRACING_INSTANCE_FLAG_NONE;
-        inst.AccelerationStructure = m_BlasPool[nodePrims[i]].gpuAddress;
-        instanceDescs.push_back(inst);
+        const auto& nodeData = scene->GetModel(modelIndex)->GetDrawNodeData();
+        const uint32_t drawNodeBase = scene->GetPlacement(modelIndex).drawNodeBase;
+        nodePrims.clear();
+        scene->GetModel(modelIndex)->GetDrawNodePrimitives(nodePrims);
+        for (size_t i = 0; i < nodeData.size(); ++i)
+        {
+            D3D12_RAYTRACING_INSTANCE_DESC inst = {};
+            DirectX::XMFLOAT4X4 world = nodeData[i].world;
+            if (compactVertices)
+            {
+                // Dequantize in the instance transform: position = offset + unorm * scale
+                const auto& offset = nodeData[i].positionOffset;
+                const auto& scale = nodeData[i].positionScale;
+                DirectX::XMMATRIX dequantize = DirectX::XMMatrixScaling(scale.x, scale.y, scale.z) * DirectX::XMMatrixTranslation(offset.x, offset.y, offset.z);
+                DirectX::XMStoreFloat4x4(&world, dequantize * DirectX::XMLoadFloat4x4(&world));
+            }
+            inst.Transform[0][0] = world._11; inst.Transform[0][1] = world._21; inst.Transform[0][2] = world._31; inst.Transform[0][3] = world._41;
+            inst.Transform[1][0] = world._12; inst.Transform[1][1] = world._22; inst.Transform[1][2] = world._32; inst.Transform[1][3] = world._42;
+            inst.Transform[2][0] = world._13; inst.Transform[2][1] = world._23; inst.Transform[2][2] = world._33; inst.Transform[2][3] = world._43;
+
+            inst.InstanceID = static_cast<UINT>(drawNodeBase + i);
+            inst.InstanceMask = 0xFF;
+            inst.InstanceContributionToHitGroupIndex = 0;
+            inst.Flags = D3D12_RAYTRACING_INSTANCE_FLAG_NONE;
+            inst.AccelerationStructure = m_BlasPool[nodePrims[i]].gpuAddress;
+            instanceDescs.push_back(inst);
+        }
     }
 
-    if (!instanceDescs.empty())
+    // An empty scene traces nothing
+    if (instanceDescs.empty())
     {
-        D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS tlasInputs = {};
-        tlasInputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
-        tlasInputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
-        tlasInputs.NumDescs = static_cast<UINT>(instanceDescs.size());
-        tlasInputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+        m_TLAS = GPUBuffer();
+        return 0;
+    }
 
-        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO tlasPrebuildInfo = {};
-        device5->GetRaytracingAccelerationStructurePrebuildInfo(&tlasInputs, &tlasPrebuildInfo);
+    D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS tlasInputs = {};
+    tlasInputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
+    tlasInputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
+    tlasInputs.NumDescs = static_cast<UINT>(instanceDescs.size());
+    tlasInputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
 
+    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO tlasPrebuildInfo = {};
+    device5->GetRaytracingAccelerationStructurePrebuildInfo(&tlasInputs, &tlasPrebuildInfo);
+
+    // The buffers only grow, so per-frame rebuilds reuse them. The GPU is idle between frames,
+    // so the instance upload buffer is free to rewrite.
+    const UINT64 instanceBytes = instanceDescs.size() * sizeof(D3D12_RAYTRACING_INSTANCE_DESC);
+    if (m_TLAS.size < tlasPrebuildInfo.ResultDataMaxSizeInBytes)
         CreateBuffer(m_TLAS, tlasPrebuildInfo.ResultDataMaxSizeInBytes, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
+    if (m_TLASScratch.size < tlasPrebuildInfo.ScratchDataSizeInBytes)
+        CreateBuffer(m_TLASScratch, tlasPrebuildInfo.ScratchDataSizeInBytes, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    if (m_TLASInstances.size < instanceBytes)
+        CreateBuffer(m_TLASInstances, instanceBytes, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
+    memcpy(m_TLASInstances.cpuPtr, instanceDescs.data(), static_cast<size_t>(instanceBytes));
+
+    D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC tlasBuildDesc = {};
+    tlasBuildDesc.Inputs = tlasInputs;
+    tlasBuildDesc.Inputs.InstanceDescs = m_TLASInstances.gpuAddress;
+    tlasBuildDesc.ScratchAccelerationStructureData = m_TLASScratch.gpuAddress;
+    tlasBuildDesc.DestAccelerationStructureData = m_TLAS.gpuAddress;
+
+    cmdList4->BuildRaytracingAccelerationStructure(&tlasBuildDesc, 0, nullptr);
+    D3D12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::UAV(m_TLAS.resource.Get());
+    m_CommandList->ResourceBarrier(1, &barrier);
+    return instanceDescs.size();
+}
 
-        CreateBuffer(tlasScratch, tlasPrebuildInfo.ScratchDataSizeInBytes, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+void Renderer::UpdateSkinnedAccelerationStructures(Scene* scene, const std::vector<SkinnedPrimitive>& skinnedPrimitives)
+{
+    if (!m_RayTracingSupported || !scene || skinnedPrimitives.empty() || !m_TLAS.resource || !m_BlasUpdateScratch.resource)
+        return;
 
-        CreateBuffer(instanceDescBuffer, instanceDescs.size() * sizeof(D3D12_RAYTRACING_INSTANCE_DESC), D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
-        memcpy(instanceDescBuffer.cpuPtr, instanceDescs.data(), instanceDescs.size() * sizeof(D3D12_RAYTRACING_INSTANCE_DESC));
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList4> cmdList4;
+    CHECK_HR(m_CommandList.As(&cmdList4), "Failed to get ID3D12GraphicsCommandList4");
 
-        D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC tlasBuildDesc = {};
-        tlasBuildDesc.Inputs = tlasInputs;
-        tlasBuildDesc.Inputs.InstanceDescs = instanceDescBuffer.gpuAddress;
-        tlasBuildDesc.ScratchAccelerationStructureData = tlasScratch.gpuAddress;
-        tlasBuildDesc.DestAccelerationStructureData = m_TLAS.gpuAddress;
+    // Refit the BLASes of re-skinned primitives in place; their topology never changes
+    size_t refitCount = 0;
+    for (const SkinnedPrimitive& skinned : skinnedPrimitives)
+    {
+        auto it = m_BlasPool.find(skinned.primitive);
+        if (it == m_BlasPool.end())
+            continue;
 
-        cmdList4->BuildRaytracingAccelerationStructure(&tlasBuildDesc, 0, nullptr);
-        D3D12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::UAV(m_TLAS.resource.Get());
-        m_CommandList->ResourceBarrier(1, &barrier);
+        const D3D12_RAYTRACING_GEOMETRY_DESC geom = GetGeometryDesc(*scene, scene->GetPlacement(skinned.modelIndex), *skinned.primitive);
+        D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC refitDesc = {};
+        refitDesc.Inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+        refitDesc.Inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE |
+            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE | D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE;
+        refitDesc.Inputs.NumDescs = 1;
+        refitDesc.Inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+        refitDesc.Inputs.pGeometryDescs = &geom;
+        refitDesc.SourceAccelerationStructureData = it->second.gpuAddress;
+        refitDesc.DestAccelerationStructureData = it->second.gpuAddress;
+        refitDesc.ScratchAccelerationStructureData = m_BlasUpdateScratch.gpuAddress;
+
+        cmdList4->BuildRaytracingAccelerationStructure(&refitDesc, 0, nullptr);
+        D3D12_RESOURCE_BARRIER uavBarrier = CD3DX12_RESOURCE_BARRIER::UAV(m_BlasUpdateScratch.resource.Get());
+        m_CommandList->ResourceBarrier(1, &uavBarrier);
+        ++refitCount;
     }
 
-    ExecuteCommandList();
-    std::cout << "Built acceleration structures for " << instanceDescs.size() << " instances." << std::endl;
+    // The TLAS bounds enclose the old BLAS bounds, and picks up moved nodes on the way
+    if (refitCount > 0)
+    {
+        D3D12_RESOURCE_BARRIER blasBarrier = CD3DX12_RESOURCE_BARRIER::UAV(nullptr);
+        m_CommandList->ResourceBarrier(1, &blasBarrier);
+        BuildTopLevelAccelerationStructure(scene);
+    }
+}
+
+void Renderer::ReleaseAccelerationStructures(const Model& model)
+{
+    std::vector<const GLTFPrimitive*> modelPrims;
+    model.GetAllPrimitives(modelPrims);
+    for (const auto* prim : modelPrims)
+        m_BlasPool.erase(prim);
 }
 
 UINT Renderer::AllocateDescriptor()
 {
+    std::lock_guard<std::mutex> lock(m_DescriptorMutex);
+    if (!m_FreeDescriptors.empty())
+    {
+        const UINT index = m_FreeDescriptors.back();
+        m_FreeDescriptors.pop_back();
+        return index;
+    }
+    if (m_SrvHeapIndex >= SrvHeapSize)
+    {
+        std::cerr << "SRV descriptor heap is full (" << SrvHeapSize << " slots)" << std::endl;
+        return InvalidDescriptor;
+    }
     return m_SrvHeapIndex++;
 }
 
+void Renderer::FreeDescriptor(UINT index)
+{
+    if (index >= SrvHeapSize)
+        return;
+    std::lock_guard<std::mutex> lock(m_DescriptorMutex);
+    m_FreeDescriptors.push_back(index);
+}
+
+UINT Renderer::GetFreeDescriptorCount() const
+{
+    std::lock_guard<std::mutex> lock(m_DescriptorMutex);
+    return SrvHeapSize - m_SrvHeapIndex + static_cast<UINT>(m_FreeDescriptors.size());
+}
+
 bool Renderer::CreateBuffer(GPUBuffer& buffer, UINT64 size, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES initialState, bool createSRV)
 {
     D3D12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(heapType);
@@ -741,7 +893,10 @@ bool Renderer::CreateBuffer(GPUBuffer& buffer, UINT64 size, D3D12_HEAP_TYPE heap
 
     if (createSRV)
     {
-        buffer.srvIndex = AllocateDescriptor();
+        const UINT srvIndex = AllocateDescriptor();
+        if (srvIndex == InvalidDescriptor)
+            return false;
+        buffer.srvIndex = static_cast<int>(srvIndex);
         D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = m_SRVHeap->GetCPUDescriptorHandleForHeapStart();
         srvHandle.ptr += (UINT64)buffer.srvIndex * m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
@@ -759,7 +914,10 @@ bool Renderer::CreateBuffer(GPUBuffer& buffer, UINT64 size, D3D12_HEAP_TYPE heap
 
     if (initialState & D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
     {
-        buffer.uavIndex = AllocateDescriptor();
+        const UINT uavIndex = AllocateDescriptor();
+        if (uavIndex == InvalidDescriptor)
+            return false;
+        buffer.uavIndex = static_cast<int>(uavIndex);
         D3D12_CPU_DESCRIPTOR_HANDLE uavHandle = m_SRVHeap->GetCPUDescriptorHandleForHeapStart();
         uavHandle.ptr += (UINT64)buffer.uavIndex * m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
@@ -782,8 +940,11 @@ bool Renderer::CreateStructuredBuffer(GPUBuffer& buffer, UINT64 elementSize, UIN
     UINT64 size = elementSize * elementCount;
     if (!CreateBuffer(buffer, size, heapType, initialState, false)) return false;
 
-    buffer.srvIndex = AllocateDescriptor();
-    D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = GetCPUDescriptorHandle(buffer.srvIndex);
+    const UINT srvIndex = AllocateDescriptor();
+    if (srvIndex == InvalidDescriptor)
+        return false;
+    buffer.srvIndex = static_cast<int>(srvIndex);
+    D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = GetCPUDescriptorHandle(srvIndex);
 
     D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
     srvDesc.Format = DXGI_FORMAT_UNKNOWN;
@@ -844,28 +1005,24 @@ bool Renderer::CreateTexture(GPUTexture& texture, UINT width, UINT height, DXGI_
     // Create SRV
     if (!(flags & D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE))
     {
-        texture.srvIndex = AllocateDescriptor();
-        D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = m_SRVHeap->GetCPUDescriptorHandleForHeapStart();
-        srvHandle.ptr += (UINT64)texture.srvIndex * m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-
-        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        if (format == DXGI_FORMAT_D32_FLOAT || format == DXGI_FORMAT_R32_TYPELESS)
-            srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
-        else
-            srvDesc.Format = format;
-        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-        srvDesc.Texture2D.MipLevels = mipLevels;
-
-        m_Device->CreateShaderResourceView(texture.resource.Get(), &srvDesc, srvHandle);
+        const UINT srvIndex = AllocateDescriptor();
+        if (srvIndex == InvalidDescriptor)
+            return false;
+        CreateTextureSRV(texture, srvIndex, mipLevels);
     }
 
     // Create UAV
     if (flags & D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS)
     {
-        texture.uavIndex = AllocateDescriptor();
-        D3D12_CPU_DESCRIPTOR_HANDLE uavHandle = m_SRVHeap->GetCPUDescriptorHandleForHeapStart();
-        uavHandle.ptr += (UINT64)texture.uavIndex * m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        const UINT uavIndex = AllocateDescriptor();
+        if (uavIndex == InvalidDescriptor)
+        {
+            FreeDescriptor(texture.srvIndex);
+            texture.srvIndex = InvalidDescriptor;
+            return false;
+        }
+        texture.uavIndex = uavIndex;
+        D3D12_CPU_DESCRIPTOR_HANDLE uavHandle = GetCPUDescriptorHandle(uavIndex);
 
         D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
         uavDesc.Format = (format == DXGI_FORMAT_D32_FLOAT || format == DXGI_FORMAT_R32_TYPELESS) ? DXGI_FORMAT_R32_FLOAT : format;
@@ -900,6 +1057,23 @@ bool Renderer::CreateTexture(GPUTexture& texture, UINT width, UINT height, DXGI_
     return true;
 }
 
+void Renderer::CreateTextureSRV(GPUTexture& texture, UINT srvIndex, UINT mipLevels)
+{
+    texture.srvIndex = srvIndex;
+    D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = GetCPUDescriptorHandle(srvIndex);
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    if (texture.format == DXGI_FORMAT_D32_FLOAT || texture.format == DXGI_FORMAT_R32_TYPELESS)
+        srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    else
+        srvDesc.Format = texture.format;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = mipLevels;
+
+    m_Device->CreateShaderResourceView(texture.resource.Get(), &srvDesc, srvHandle);
+}
+
 void Renderer::TransitionResource(GPUTexture& texture, D3D12_RESOURCE_STATES newState)
 {
     if (texture.state == newState) return;
@@ -1002,6 +1176,11 @@ std::vector<char> Renderer::CompileShader(const std::string& filename, const std
     arguments.push_back(L"2021");
     arguments.push_back(L"-I");
     arguments.push_back(L"Shaders");
+    if (m_VertexFormat == VertexFormat::Compact)
+    {
+        arguments.push_back(L"-D");
+        arguments.push_back(L"COMPACT_VERTEX=1");
+    }
 
     DxcBuffer sourceBuffer;
     sourceBuffer.Ptr = sourceBlob->GetBufferPointer();
@@ -5,6 +5,8 @@
 #include <dxgi1_6.h>
 #include <wrl.h>
 #include <DirectXMath.h>
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -13,6 +15,7 @@
 // Forward declarations to avoid circular dependencies
 struct GLTFVertex;
 struct GLTFPrimitive;
+struct SkinnedPrimitive;
 
 const int WINDOW_WIDTH = 1280;
 const int WINDOW_HEIGHT = 720;
@@ -24,6 +27,10 @@ public:
     ~Renderer();
 
     bool Initialize(HWND hwnd);
+
+    // Vertex layout the shaders are compiled for; set before Initialize
+    void SetVertexFormat(VertexFormat format) { m_VertexFormat = format; }
+    VertexFormat GetVertexFormat() const { return m_VertexFormat; }
     void Shutdown();
     void Resize(uint32_t width, uint32_t height);
 
@@ -32,8 +39,14 @@ public:
     void EndFrame();
     void Present();
 
-    void BuildAccelerationStructures(class Model* model);
-    void DispatchRays(class Model* model, const FrameConstants& frame, const LightConstants& light);
+    // Builds BLASes only for primitives that have none yet; the TLAS covers every model of the scene
+    void BuildAccelerationStructures(class Scene* scene);
+    // Refit the BLASes of the primitives Scene::UpdateSkinning rewrote and rebuild the TLAS over
+    // them; does nothing when the list is empty. Records into the frame command list.
+    void UpdateSkinnedAccelerationStructures(class Scene* scene, const std::vector<SkinnedPrimitive>& skinnedPrimitives);
+    // Drop a model's BLASes before it is destroyed (they are keyed by primitive address)
+    void ReleaseAccelerationStructures(const class Model& model);
+    void DispatchRays(class Scene* scene, const FrameConstants& frame, const LightConstants& light);
     void CopyTextureToBackBuffer(const GPUTexture& texture);
 
     // Resource creation
@@ -45,13 +58,21 @@ public:
     // GBuffer management
     void CreateGBuffer();
 
-    // Descriptor management
+    // Descriptor management (thread-safe, so resources can be created on a loading thread).
+    // Allocation returns InvalidDescriptor once all SrvHeapSize slots are taken. A freed slot is
+    // reused right away, so free only what the GPU no longer reads (between frames).
+    static const UINT SrvHeapSize = 4096;
+    static const UINT InvalidDescriptor = UINT(-1);
     UINT AllocateDescriptor();
+    void FreeDescriptor(UINT index);
+    UINT GetFreeDescriptorCount() const;
 
     // Resource helpers
     bool CreateBuffer(GPUBuffer& buffer, UINT64 size, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON, bool createSRV = false);
     bool CreateStructuredBuffer(GPUBuffer& buffer, UINT64 elementSize, UINT64 elementCount, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES initialState);
     bool CreateTexture(GPUTexture& texture, UINT width, UINT height, DXGI_FORMAT format, D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES initialState, const FLOAT* clearColor = nullptr, UINT mipLevels = 1);
+    // (Re)write a 2D texture SRV at a given heap slot, e.g. one reserved by the texture streamer
+    void CreateTextureSRV(GPUTexture& texture, UINT srvIndex, UINT mipLevels);
 
     void TransitionResource(GPUTexture& texture, D3D12_RESOURCE_STATES newState);
     void TransitionResource(GPUBuffer& buffer, D3D12_RESOURCE_STATES newState);
@@ -118,6 +139,8 @@ public:
 private:
     void GetHardwareAdapter(IDXGIFactory1* pFactory, IDXGIAdapter1** ppAdapter);
     void WaitForPreviousFrame();
+    // Record a TLAS build over every draw node of the scene into m_CommandList; returns the instance count
+    size_t BuildTopLevelAccelerationStructure(class Scene* scene);
 
     // DirectX 12 objects
     Microsoft::WRL::ComPtr<ID3D12Device> m_Device;
@@ -142,11 +165,17 @@ private:
     Microsoft::WRL::ComPtr<ID3D12RootSignature> m_RootSignature;
     Microsoft::WRL::ComPtr<ID3D12CommandSignature> m_CommandSignature;
 
+    VertexFormat m_VertexFormat = VertexFormat::Full;
+
     // Ray Tracing
     bool m_RayTracingSupported = false;
     Microsoft::WRL::ComPtr<ID3D12PipelineState> m_PathTracerPSO;
     std::unordered_map<const struct GLTFPrimitive*, GPUBuffer> m_BlasPool;
     GPUBuffer m_TLAS;
+    GPUBuffer m_TLASScratch;
+    GPUBuffer m_TLASInstances;          // Upload heap, rewritten by every TLAS build
+    GPUBuffer m_BlasUpdateScratch;      // Shared by the per-frame refits of skinned BLASes
+    UINT64 m_BlasUpdateScratchSize = 0;
     GPUTexture m_PathTracerOutput;
     GPUTexture m_AccumulationBuffer;
     GPUBuffer m_ReservoirBuffer[2]; // ReSTIR Reservoirs (Current and Previous)
@@ -157,7 +186,9 @@ private:
 
     // SRV Heap for textures (Global Unified Heap)
     Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_SRVHeap;
-    UINT m_SrvHeapIndex = 0;
+    mutable std::mutex m_DescriptorMutex;
+    UINT m_SrvHeapIndex = 0;              // Slots below this were handed out at least once
+    std::vector<UINT> m_FreeDescriptors;  // Freed slots below m_SrvHeapIndex
 
     // GBuffer resources
     GBuffer m_GBuffer;
@@ -23,7 +23,7 @@ void ResourceUploadBatch::Begin()
     m_StagingBuffers.clear();
 }
 
-void ResourceUploadBatch::Upload(GPUBuffer& dest, const void* data, UINT64 size)
+void ResourceUploadBatch::Upload(GPUBuffer& dest, const void* data, UINT64 size, UINT64 destOffset)
 {
     GPUBuffer staging;
     if (!m_Renderer->CreateBuffer(staging, size, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ))
@@ -38,11 +38,17 @@ void ResourceUploadBatch::Upload(GPUBuffer& dest, const void* data, UINT64 size)
     }
     
     dest.Transition(m_CommandList.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
-    m_CommandList->CopyBufferRegion(dest.resource.Get(), 0, staging.resource.Get(), 0, size);
+    m_CommandList->CopyBufferRegion(dest.resource.Get(), destOffset, staging.resource.Get(), 0, size);
     
     m_StagingBuffers.push_back(staging);
 }
 
+void ResourceUploadBatch::Copy(GPUBuffer& dest, const GPUBuffer& source, UINT64 size, UINT64 destOffset, UINT64 sourceOffset)
+{
+    dest.Transition(m_CommandList.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+    m_CommandList->CopyBufferRegion(dest.resource.Get(), destOffset, source.resource.Get(), sourceOffset, size);
+}
+
 void ResourceUploadBatch::Transition(GPUResource& resource, D3D12_RESOURCE_STATES newState)
 {
     resource.Transition(m_CommandList.Get(), newState);
@@ -14,7 +14,9 @@ public:
     ~ResourceUploadBatch();
 
     void Begin();
-    void Upload(GPUBuffer& dest, const void* data, UINT64 size);
+    void Upload(GPUBuffer& dest, const void* data, UINT64 size, UINT64 destOffset = 0);
+    // From a buffer the caller already filled (e.g. on another thread) and keeps alive until End
+    void Copy(GPUBuffer& dest, const GPUBuffer& source, UINT64 size, UINT64 destOffset = 0, UINT64 sourceOffset = 0);
     void Transition(GPUResource& resource, D3D12_RESOURCE_STATES newState);
     
     void End();
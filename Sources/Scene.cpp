@@ -0,0 +1,536 @@
+#include "Scene.h"
+#include "Renderer.h"
+#include "JobSystem.h"
+#include "ResourceUploadBatch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+void RangeAllocator::Reset(uint32_t capacity)
+{
+    m_Free.clear();
+    if (capacity > 0)
+        m_Free.push_back({ 0, capacity });
+    m_Capacity = capacity;
+    m_Used = 0;
+}
+
+uint32_t RangeAllocator::Allocate(uint32_t count)
+{
+    if (count == 0)
+        return 0;
+
+    for (size_t i = 0; i < m_Free.size(); ++i)
+    {
+        Range& range = m_Free[i];
+        if (range.count < count)
+            continue;
+
+        const uint32_t offset = range.offset;
+        range.offset += count;
+        range.count -= count;
+        if (range.count == 0)
+            m_Free.erase(m_Free.begin() + i);
+        m_Used += count;
+        return offset;
+    }
+    return InvalidOffset;
+}
+
+void RangeAllocator::Free(uint32_t offset, uint32_t count)
+{
+    if (count == 0 || offset == InvalidOffset)
+        return;
+
+    auto next = std::lower_bound(m_Free.begin(), m_Free.end(), offset, [](const Range& range, uint32_t value) { return range.offset < value; });
+    next = m_Free.insert(next, { offset, count });
+    m_Used -= count;
+
+    // Merge with the following range, then with the preceding one
+    auto following = next + 1;
+    if (following != m_Free.end() && next->offset + next->count == following->offset)
+    {
+        next->count += following->count;
+        m_Free.erase(following);
+    }
+    if (next != m_Free.begin())
+    {
+        auto preceding = next - 1;
+        if (preceding->offset + preceding->count == next->offset)
+        {
+            preceding->count += next->count;
+            m_Free.erase(next);
+        }
+    }
+}
+
+namespace
+{
+    // 16-bit ranges start on 4-byte boundaries, like the pool of a single model
+    uint32_t GetAllocationCount(IndexPool pool, size_t count)
+    {
+        return pool == IndexPool_16 ? static_cast<uint32_t>((count + 1) & ~size_t(1)) : static_cast<uint32_t>(count);
+    }
+
+    const char* GetPoolName(ScenePool pool)
+    {
+        switch (pool)
+        {
+        case ScenePool_Vertices: return "vertex";
+        case ScenePool_Indices32: return "32-bit index";
+        case ScenePool_Indices16: return "16-bit index";
+        case ScenePool_Materials: return "material";
+        case ScenePool_DrawNodes: return "draw node";
+        default: return "unknown";
+        }
+    }
+}
+
+bool Scene::Initialize(Renderer* renderer, const ScenePoolSizes& sizes)
+{
+    m_Renderer = renderer;
+    m_VertexFormat = renderer->GetVertexFormat();
+
+    m_Allocators[ScenePool_Vertices].Reset(sizes.vertices);
+    m_Allocators[ScenePool_Indices32].Reset(sizes.indices32);
+    m_Allocators[ScenePool_Indices16].Reset(sizes.indices16 & ~1u);
+    m_Allocators[ScenePool_Materials].Reset(sizes.materials);
+    m_Allocators[ScenePool_DrawNodes].Reset(sizes.drawNodes);
+
+    if (!renderer->CreateStructuredBuffer(m_VertexBuffer, GetVertexStride(), sizes.vertices, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON))
+    {
+        std::cerr << "Failed to create scene vertex pool" << std::endl;
+        return false;
+    }
+
+    if (!renderer->CreateStructuredBuffer(m_IndexBuffers[IndexPool_32], sizeof(uint32_t), sizes.indices32, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON))
+    {
+        std::cerr << "Failed to create scene 32-bit index pool" << std::endl;
+        return false;
+    }
+
+    // Bound as an index buffer and a raw root SRV only, so no descriptor
+    if (!renderer->CreateBuffer(m_IndexBuffers[IndexPool_16], UINT64(sizes.indices16 & ~1u) * sizeof(uint16_t), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, false))
+    {
+        std::cerr << "Failed to create scene 16-bit index pool" << std::endl;
+        return false;
+    }
+
+    if (!renderer->CreateStructuredBuffer(m_MaterialBuffer, sizeof(MaterialConstants), sizes.materials, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ))
+    {
+        std::cerr << "Failed to create scene material pool" << std::endl;
+        return false;
+    }
+
+    if (!renderer->CreateStructuredBuffer(m_DrawNodeBuffer, sizeof(DrawNodeData), sizes.drawNodes, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ))
+    {
+        std::cerr << "Failed to create scene draw node pool" << std::endl;
+        return false;
+    }
+
+    // Every command draws at least one draw node, so a list never outgrows the draw node pool
+    const UINT64 cmdSize = UINT64(sizes.drawNodes) * sizeof(IndirectDrawCommand);
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
+    {
+        if (!renderer->CreateBuffer(m_OpaqueCommandBuffers[pool], cmdSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, false) ||
+            !renderer->CreateBuffer(m_TransparentCommandBuffers[pool], cmdSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, false) ||
+            !renderer->CreateBuffer(m_ShadowCommandBuffers[pool], cmdSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, false))
+        {
+            std::cerr << "Failed to create scene indirect draw buffers" << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << "Scene pools: " << sizes.vertices << " vertices, " << sizes.indices32 << " + " << sizes.indices16 << " indices, "
+        << sizes.materials << " materials, " << sizes.drawNodes << " draw nodes" << std::endl;
+    return true;
+}
+
+bool Scene::Place(Model& model, ModelPlacement& placement)
+{
+    if (!model.IsPooled() || model.GetVertexFormat() != m_VertexFormat)
+    {
+        std::cerr << "Scene models must be loaded pooled with the scene's vertex format" << std::endl;
+        return false;
+    }
+
+    const uint32_t counts[ScenePool_Count] = {
+        static_cast<uint32_t>(model.GetVertexCount()),
+        GetAllocationCount(IndexPool_32, model.GetIndexCount(IndexPool_32)),
+        GetAllocationCount(IndexPool_16, model.GetIndexCount(IndexPool_16)),
+        static_cast<uint32_t>(model.GetMaterialConstants().size()),
+        static_cast<uint32_t>(model.GetDrawNodeData().size())
+    };
+
+    uint32_t offsets[ScenePool_Count] = {};
+    {
+        std::lock_guard<std::mutex> lock(m_AllocatorMutex);
+        for (uint32_t pool = 0; pool < ScenePool_Count; ++pool)
+        {
+            offsets[pool] = m_Allocators[pool].Allocate(counts[pool]);
+            if (offsets[pool] != RangeAllocator::InvalidOffset)
+                continue;
+
+            std::cerr << "Scene " << GetPoolName(ScenePool(pool)) << " pool is full (" << counts[pool] << " requested, "
+                << m_Allocators[pool].GetCapacity() - m_Allocators[pool].GetUsed() << " free)" << std::endl;
+            for (uint32_t allocated = 0; allocated < pool; ++allocated)
+                m_Allocators[allocated].Free(offsets[allocated], counts[allocated]);
+            return false;
+        }
+    }
+
+    placement.vertexBase = offsets[ScenePool_Vertices];
+    placement.indexBase[IndexPool_32] = offsets[ScenePool_Indices32];
+    placement.indexBase[IndexPool_16] = offsets[ScenePool_Indices16];
+    placement.materialBase = offsets[ScenePool_Materials];
+    placement.drawNodeBase = offsets[ScenePool_DrawNodes];
+
+    // Only staged here: the pools' resource states belong to the frame loop, so Add copies it in
+    if (!model.StageGeometry(m_Renderer))
+    {
+        uint32_t indexCounts[IndexPool_Count] = { counts[ScenePool_Indices32], counts[ScenePool_Indices16] };
+        Release(placement, counts[ScenePool_Vertices], indexCounts, counts[ScenePool_Materials], counts[ScenePool_DrawNodes]);
+        return false;
+    }
+    WriteMaterials(model, placement);
+    return true;
+}
+
+ModelHandle Scene::Add(std::unique_ptr<Model> model, const ModelPlacement& placement)
+{
+    Entry entry;
+    entry.handle = m_NextHandle++;
+    entry.placement = placement;
+    entry.vertexCount = static_cast<uint32_t>(model->GetVertexCount());
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
+        entry.indexCounts[pool] = GetAllocationCount(IndexPool(pool), model->GetIndexCount(IndexPool(pool)));
+    entry.materialCount = static_cast<uint32_t>(model->GetMaterialConstants().size());
+    entry.drawNodeCount = static_cast<uint32_t>(model->GetDrawNodeData().size());
+    entry.loading = true;
+    entry.model = std::move(model);
+    entry.model->SetLodErrorThreshold(m_LodErrorThreshold);
+
+    // The GPU is idle between frames, so the batch only waits for these copies
+    ResourceUploadBatch batch(m_Renderer);
+    batch.Begin();
+    GPUBuffer* const indexBuffers[IndexPool_Count] = { &m_IndexBuffers[IndexPool_32], &m_IndexBuffers[IndexPool_16] };
+    entry.model->CopyGeometry(batch, m_VertexBuffer, indexBuffers, placement);
+    batch.End();
+    entry.model->ReleaseGeometryUpload();
+    entry.model->SetValidateSkinning(m_ValidateSkinning);
+
+    WriteDrawNodes(entry);
+    m_Entries.push_back(std::move(entry));
+    WriteCommands();
+    WriteShadowCommands();
+    return m_Entries.back().handle;
+}
+
+void Scene::Remove(ModelHandle handle)
+{
+    auto it = std::find_if(m_Entries.begin(), m_Entries.end(), [handle](const Entry& entry) { return entry.handle == handle; });
+    if (it == m_Entries.end())
+        return;
+
+    // The GPU is idle between frames, so the ranges and the model's textures are free to go
+    m_Renderer->ReleaseAccelerationStructures(*it->model);
+    it->model->ReleaseDescriptors(m_Renderer);
+    Release(it->placement, it->vertexCount, it->indexCounts, it->materialCount, it->drawNodeCount);
+    m_Entries.erase(it);
+    WriteCommands();
+    WriteShadowCommands();
+}
+
+void Scene::UpdateMaterials(ModelHandle handle)
+{
+    if (Entry* entry = FindEntry(handle))
+        WriteMaterials(*entry->model, entry->placement);
+}
+
+void Scene::FinishLoading(ModelHandle handle)
+{
+    if (Entry* entry = FindEntry(handle))
+        entry->loading = false;
+}
+
+size_t Scene::GetLoadedModelCount() const
+{
+    return static_cast<size_t>(std::count_if(m_Entries.begin(), m_Entries.end(), [](const Entry& entry) { return !entry.loading; }));
+}
+
+void Scene::UpdateAnimation(float deltaTime)
+{
+    // Every playing instance of every model samples on the workers; then each model blends its
+    // instances into its nodes and propagates its transforms, models in parallel too
+    auto animationStart = std::chrono::high_resolution_clock::now();
+    m_AnimationJobs.clear();
+    for (const Entry& entry : m_Entries)
+    {
+        entry.model->AdvanceAnimations(deltaTime);
+        for (size_t i = 0; i < entry.model->GetAnimationInstanceCount(); ++i)
+            m_AnimationJobs.push_back({ entry.model.get(), i });
+    }
+    JobSystem::Get().ParallelFor(m_AnimationJobs.size(), [&](size_t i)
+    {
+        m_AnimationJobs[i].model->SampleAnimation(m_AnimationJobs[i].instance);
+    });
+    JobSystem::Get().ParallelFor(m_Entries.size(), [&](size_t i)
+    {
+        m_Entries[i].model->ApplyAnimations();
+    });
+    auto animationEnd = std::chrono::high_resolution_clock::now();
+    m_AnimationMs = std::chrono::duration<float, std::milli>(animationEnd - animationStart).count();
+
+    // Only the draw nodes whose transforms changed are rewritten
+    for (const Entry& entry : m_Entries)
+    {
+        entry.model->TakeDirtyDrawNodes(m_DirtyDrawNodes);
+        for (const DrawNodeRange& range : m_DirtyDrawNodes)
+            WriteDrawNodes(entry, range.first, range.count);
+    }
+}
+
+void Scene::UpdateTextureStreaming(ID3D12GraphicsCommandList* cmdList, const DirectX::BoundingFrustum& frustum, const DirectX::XMFLOAT3& cameraPosition, float fovY, float viewportHeight)
+{
+    for (const Entry& entry : m_Entries)
+    {
+        if (!entry.loading && entry.model->UpdateTextureStreaming(cmdList, frustum, cameraPosition, fovY, viewportHeight))
+            WriteMaterials(*entry.model, entry.placement);
+    }
+}
+
+void Scene::UpdateLods(const DirectX::XMFLOAT3& cameraPosition, float fovY, float viewportHeight)
+{
+    for (const Entry& entry : m_Entries)
+        entry.model->UpdateLods(cameraPosition, fovY, viewportHeight);
+    WriteCommands();
+}
+
+void Scene::UpdateSkinning(ID3D12GraphicsCommandList* cmdList, std::vector<SkinnedPrimitive>& skinnedPrimitives)
+{
+    skinnedPrimitives.clear();
+    auto skinningStart = std::chrono::high_resolution_clock::now();
+    std::atomic<bool> skinned{ false };
+    JobSystem::Get().ParallelFor(m_Entries.size(), [&](size_t i)
+    {
+        if (!m_Entries[i].loading && m_Entries[i].model->SkinVertices())
+            skinned = true;
+    });
+    auto skinningEnd = std::chrono::high_resolution_clock::now();
+    m_SkinningMs = std::chrono::duration<float, std::milli>(skinningEnd - skinningStart).count();
+    if (!skinned)
+        return;
+
+    for (size_t i = 0; i < m_Entries.size(); ++i)
+    {
+        const Entry& entry = m_Entries[i];
+        if (entry.loading)
+            continue;
+        entry.model->CopySkinnedVertices(cmdList, m_VertexBuffer, entry.placement.vertexBase);
+        for (const GLTFPrimitive* prim : entry.model->GetSkinnedPrimitives())
+            skinnedPrimitives.push_back({ i, prim });
+    }
+    m_VertexBuffer.Transition(cmdList, D3D12_RESOURCE_STATE_GENERIC_READ);
+}
+
+void Scene::Render(ID3D12GraphicsCommandList* commandList, Renderer* renderer, AlphaMode mode)
+{
+    const bool opaque = mode == AlphaMode::Opaque || mode == AlphaMode::Mask;
+    ExecuteCommands(commandList, renderer, opaque ? m_OpaqueCommands : m_TransparentCommands, opaque ? m_OpaqueCommandBuffers : m_TransparentCommandBuffers);
+}
+
+void Scene::RenderShadowCasters(ID3D12GraphicsCommandList* commandList, Renderer* renderer)
+{
+    ExecuteCommands(commandList, renderer, m_ShadowCommands, m_ShadowCommandBuffers);
+}
+
+void Scene::ExecuteCommands(ID3D12GraphicsCommandList* commandList, Renderer* renderer, const std::vector<IndirectDrawCommand> (&commands)[IndexPool_Count], const GPUBuffer (&buffers)[IndexPool_Count])
+{
+    if (m_Entries.empty())
+        return;
+
+    // Same bindings as Model::Render, pointing at the pools
+    commandList->SetGraphicsRootShaderResourceView(2, m_MaterialBuffer.gpuAddress);
+    commandList->SetGraphicsRootShaderResourceView(3, m_DrawNodeBuffer.gpuAddress);
+    commandList->SetGraphicsRootShaderResourceView(7, m_VertexBuffer.gpuAddress);
+    commandList->IASetVertexBuffers(0, 0, nullptr);
+
+    // One ExecuteIndirect per index pool covers every model
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
+    {
+        const GPUBuffer& cmdBuffer = buffers[pool];
+        const UINT cmdCount = static_cast<UINT>(commands[pool].size());
+        if (cmdCount == 0)
+            continue;
+
+        D3D12_INDEX_BUFFER_VIEW ibv = {};
+        ibv.BufferLocation = m_IndexBuffers[pool].gpuAddress;
+        ibv.SizeInBytes = static_cast<UINT>(m_IndexBuffers[pool].size);
+        ibv.Format = GetIndexFormat(IndexPool(pool));
+        commandList->IASetIndexBuffer(&ibv);
+
+        commandList->ExecuteIndirect(renderer->GetCommandSignature(), cmdCount, cmdBuffer.resource.Get(), 0, nullptr, 0);
+    }
+}
+
+bool Scene::CullMeshlets(const DirectX::BoundingFrustum& frustum, const DirectX::XMFLOAT3& cameraPosition, MeshletCullResult& result) const
+{
+    result.indices.clear();
+    result.commands.clear();
+    result.stats = MeshletCullStats();
+
+    bool compacted = true;
+    MeshletCullResult modelResult;
+    for (const Entry& entry : m_Entries)
+    {
+        if (entry.loading)
+            continue;
+        compacted &= entry.model->CullMeshlets(frustum, cameraPosition, modelResult);
+
+        const uint32_t indexBase = static_cast<uint32_t>(result.indices.size());
+        result.indices.insert(result.indices.end(), modelResult.indices.begin(), modelResult.indices.end());
+        for (IndirectDrawCommand cmd : modelResult.commands)
+        {
+            cmd.drawArgs.StartIndexLocation += indexBase;
+            cmd.drawArgs.StartInstanceLocation += entry.placement.drawNodeBase;
+            result.commands.push_back(cmd);
+        }
+
+        MeshletCullStats& stats = result.stats;
+        stats.drawsTested += modelResult.stats.drawsTested;
+        stats.meshletsTested += modelResult.stats.meshletsTested;
+        stats.frustumCulled += modelResult.stats.frustumCulled;
+        stats.backfaceCulled += modelResult.stats.backfaceCulled;
+        stats.trianglesVisible += modelResult.stats.trianglesVisible;
+        stats.trianglesTotal += modelResult.stats.trianglesTotal;
+    }
+    return compacted;
+}
+
+void Scene::SetLodErrorThreshold(float pixels)
+{
+    m_LodErrorThreshold = pixels;
+    for (const Entry& entry : m_Entries)
+        entry.model->SetLodErrorThreshold(pixels);
+}
+
+void Scene::SetValidateSkinning(bool enabled)
+{
+    m_ValidateSkinning = enabled;
+    for (const Entry& entry : m_Entries)
+        entry.model->SetValidateSkinning(enabled);
+}
+
+size_t Scene::GetLodDrawCount(uint32_t lod) const
+{
+    size_t count = 0;
+    for (const Entry& entry : m_Entries)
+        count += entry.model->GetLodDrawCount(lod);
+    return count;
+}
+
+size_t Scene::GetDrawCount() const
+{
+    size_t count = 0;
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
+        count += m_OpaqueCommands[pool].size() + m_TransparentCommands[pool].size();
+    return count;
+}
+
+Scene::Entry* Scene::FindEntry(ModelHandle handle)
+{
+    for (Entry& entry : m_Entries)
+    {
+        if (entry.handle == handle)
+            return &entry;
+    }
+    return nullptr;
+}
+
+void Scene::Release(const ModelPlacement& placement, uint32_t vertexCount, const uint32_t (&indexCounts)[IndexPool_Count], uint32_t materialCount, uint32_t drawNodeCount)
+{
+    std::lock_guard<std::mutex> lock(m_AllocatorMutex);
+    m_Allocators[ScenePool_Vertices].Free(placement.vertexBase, vertexCount);
+    m_Allocators[ScenePool_Indices32].Free(placement.indexBase[IndexPool_32], indexCounts[IndexPool_32]);
+    m_Allocators[ScenePool_Indices16].Free(placement.indexBase[IndexPool_16], indexCounts[IndexPool_16]);
+    m_Allocators[ScenePool_Materials].Free(placement.materialBase, materialCount);
+    m_Allocators[ScenePool_DrawNodes].Free(placement.drawNodeBase, drawNodeCount);
+}
+
+void Scene::WriteDrawNodes(const Entry& entry)
+{
+    WriteDrawNodes(entry, 0, static_cast<uint32_t>(entry.model->GetDrawNodeData().size()));
+}
+
+void Scene::WriteDrawNodes(const Entry& entry, uint32_t first, uint32_t count)
+{
+    // Draw node offsets are model-local; rebase them onto the pools
+    const std::vector<DrawNodeData>& drawNodes = entry.model->GetDrawNodeData();
+    DrawNodeData* dest = static_cast<DrawNodeData*>(m_DrawNodeBuffer.cpuPtr) + entry.placement.drawNodeBase;
+    for (size_t i = first; i < size_t(first) + count; ++i)
+    {
+        DrawNodeData data = drawNodes[i];
+        data.vertexOffset += entry.placement.vertexBase;
+        data.indexOffset += entry.placement.indexBase[data.indexPool];
+        data.materialID += entry.placement.materialBase;
+        dest[i] = data;
+    }
+}
+
+void Scene::WriteMaterials(const Model& model, const ModelPlacement& placement)
+{
+    // Texture indices are global SRV heap slots, so materials copy as they are
+    const std::vector<MaterialConstants>& materials = model.GetMaterialConstants();
+    if (!materials.empty())
+        memcpy(static_cast<MaterialConstants*>(m_MaterialBuffer.cpuPtr) + placement.materialBase, materials.data(), materials.size() * sizeof(MaterialConstants));
+}
+
+void Scene::WriteCommands()
+{
+    auto merge = [this](std::vector<IndirectDrawCommand>& merged, GPUBuffer& buffer, IndexPool pool, bool opaque)
+    {
+        merged.clear();
+        for (const Entry& entry : m_Entries)
+        {
+            const std::vector<IndirectDrawCommand>& commands = opaque ? entry.model->GetOpaqueCommands(pool) : entry.model->GetTransparentCommands(pool);
+            for (IndirectDrawCommand cmd : commands)
+            {
+                cmd.drawArgs.StartIndexLocation += entry.placement.indexBase[pool];
+                cmd.drawArgs.StartInstanceLocation += entry.placement.drawNodeBase;
+                merged.push_back(cmd);
+            }
+        }
+
+        // The Renderer waits for the GPU at the end of every frame, so the buffer is idle here
+        memcpy(buffer.cpuPtr, merged.data(), merged.size() * sizeof(IndirectDrawCommand));
+    };
+
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
+    {
+        merge(m_OpaqueCommands[pool], m_OpaqueCommandBuffers[pool], IndexPool(pool), true);
+        merge(m_TransparentCommands[pool], m_TransparentCommandBuffers[pool], IndexPool(pool), false);
+    }
+}
+
+void Scene::WriteShadowCommands()
+{
+    std::vector<IndirectDrawCommand> commands;
+    for (uint32_t pool = 0; pool < IndexPool_Count; ++pool)
+    {
+        std::vector<IndirectDrawCommand>& merged = m_ShadowCommands[pool];
+        merged.clear();
+        for (const Entry& entry : m_Entries)
+        {
+            entry.model->GetFullDetailCommands(IndexPool(pool), commands);
+            for (IndirectDrawCommand cmd : commands)
+            {
+                cmd.drawArgs.StartIndexLocation += entry.placement.indexBase[pool];
+                cmd.drawArgs.StartInstanceLocation += entry.placement.drawNodeBase;
+                merged.push_back(cmd);
+            }
+        }
+        memcpy(m_ShadowCommandBuffers[pool].cpuPtr, merged.data(), merged.size() * sizeof(IndirectDrawCommand));
+    }
+}
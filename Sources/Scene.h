@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Model.h"
+
+class Renderer;
+
+// First-fit allocator of [offset, offset + count) ranges out of a fixed capacity. Freed ranges
+// merge with their neighbours; live ranges never move.
+class RangeAllocator
+{
+public:
+    static const uint32_t InvalidOffset = UINT32_MAX;
+
+    void Reset(uint32_t capacity);
+    uint32_t Allocate(uint32_t count); // InvalidOffset when no free range is large enough
+    void Free(uint32_t offset, uint32_t count);
+
+    uint32_t GetCapacity() const { return m_Capacity; }
+    uint32_t GetUsed() const { return m_Used; }
+
+private:
+    struct Range
+    {
+        uint32_t offset;
+        uint32_t count;
+    };
+    std::vector<Range> m_Free; // Sorted by offset, never adjacent
+    uint32_t m_Capacity = 0;
+    uint32_t m_Used = 0;
+};
+
+// Capacities of the shared pools, in elements. Pools never grow, so the offsets handed out stay valid.
+struct ScenePoolSizes
+{
+    uint32_t vertices = 4u << 20;
+    uint32_t indices32 = 16u << 20;
+    uint32_t indices16 = 8u << 20;
+    uint32_t materials = 4096;
+    uint32_t drawNodes = 64u << 10; // Also the capacity of each merged command list
+};
+
+enum ScenePool : uint32_t
+{
+    ScenePool_Vertices,
+    ScenePool_Indices32,
+    ScenePool_Indices16,
+    ScenePool_Materials,
+    ScenePool_DrawNodes,
+    ScenePool_Count
+};
+
+using ModelHandle = uint32_t;
+static const ModelHandle InvalidModelHandle = 0;
+
+// A primitive Scene::UpdateSkinning rewrote in the vertex pool, and the model it belongs to
+struct SkinnedPrimitive
+{
+    size_t modelIndex;
+    const GLTFPrimitive* primitive;
+};
+
+// Several glTF models sharing one set of global buffers: vertices, both index pools, materials,
+// draw node data and indirect commands. Every model gets stable sub-ranges, so loading or
+// unloading one never moves another, and a pass draws all of them with one ExecuteIndirect per
+// index pool. Models must be loaded pooled (Model::SetPooled).
+class Scene
+{
+public:
+    Scene() = default;
+
+    bool Initialize(Renderer* renderer, const ScenePoolSizes& sizes = ScenePoolSizes());
+
+    // Reserve pool ranges for a loaded model, stage its geometry and write its (untextured)
+    // materials. May run on a loading thread while frames draw the models already added; one
+    // loading thread at a time.
+    bool Place(Model& model, ModelPlacement& placement);
+
+    // Copy a placed model's geometry into the pools and start drawing it. Frame-loop thread,
+    // outside BeginFrame/EndFrame. Texture streaming, skinning and meshlet culling skip the model
+    // until FinishLoading: its loading thread still owns its textures and CPU data.
+    ModelHandle Add(std::unique_ptr<Model> model, const ModelPlacement& placement);
+    void FinishLoading(ModelHandle handle);
+
+    // Stop drawing a model, drop its acceleration structures and release its pool ranges (the
+    // model and its textures are destroyed). Frame-loop thread, outside BeginFrame/EndFrame.
+    void Remove(ModelHandle handle);
+
+    // Copy a model's materials into the pool again, e.g. once UploadTextures pointed them at textures
+    void UpdateMaterials(ModelHandle handle);
+
+    // Per frame, after BeginFrame. Samples every model's animation instances in parallel.
+    void UpdateAnimation(float deltaTime);
+    void UpdateTextureStreaming(ID3D12GraphicsCommandList* cmdList, const DirectX::BoundingFrustum& frustum, const DirectX::XMFLOAT3& cameraPosition, float fovY, float viewportHeight);
+    void UpdateLods(const DirectX::XMFLOAT3& cameraPosition, float fovY, float viewportHeight);
+    // Skin every loaded model whose joints moved (models in parallel, each across the workers
+    // too) and copy the results into the vertex pool. `skinnedPrimitives` receives the primitives
+    // rewritten, whose BLASes need a refit (empty when nothing moved).
+    void UpdateSkinning(ID3D12GraphicsCommandList* cmdList, std::vector<SkinnedPrimitive>& skinnedPrimitives);
+    void Render(ID3D12GraphicsCommandList* commandList, Renderer* renderer, AlphaMode mode = AlphaMode::Opaque);
+    // Opaque and masked draws at LOD0: the LODs UpdateLods picks for the camera do not hold from the light
+    void RenderShadowCasters(ID3D12GraphicsCommandList* commandList, Renderer* renderer);
+
+    // Model::CullMeshlets over every loaded model; commands are rebased onto the scene's draw nodes
+    bool CullMeshlets(const DirectX::BoundingFrustum& frustum, const DirectX::XMFLOAT3& cameraPosition, MeshletCullResult& result) const;
+
+    void SetLodErrorThreshold(float pixels);
+    float GetLodErrorThreshold() const { return m_LodErrorThreshold; }
+    void SetValidateSkinning(bool enabled); // Model::SetValidateSkinning on every model, including later ones
+    bool GetValidateSkinning() const { return m_ValidateSkinning; }
+    size_t GetLodDrawCount(uint32_t lod) const;
+    size_t GetDrawCount() const; // Indirect commands across both passes' lists
+    float GetSkinningMs() const { return m_SkinningMs; } // Wall time of the last UpdateSkinning's CPU work
+    float GetAnimationMs() const { return m_AnimationMs; } // Wall time of the last UpdateAnimation's sampling and blending
+
+    size_t GetModelCount() const { return m_Entries.size(); }
+    size_t GetLoadedModelCount() const; // Models past FinishLoading, which the acceleration structures cover
+    Model* GetModel(size_t index) const { return m_Entries[index].model.get(); }
+    const ModelPlacement& GetPlacement(size_t index) const { return m_Entries[index].placement; }
+    ModelHandle GetHandle(size_t index) const { return m_Entries[index].handle; }
+
+    const RangeAllocator& GetPool(ScenePool pool) const { return m_Allocators[pool]; }
+    VertexFormat GetVertexFormat() const { return m_VertexFormat; }
+    UINT GetVertexStride() const { return m_VertexFormat == VertexFormat::Compact ? sizeof(CompactVertex) : sizeof(GLTFVertex); }
+
+    D3D12_GPU_VIRTUAL_ADDRESS GetGlobalVertexBufferAddress() const { return m_VertexBuffer.gpuAddress; }
+    D3D12_GPU_VIRTUAL_ADDRESS GetGlobalIndexBufferAddress(IndexPool pool) const { return m_IndexBuffers[pool].gpuAddress; }
+    D3D12_GPU_VIRTUAL_ADDRESS GetMaterialBufferAddress() const { return m_MaterialBuffer.gpuAddress; }
+    D3D12_GPU_VIRTUAL_ADDRESS GetDrawNodeBufferAddress() const { return m_DrawNodeBuffer.gpuAddress; }
+
+    // Prevent copying
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+private:
+    struct Entry
+    {
+        ModelHandle handle;
+        std::unique_ptr<Model> model;
+        ModelPlacement placement;
+        bool loading; // Between Add and FinishLoading
+        uint32_t materialCount;
+        uint32_t drawNodeCount;
+        uint32_t indexCounts[IndexPool_Count];
+        uint32_t vertexCount;
+    };
+
+    Entry* FindEntry(ModelHandle handle);
+    void Release(const ModelPlacement& placement, uint32_t vertexCount, const uint32_t (&indexCounts)[IndexPool_Count], uint32_t materialCount, uint32_t drawNodeCount);
+    void WriteDrawNodes(const Entry& entry);
+    void WriteDrawNodes(const Entry& entry, uint32_t first, uint32_t count);
+    void WriteMaterials(const Model& model, const ModelPlacement& placement);
+    void WriteCommands();
+    void WriteShadowCommands(); // Only when models come and go: LOD0 ranges never change
+    void ExecuteCommands(ID3D12GraphicsCommandList* commandList, Renderer* renderer, const std::vector<IndirectDrawCommand> (&commands)[IndexPool_Count], const GPUBuffer (&buffers)[IndexPool_Count]);
+
+    Renderer* m_Renderer = nullptr;
+    VertexFormat m_VertexFormat = VertexFormat::Full;
+    std::vector<Entry> m_Entries;
+    ModelHandle m_NextHandle = 1;
+    float m_LodErrorThreshold = 1.0f;
+    bool m_ValidateSkinning = false;
+
+    std::mutex m_AllocatorMutex; // Place runs on a loading thread, Remove on the frame loop
+    RangeAllocator m_Allocators[ScenePool_Count];
+
+    // Geometry lives in default heaps; materials, draw nodes and commands in upload heaps that
+    // the frame loop rewrites (the GPU is idle between frames)
+    GPUBuffer m_VertexBuffer;
+    GPUBuffer m_IndexBuffers[IndexPool_Count];
+    GPUBuffer m_MaterialBuffer;
+    GPUBuffer m_DrawNodeBuffer;
+
+    // One per playing animation instance, reused by UpdateAnimation
+    struct AnimationJob
+    {
+        Model* model;
+        size_t instance;
+    };
+    std::vector<AnimationJob> m_AnimationJobs;
+    std::vector<DrawNodeRange> m_DirtyDrawNodes; // Reused by UpdateAnimation
+    float m_AnimationMs = 0.0f;
+    float m_SkinningMs = 0.0f;
+
+    // Every model's commands, rebased, one list per index pool
+    std::vector<IndirectDrawCommand> m_OpaqueCommands[IndexPool_Count];
+    GPUBuffer m_OpaqueCommandBuffers[IndexPool_Count];
+    std::vector<IndirectDrawCommand> m_TransparentCommands[IndexPool_Count];
+    GPUBuffer m_TransparentCommandBuffers[IndexPool_Count];
+    std::vector<IndirectDrawCommand> m_ShadowCommands[IndexPool_Count];
+    GPUBuffer m_ShadowCommandBuffers[IndexPool_Count];
+};
@@ -0,0 +1,291 @@
+#define NOMINMAX
+#include "SceneCache.h"
+#include "Utility.h"
+#include <windows.h>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    struct SceneCacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+        uint64_t payloadHash;
+        uint64_t fileSize;
+        struct
+        {
+            uint64_t offset;
+            uint64_t size;
+        } sections[SceneCache::Section_Count];
+    };
+
+    const uint64_t SectionAlignment = 16;
+
+    uint64_t AlignUp(uint64_t value)
+    {
+        return (value + SectionAlignment - 1) & ~(SectionAlignment - 1);
+    }
+
+    bool ReadDependencies(const uint8_t* data, uint64_t size, std::vector<std::string>& dependencies)
+    {
+        CacheReader reader(data, size);
+        uint32_t count = 0;
+        if (!reader.Read(count))
+            return false;
+
+        dependencies.resize(count);
+        for (auto& dependency : dependencies)
+        {
+            if (!reader.ReadString(dependency))
+                return false;
+        }
+        return true;
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_File = file;
+    m_Mapping = mapping;
+    m_Data = static_cast<const uint8_t*>(view);
+    m_Size = static_cast<uint64_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_Data)
+    {
+        UnmapViewOfFile(m_Data);
+        m_Data = nullptr;
+    }
+    if (m_Mapping)
+    {
+        CloseHandle(m_Mapping);
+        m_Mapping = nullptr;
+    }
+    if (m_File)
+    {
+        CloseHandle(m_File);
+        m_File = nullptr;
+    }
+    m_Size = 0;
+}
+
+bool SceneCache::HashSources(const std::string& sourceDirectory, const std::vector<std::string>& dependencies, uint64_t settingsHash, uint64_t& hash)
+{
+    const uint32_t version = Version;
+    hash = HashData(&version, sizeof(version));
+    hash = HashData(&settingsHash, sizeof(settingsHash), hash);
+    for (const auto& dependency : dependencies)
+    {
+        MappedFile file;
+        if (!file.Open(sourceDirectory + dependency))
+            return false;
+
+        hash = HashData(dependency.data(), dependency.size(), hash);
+        const uint64_t size = file.GetSize();
+        hash = HashData(&size, sizeof(size), hash);
+        hash = HashData(file.GetData(), static_cast<size_t>(size), hash);
+    }
+    return true;
+}
+
+bool SceneCache::Open(const std::string& cachePath, const std::string& sourceDirectory, uint64_t settingsHash)
+{
+    Close();
+
+    if (!m_File.Open(cachePath))
+        return false;
+
+    const uint8_t* base = m_File.GetData();
+    const uint64_t fileSize = m_File.GetSize();
+
+    SceneCacheHeader header;
+    if (fileSize < sizeof(header))
+    {
+        std::cerr << "Scene cache truncated: " << cachePath << std::endl;
+        Close();
+        return false;
+    }
+    memcpy(&header, base, sizeof(header));
+
+    if (header.magic != Magic)
+    {
+        std::cerr << "Not a scene cache file: " << cachePath << std::endl;
+        Close();
+        return false;
+    }
+
+    if (header.version != Version)
+    {
+        std::cout << "Scene cache has an old format version, rebuilding: " << cachePath << std::endl;
+        Close();
+        return false;
+    }
+
+    if (header.fileSize != fileSize)
+    {
+        std::cerr << "Scene cache size mismatch: " << cachePath << std::endl;
+        Close();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < Section_Count; ++i)
+    {
+        const auto& section = header.sections[i];
+        if (section.offset < sizeof(header) || section.offset % SectionAlignment != 0 ||
+            section.offset > fileSize || section.size > fileSize - section.offset)
+        {
+            std::cerr << "Scene cache section table corrupt: " << cachePath << std::endl;
+            Close();
+            return false;
+        }
+    }
+
+    if (HashData(base + sizeof(header), static_cast<size_t>(fileSize - sizeof(header))) != header.payloadHash)
+    {
+        std::cerr << "Scene cache payload corrupt: " << cachePath << std::endl;
+        Close();
+        return false;
+    }
+
+    std::vector<std::string> dependencies;
+    uint64_t sourceHash = 0;
+    const auto& dependencySection = header.sections[Section_Dependencies];
+    if (!ReadDependencies(base + dependencySection.offset, dependencySection.size, dependencies) ||
+        !HashSources(sourceDirectory, dependencies, settingsHash, sourceHash) || sourceHash != header.sourceHash)
+    {
+        std::cout << "Scene cache is stale (sources or import settings changed), rebuilding: " << cachePath << std::endl;
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void SceneCache::Close()
+{
+    m_File.Close();
+}
+
+const uint8_t* SceneCache::GetSection(Section section, uint64_t& size) const
+{
+    if (!IsOpen() || section >= Section_Count)
+    {
+        size = 0;
+        return nullptr;
+    }
+
+    SceneCacheHeader header;
+    memcpy(&header, m_File.GetData(), sizeof(header));
+    size = header.sections[section].size;
+    return m_File.GetData() + header.sections[section].offset;
+}
+
+bool SceneCache::Write(const std::string& cachePath, const std::string& sourceDirectory, const std::vector<std::string>& dependencies, uint64_t settingsHash, const SectionData (&sections)[Section_Count])
+{
+    SceneCacheHeader header = {};
+    header.magic = Magic;
+    header.version = Version;
+    if (!HashSources(sourceDirectory, dependencies, settingsHash, header.sourceHash))
+    {
+        std::cerr << "Scene cache not written, failed to hash sources for: " << cachePath << std::endl;
+        return false;
+    }
+
+    // The dependency list is serialized here; the caller's entry for it is ignored
+    CacheWriter dependencyWriter;
+    dependencyWriter.Write(static_cast<uint32_t>(dependencies.size()));
+    for (const auto& dependency : dependencies)
+        dependencyWriter.WriteString(dependency);
+
+    SectionData finalSections[Section_Count];
+    for (uint32_t i = 0; i < Section_Count; ++i)
+        finalSections[i] = sections[i];
+    finalSections[Section_Dependencies] = { dependencyWriter.GetData().data(), dependencyWriter.GetData().size() };
+
+    // Lay out sections, then build the payload so it can be hashed before writing
+    uint64_t offset = AlignUp(sizeof(header));
+    for (uint32_t i = 0; i < Section_Count; ++i)
+    {
+        header.sections[i].offset = offset;
+        header.sections[i].size = finalSections[i].size;
+        offset = AlignUp(offset + finalSections[i].size);
+    }
+    header.fileSize = offset;
+
+    std::vector<uint8_t> payload(static_cast<size_t>(header.fileSize - sizeof(header)), 0);
+    for (uint32_t i = 0; i < Section_Count; ++i)
+    {
+        if (finalSections[i].size > 0)
+            memcpy(payload.data() + (header.sections[i].offset - sizeof(header)), finalSections[i].data, static_cast<size_t>(finalSections[i].size));
+    }
+    header.payloadHash = HashData(payload.data(), payload.size());
+
+    // Write to a temporary file and swap it in, so a crash never leaves a half-written cache
+    const std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to create scene cache: " << tempPath << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+        if (!file.good())
+        {
+            std::cerr << "Failed to write scene cache: " << tempPath << std::endl;
+            file.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+
+    if (!MoveFileExA(tempPath.c_str(), cachePath.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        std::cerr << "Failed to replace scene cache: " << cachePath << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    std::cout << "Wrote scene cache: " << cachePath << " (" << header.fileSize << " bytes)" << std::endl;
+    return true;
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return m_Data != nullptr; }
+    const uint8_t* GetData() const { return m_Data; }
+    uint64_t GetSize() const { return m_Size; }
+
+    // Prevent copying
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+    const uint8_t* m_Data = nullptr;
+    uint64_t m_Size = 0;
+};
+
+// Append-only binary blob used to serialize cache sections
+class CacheWriter
+{
+public:
+    template<typename T>
+    void Write(const T& value)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        m_Data.insert(m_Data.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    void WriteArray(const std::vector<T>& values)
+    {
+        Write(static_cast<uint64_t>(values.size()));
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values.data());
+        m_Data.insert(m_Data.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+
+    void WriteBytes(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_Data.insert(m_Data.end(), bytes, bytes + size);
+    }
+
+    void WriteString(const std::string& value)
+    {
+        Write(static_cast<uint32_t>(value.size()));
+        m_Data.insert(m_Data.end(), value.begin(), value.end());
+    }
+
+    const std::vector<uint8_t>& GetData() const { return m_Data; }
+
+private:
+    std::vector<uint8_t> m_Data;
+};
+
+// Bounds-checked reader over a cache section. Every Read fails instead of
+// running past the end, so a truncated or corrupt section is rejected.
+class CacheReader
+{
+public:
+    CacheReader(const uint8_t* data, uint64_t size) : m_Data(data), m_Size(size) {}
+
+    template<typename T>
+    bool Read(T& value)
+    {
+        if (m_Size - m_Offset < sizeof(T))
+            return false;
+        memcpy(&value, m_Data + m_Offset, sizeof(T));
+        m_Offset += sizeof(T);
+        return true;
+    }
+
+    template<typename T>
+    bool ReadArray(std::vector<T>& values)
+    {
+        uint64_t count = 0;
+        if (!Read(count) || count > (m_Size - m_Offset) / sizeof(T))
+            return false;
+        values.resize(static_cast<size_t>(count));
+        memcpy(values.data(), m_Data + m_Offset, static_cast<size_t>(count) * sizeof(T));
+        m_Offset += count * sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string& value)
+    {
+        uint32_t length = 0;
+        if (!Read(length) || length > m_Size - m_Offset)
+            return false;
+        value.assign(reinterpret_cast<const char*>(m_Data + m_Offset), length);
+        m_Offset += length;
+        return true;
+    }
+
+private:
+    const uint8_t* m_Data;
+    uint64_t m_Size;
+    uint64_t m_Offset = 0;
+};
+
+// Cooked scene file written next to a glTF after a cold load. A warm start maps it and
+// uploads straight from the mapping instead of re-running cgltf.
+// Layout: SceneCacheHeader followed by 16-byte aligned sections.
+class SceneCache
+{
+public:
+    static const uint32_t Magic = 0x43535254; // 'TRSC'
+    static const uint32_t Version = 11;       // Bump whenever any section layout or the cooked geometry changes
+
+    enum Section : uint32_t
+    {
+        Section_Dependencies,       // Source files (relative to the glTF directory) covered by the source hash
+        Section_Meta,               // Materials, images, meshes, node hierarchy, skins, animations
+        Section_Vertices,           // GLTFVertex[]
+        Section_Indices,            // uint32_t[]
+        Section_Indices16,          // uint16_t[]
+        Section_Meshlets,           // Meshlet[]
+        Section_DrawNodes,          // DrawNodeData[]
+        Section_OpaqueCommands,     // IndirectDrawCommand[] drawing from the 32-bit index pool
+        Section_OpaqueCommands16,   // IndirectDrawCommand[] drawing from the 16-bit index pool
+        Section_TransparentCommands,// IndirectDrawCommand[] drawing from the 32-bit index pool
+        Section_TransparentCommands16, // IndirectDrawCommand[] drawing from the 16-bit index pool
+        Section_ImageData,          // Embedded image bytes
+        Section_SkinVertices,       // SkinVertex[] of skinned primitives
+        Section_Count
+    };
+
+    struct SectionData
+    {
+        const void* data = nullptr;
+        uint64_t size = 0;
+    };
+
+    SceneCache() = default;
+
+    // Map a cache file and validate version, layout, payload hash and source hash.
+    // Leaves the cache closed and returns false if it is missing, stale or corrupt.
+    // `settingsHash` covers the import settings that shape the cooked data; a cache written
+    // with different settings is stale.
+    bool Open(const std::string& cachePath, const std::string& sourceDirectory, uint64_t settingsHash);
+    void Close();
+    bool IsOpen() const { return m_File.IsOpen(); }
+    uint64_t GetFileSize() const { return m_File.GetSize(); }
+
+    const uint8_t* GetSection(Section section, uint64_t& size) const;
+
+    template<typename T>
+    const T* GetArray(Section section, size_t& count) const
+    {
+        uint64_t size = 0;
+        const uint8_t* data = GetSection(section, size);
+        count = static_cast<size_t>(size / sizeof(T));
+        return reinterpret_cast<const T*>(data);
+    }
+
+    // Hash the version, the import settings and the contents of every dependency; fails if any
+    // of them cannot be read
+    static bool HashSources(const std::string& sourceDirectory, const std::vector<std::string>& dependencies, uint64_t settingsHash, uint64_t& hash);
+
+    static bool Write(const std::string& cachePath, const std::string& sourceDirectory, const std::vector<std::string>& dependencies, uint64_t settingsHash, const SectionData (&sections)[Section_Count]);
+
+    // Prevent copying
+    SceneCache(const SceneCache&) = delete;
+    SceneCache& operator=(const SceneCache&) = delete;
+
+private:
+    MappedFile m_File;
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include "MeshProcessing.h"
+#include "AnimationCompression.h"
+
+// CPU-side glTF scene data: geometry, node tree, skins and animation channels. Nothing here
+// touches D3D12 or windows.h, so the processing modules, tests and benchmarks include this
+// instead of Model.h.
+
+// Global index pools. Primitives with at most 65536 vertices store their (primitive-local)
+// indices in the 16-bit pool; each pool has its own index buffer view and draw command lists.
+enum IndexPool : uint32_t
+{
+    IndexPool_32,
+    IndexPool_16,
+    IndexPool_Count
+};
+
+struct GLTFVertex
+{
+    float position[3];
+    float normal[3];
+    float texCoord[2];
+};
+
+// Bind pose of a skinned primitive's vertex and its first four joint influences. Joints index
+// the skin's joint list; weights sum to one.
+struct SkinVertex
+{
+    GLTFVertex bindPose;
+    uint16_t joints[4];
+    float weights[4];
+};
+
+enum class AlphaMode
+{
+    Opaque,
+    Mask,
+    Blend
+};
+
+// Index range of one LOD level in the primitive's index pool
+struct PrimitiveLod
+{
+    uint32_t globalIndexOffset;
+    uint32_t indexCount;
+    float error; // Geometric deviation from LOD0 in primitive-local units
+};
+
+struct GLTFPrimitive
+{
+    uint32_t materialIndex = 0;
+    AlphaMode alphaMode = AlphaMode::Opaque;
+    IndexPool indexPool = IndexPool_32;
+    uint32_t globalVertexOffset = 0;
+    uint32_t globalIndexOffset = 0; // In elements of indexPool
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    uint32_t firstMeshlet = 0;  // Into the model's global meshlet array
+    uint32_t meshletCount = 0;  // 0 = not split (drawn and culled as a whole)
+    PrimitiveLod lods[MaxLodCount] = {}; // lods[0] is the full-resolution range above; coarser levels follow
+    uint32_t lodCount = 1;
+    uint32_t firstDrawNode = 0; // DrawNodeData of the mesh's first instance; the other instances follow contiguously
+    bool skinned = false;         // Has JOINTS_0/WEIGHTS_0; not welded or reordered, so its vertices match the source
+    uint32_t firstSkinVertex = 0; // Into the model's skin vertices (and skinning upload buffer) when skinned
+    DirectX::BoundingBox aabb;    // Of the bind pose for skinned primitives
+};
+
+struct GLTFMesh
+{
+    std::string name;
+    std::vector<GLTFPrimitive> primitives;
+    uint32_t instanceCount = 0; // Nodes referencing this mesh
+};
+
+struct GLTFSkin;
+
+struct GLTFNode
+{
+    std::string name;
+    GLTFMesh* mesh = nullptr;
+    GLTFSkin* skin = nullptr;
+    std::vector<GLTFNode*> children;
+    DirectX::XMFLOAT4X4 transform;
+    GLTFNode* parent = nullptr;
+    // TRS for animation
+    DirectX::XMFLOAT3 translation = {0.0f, 0.0f, 0.0f};
+    DirectX::XMFLOAT4 rotation = {0.0f, 0.0f, 0.0f, 1.0f};
+    DirectX::XMFLOAT3 scale = {1.0f, 1.0f, 1.0f};
+    uint32_t meshInstance = 0; // Position among the nodes referencing the same mesh
+    uint32_t hierarchyIndex = 0; // Position in NodeHierarchy, where its world matrix and AABB live
+};
+
+struct GLTFSkin
+{
+    std::string name;
+    std::vector<GLTFNode*> joints;
+    std::vector<DirectX::XMFLOAT4X4> inverseBindMatrices; // One per joint (identity when the file has none)
+};
+
+// DrawNodeData record of one node's primitive
+inline uint32_t GetDrawNodeIndex(const GLTFNode& node, uint32_t primitive)
+{
+    return node.mesh->primitives[primitive].firstDrawNode + node.meshInstance;
+}
+
+struct GLTFAnimationChannel
+{
+    enum Type { Translation, Rotation, Scale, TypeCount };
+    Type type = Translation;
+    GLTFNode* targetNode = nullptr;
+    std::vector<float> times;
+    std::vector<DirectX::XMFLOAT3> translations; // for translation
+    std::vector<DirectX::XMFLOAT4> rotations; // for rotation
+    std::vector<DirectX::XMFLOAT3> scales; // for scale
+    CompressedKeys compressedKeys; // Replaces the value arrays above once compressed
+};
+
+struct GLTFAnimation
+{
+    std::string name;
+    std::vector<GLTFAnimationChannel> channels;
+    float duration = 0.0f; // Last key time over all channels, set at load
+
+    // Also set at load, for batched sampling: the sampleable channels of each type, and every
+    // node they target, once
+    std::vector<uint32_t> typeChannels[GLTFAnimationChannel::TypeCount];
+    std::vector<GLTFNode*> targetNodes;
+};
+
+// Samples of one channel type in SoA lanes (one float per channel and component), padded to a
+// multiple of four channels so they are interpolated four at a time
+struct AnimationSampleLanes
+{
+    std::vector<float> from[4]; // Key before the sample time; holds the result after interpolation
+    std::vector<float> to[4];   // Key after it
+    std::vector<float> factor;
+};
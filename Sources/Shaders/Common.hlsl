@@ -50,17 +50,69 @@ struct MaterialConstants {
     int baseColorTextureIndex;
     int normalTextureIndex;
     int metallicRoughnessTextureIndex;
-    uint padding[1];
+    uint flags;
 };
 
+#define MATERIAL_FLAG_PACKED_METALLIC_ROUGHNESS 1 // Cooked BC5: roughness/metallic in RG instead of GB
+
+// Returns (roughness, metallic) from a metallic-roughness texture sample
+float2 UnpackMetallicRoughness(float4 mrSample, uint flags)
+{
+    return (flags & MATERIAL_FLAG_PACKED_METALLIC_ROUGHNESS) ? mrSample.rg : mrSample.gb;
+}
+
+#define INDEX_POOL_32 0
+#define INDEX_POOL_16 1 // Primitives with at most 65536 vertices (see IndexPool in Model.h)
+
 struct DrawNodeData {
     row_major float4x4 world;
     uint vertexOffset;
     uint indexOffset;
     uint materialID;
-    uint padding;
+    uint indexPool;        // INDEX_POOL_* that indexOffset points into
+    float4 positionOffset; // Compact vertices: primitive AABB min
+    float4 positionScale;  // Compact vertices: primitive AABB size
+};
+
+// 16-byte vertex for VertexFormat::Compact (see VertexCompression.h)
+struct CompactVertex {
+    uint2 position; // unorm16 xyz inside the primitive AABB, w unused
+    uint normal;    // Octahedral, snorm16 xy
+    uint texCoord;  // Half floats
 };
 
+float SNorm16ToFloat(uint bits)
+{
+    return max(float(int(bits << 16) >> 16) / 32767.0f, -1.0f);
+}
+
+float3 DecodeOctahedral(float2 e)
+{
+    float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += select(n.xy >= 0.0f, -t.xx, t.xx);
+    return normalize(n);
+}
+
+GLTFVertex DecodeCompactVertex(CompactVertex v, DrawNodeData drawData)
+{
+    GLTFVertex result;
+    float3 q = float3(v.position.x & 0xFFFF, v.position.x >> 16, v.position.y & 0xFFFF) / 65535.0f;
+    result.position = drawData.positionOffset.xyz + q * drawData.positionScale.xyz;
+    result.normal = DecodeOctahedral(float2(SNorm16ToFloat(v.normal & 0xFFFF), SNorm16ToFloat(v.normal >> 16)));
+    result.texCoord = float2(f16tof32(v.texCoord), f16tof32(v.texCoord >> 16));
+    return result;
+}
+
+// Vertex pulling reads VertexData; the renderer defines COMPACT_VERTEX for VertexFormat::Compact
+#ifdef COMPACT_VERTEX
+typedef CompactVertex VertexData;
+GLTFVertex DecodeVertex(VertexData v, DrawNodeData drawData) { return DecodeCompactVertex(v, drawData); }
+#else
+typedef GLTFVertex VertexData;
+GLTFVertex DecodeVertex(VertexData v, DrawNodeData drawData) { return v; }
+#endif
+
 struct Reservoir {
     float3 hitPos;     // Position of the indirect light hit
     float3 hitNormal;  // Normal at the hit point
@@ -6,11 +6,11 @@ struct PSInput {
 
 ConstantBuffer<FrameConstants> FrameCB : register(b0);
 StructuredBuffer<DrawNodeData> DrawNodeBuffer : register(t1, space1);
-StructuredBuffer<GLTFVertex> GlobalVertexBuffer : register(t4, space1);
+StructuredBuffer<VertexData> GlobalVertexBuffer : register(t4, space1);
 
-PSInput VSMain(uint instanceID : SV_StartInstanceLocation, uint vertexID : SV_VertexID) {
-    DrawNodeData drawData = DrawNodeBuffer[instanceID];
-    GLTFVertex v = GlobalVertexBuffer[drawData.vertexOffset + vertexID];
+PSInput VSMain(uint startInstance : SV_StartInstanceLocation, uint instanceID : SV_InstanceID, uint vertexID : SV_VertexID) {
+    DrawNodeData drawData = DrawNodeBuffer[startInstance + instanceID]; // Instances of a draw have contiguous node data
+    GLTFVertex v = DecodeVertex(GlobalVertexBuffer[drawData.vertexOffset + vertexID], drawData);
 
     PSInput output;
     float4 worldPos = mul(float4(v.position, 1.0f), drawData.world);
@@ -12,15 +12,15 @@ ConstantBuffer<FrameConstants> FrameCB : register(b0);
 
 StructuredBuffer<MaterialConstants> MaterialBuffer : register(t0, space1);
 StructuredBuffer<DrawNodeData> DrawNodeBuffer : register(t1, space1);
-StructuredBuffer<GLTFVertex> GlobalVertexBuffer : register(t4, space1);
+StructuredBuffer<VertexData> GlobalVertexBuffer : register(t4, space1);
 
 Texture2D textures[] : register(t0);
 SamplerState pointSampler : register(s0);
 
-PSInput VSMain(uint instanceID : SV_StartInstanceLocation, uint vertexID: SV_VertexID)
+PSInput VSMain(uint startInstance : SV_StartInstanceLocation, uint instanceID : SV_InstanceID, uint vertexID: SV_VertexID)
 {
-    DrawNodeData drawData = DrawNodeBuffer[instanceID];
-    GLTFVertex v = GlobalVertexBuffer[drawData.vertexOffset + vertexID];
+    DrawNodeData drawData = DrawNodeBuffer[startInstance + instanceID]; // Instances of a draw have contiguous node data
+    GLTFVertex v = DecodeVertex(GlobalVertexBuffer[drawData.vertexOffset + vertexID], drawData);
 
     PSInput output;
     float4 worldPos = mul(float4(v.position, 1.0f), drawData.world);
@@ -61,8 +61,9 @@ GBufferOutput PSMain(PSInput input) {
     
     if (material.metallicRoughnessTextureIndex >= 0) {
         float4 mrSample = textures[material.metallicRoughnessTextureIndex].Sample(pointSampler, input.texCoord);
-        roughness *= mrSample.g;
-        metallic *= mrSample.b;
+        float2 rm = UnpackMetallicRoughness(mrSample, material.flags);
+        roughness *= rm.x;
+        metallic *= rm.y;
     }
     
     output.material = float4(roughness, metallic, 0.0f, 1.0f);
@@ -7,8 +7,9 @@ RWTexture2D<float4> g_Output : register(u1);
 RaytracingAccelerationStructure g_Scene : register(t2, space1);
 StructuredBuffer<DrawNodeData> g_DrawNodeBuffer : register(t1, space1);
 StructuredBuffer<MaterialConstants> g_Materials : register(t0, space1);
-StructuredBuffer<GLTFVertex> g_GlobalVertices : register(t4, space1);
+StructuredBuffer<VertexData> g_GlobalVertices : register(t4, space1);
 StructuredBuffer<uint> g_GlobalIndices : register(t3, space1);
+ByteAddressBuffer g_GlobalIndices16 : register(t5, space1);
 ByteAddressBuffer g_Buffers[] : register(t0, space2);
 Texture2D g_Textures[] : register(t0, space0);
 
@@ -20,6 +21,15 @@ ConstantBuffer<LightConstants> g_Light : register(b1);
 
 SamplerState g_LinearSampler : register(s0);
 
+uint LoadIndex(DrawNodeData nodeData, uint index) {
+    uint element = nodeData.indexOffset + index;
+    if (nodeData.indexPool == INDEX_POOL_16) {
+        uint pair = g_GlobalIndices16.Load((element * 2) & ~3u);
+        return (element & 1) ? (pair >> 16) : (pair & 0xFFFF);
+    }
+    return g_GlobalIndices[element];
+}
+
 float Luminance(float3 c) {
     return dot(c, float3(0.2126f, 0.7152f, 0.0722f));
 }
@@ -160,13 +170,13 @@ void CSMain(uint3 dispatchThreadID : SV_DispatchThreadID)
             MaterialConstants mat = g_Materials[nodeData.materialID];
 
             // Fetch vertices and interpolate
-            uint i0 = g_GlobalIndices[nodeData.indexOffset + triIdx * 3 + 0];
-            uint i1 = g_GlobalIndices[nodeData.indexOffset + triIdx * 3 + 1];
-            uint i2 = g_GlobalIndices[nodeData.indexOffset + triIdx * 3 + 2];
+            uint i0 = LoadIndex(nodeData, triIdx * 3 + 0);
+            uint i1 = LoadIndex(nodeData, triIdx * 3 + 1);
+            uint i2 = LoadIndex(nodeData, triIdx * 3 + 2);
 
-            GLTFVertex v0 = g_GlobalVertices[nodeData.vertexOffset + i0];
-            GLTFVertex v1 = g_GlobalVertices[nodeData.vertexOffset + i1];
-            GLTFVertex v2 = g_GlobalVertices[nodeData.vertexOffset + i2];
+            GLTFVertex v0 = DecodeVertex(g_GlobalVertices[nodeData.vertexOffset + i0], nodeData);
+            GLTFVertex v1 = DecodeVertex(g_GlobalVertices[nodeData.vertexOffset + i1], nodeData);
+            GLTFVertex v2 = DecodeVertex(g_GlobalVertices[nodeData.vertexOffset + i2], nodeData);
 
             // Reconstruct attributes
             float3 worldNormal = normalize(mul(v0.normal * (1.0f - barys.x - barys.y) + v1.normal * barys.x + v2.normal * barys.y, (float3x3)nodeData.world));
@@ -183,8 +193,9 @@ void CSMain(uint3 dispatchThreadID : SV_DispatchThreadID)
 
             if (mat.metallicRoughnessTextureIndex >= 0) {
                 float4 mrSample = g_Textures[mat.metallicRoughnessTextureIndex].SampleLevel(g_LinearSampler, uv, 0);
-                roughness *= mrSample.g;
-                metallic *= mrSample.b;
+                float2 rm = UnpackMetallicRoughness(mrSample, mat.flags);
+                roughness *= rm.x;
+                metallic *= rm.y;
             }
             
             // Roughness Regularization: Increase minimum roughness for indirect bounces
@@ -0,0 +1,54 @@
+#include "Skinning.h"
+#include "SceneTypes.h"
+#include <algorithm>
+#include <cmath>
+
+void SkinVertexRange(const SkinVertex* vertices, size_t count, const DirectX::XMFLOAT4X4* palette, GLTFVertex* result)
+{
+    using namespace DirectX;
+    for (size_t k = 0; k < count; ++k)
+    {
+        const SkinVertex& vertex = vertices[k];
+        XMMATRIX blend = XMLoadFloat4x4(&palette[vertex.joints[0]]);
+        const XMVECTOR firstWeight = XMVectorReplicate(vertex.weights[0]);
+        for (uint32_t r = 0; r < 4; ++r)
+            blend.r[r] = XMVectorMultiply(blend.r[r], firstWeight);
+        for (uint32_t i = 1; i < 4; ++i)
+        {
+            if (vertex.weights[i] == 0.0f)
+                continue;
+            const XMMATRIX joint = XMLoadFloat4x4(&palette[vertex.joints[i]]);
+            const XMVECTOR weight = XMVectorReplicate(vertex.weights[i]);
+            for (uint32_t r = 0; r < 4; ++r)
+                blend.r[r] = XMVectorMultiplyAdd(joint.r[r], weight, blend.r[r]);
+        }
+
+        GLTFVertex& out = result[k];
+        const XMVECTOR position = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(vertex.bindPose.position));
+        const XMVECTOR normal = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(vertex.bindPose.normal));
+        XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(out.position), XMVector3Transform(position, blend));
+        XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(out.normal), XMVector3Normalize(XMVector3TransformNormal(normal, blend)));
+        out.texCoord[0] = vertex.bindPose.texCoord[0];
+        out.texCoord[1] = vertex.bindPose.texCoord[1];
+    }
+}
+
+float CompareSkinnedVertices(const SkinVertex* vertices, size_t count, const DirectX::XMFLOAT4X4* palette, const GLTFVertex* result)
+{
+    float maxError = 0.0f;
+    for (size_t k = 0; k < count; ++k)
+    {
+        const SkinVertex& vertex = vertices[k];
+        const float* p = vertex.bindPose.position;
+        float expected[3] = { 0.0f, 0.0f, 0.0f };
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            const DirectX::XMFLOAT4X4& m = palette[vertex.joints[i]];
+            for (uint32_t c = 0; c < 3; ++c)
+                expected[c] += vertex.weights[i] * (p[0] * m.m[0][c] + p[1] * m.m[1][c] + p[2] * m.m[2][c] + m.m[3][c]);
+        }
+        for (uint32_t c = 0; c < 3; ++c)
+            maxError = std::max(maxError, std::abs(expected[c] - result[k].position[c]));
+    }
+    return maxError;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <DirectXMath.h>
+
+struct GLTFVertex;
+struct SkinVertex;
+
+// Linear blend skinning: the weighted joint matrices are summed row by row, then transform
+// the position and the normal once
+void SkinVertexRange(const SkinVertex* vertices, size_t count, const DirectX::XMFLOAT4X4* palette, GLTFVertex* result);
+
+// Scalar reference for SkinVertexRange: each influence transforms the position on its own
+// and the results are blended. Returns the largest position difference from `result`.
+float CompareSkinnedVertices(const SkinVertex* vertices, size_t count, const DirectX::XMFLOAT4X4* palette, const GLTFVertex* result);
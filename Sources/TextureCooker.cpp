@@ -0,0 +1,166 @@
+#include "TextureCooker.h"
+#include "Utility.h"
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    std::wstring ToWide(const std::string& path)
+    {
+        return std::wstring(path.begin(), path.end());
+    }
+
+    // Move roughness (G) and metallic (B) into RG so BC5 keeps both at full precision
+    void PackMetallicRoughness(DirectX::ScratchImage& image)
+    {
+        uint8_t* pixels = image.GetPixels();
+        const size_t pixelCount = image.GetPixelsSize() / 4;
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            uint8_t* p = pixels + i * 4;
+            p[0] = p[1];
+            p[1] = p[2];
+            p[2] = 0;
+            p[3] = 255;
+        }
+    }
+}
+
+TextureCooker::TextureCooker(const std::string& cacheDirectory)
+    : m_CacheDirectory(cacheDirectory)
+{
+    if (!m_CacheDirectory.empty() && m_CacheDirectory.back() != '/' && m_CacheDirectory.back() != '\\')
+        m_CacheDirectory += '/';
+
+    std::error_code error;
+    std::filesystem::create_directories(m_CacheDirectory, error);
+    if (error)
+        std::cerr << "Failed to create texture cache directory: " << m_CacheDirectory << std::endl;
+}
+
+std::string TextureCooker::GetCachePath(const void* sourceData, size_t sourceSize, TextureUsage usage) const
+{
+    const uint32_t key[2] = { Version, static_cast<uint32_t>(usage) };
+    uint64_t hash = HashData(key, sizeof(key));
+    hash = HashData(sourceData, sourceSize, hash);
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.dds", static_cast<unsigned long long>(hash));
+    return m_CacheDirectory + name;
+}
+
+bool TextureCooker::Load(const void* sourceData, size_t sourceSize, TextureUsage usage, DirectX::ScratchImage& result) const
+{
+    const std::string cachePath = GetCachePath(sourceData, sourceSize, usage);
+    if (SUCCEEDED(DirectX::LoadFromDDSFile(ToWide(cachePath).c_str(), DirectX::DDS_FLAGS_NONE, nullptr, result)))
+        return true;
+
+    if (!Cook(sourceData, sourceSize, usage, result))
+        return false;
+
+    WriteCooked(result, cachePath); // The cooked image is usable even if caching it failed
+    return true;
+}
+
+bool TextureCooker::Prepare(const void* sourceData, size_t sourceSize, TextureUsage usage, std::string& cookedPath) const
+{
+    cookedPath = GetCachePath(sourceData, sourceSize, usage);
+
+    std::error_code error;
+    if (std::filesystem::exists(cookedPath, error))
+        return true;
+
+    DirectX::ScratchImage cooked;
+    return Cook(sourceData, sourceSize, usage, cooked) && WriteCooked(cooked, cookedPath);
+}
+
+bool TextureCooker::WriteCooked(const DirectX::ScratchImage& image, const std::string& cachePath) const
+{
+    // Write under a per-thread name and swap it in, so concurrent cooks of identical
+    // images never read a half-written file
+    const std::string tempPath = cachePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    if (FAILED(DirectX::SaveToDDSFile(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::DDS_FLAGS_NONE, ToWide(tempPath).c_str())))
+    {
+        std::cerr << "Failed to write cooked texture: " << tempPath << std::endl;
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error)
+    {
+        // Another thread may have won the race for the same entry
+        std::filesystem::remove(tempPath, error);
+        return std::filesystem::exists(cachePath, error);
+    }
+    return true;
+}
+
+bool TextureCooker::Cook(const void* sourceData, size_t sourceSize, TextureUsage usage, DirectX::ScratchImage& result)
+{
+    // Normal and metallic-roughness data is linear; never let WIC tag it as sRGB
+    const DirectX::WIC_FLAGS wicFlags = usage == TextureUsage::Color ? DirectX::WIC_FLAGS_NONE : DirectX::WIC_FLAGS_IGNORE_SRGB;
+
+    DirectX::ScratchImage decoded;
+    HRESULT hr = DirectX::LoadFromWICMemory(sourceData, sourceSize, wicFlags, nullptr, decoded);
+    if (FAILED(hr))
+    {
+        std::cerr << "Load image failed (HRESULT: 0x" << std::hex << hr << std::dec << ")" << std::endl;
+        return false;
+    }
+
+    // Channel-packed data is processed as plain RGBA8
+    if (usage != TextureUsage::Color && decoded.GetMetadata().format != DXGI_FORMAT_R8G8B8A8_UNORM)
+    {
+        DirectX::ScratchImage converted;
+        hr = DirectX::Convert(decoded.GetImages(), decoded.GetImageCount(), decoded.GetMetadata(), DXGI_FORMAT_R8G8B8A8_UNORM, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, converted);
+        if (FAILED(hr))
+        {
+            std::cerr << "Convert image to RGBA8 failed (HRESULT: 0x" << std::hex << hr << std::dec << ")" << std::endl;
+            return false;
+        }
+        decoded = std::move(converted);
+    }
+
+    const DirectX::TexMetadata sourceMeta = decoded.GetMetadata();
+    const bool compressible = (sourceMeta.width % 4 == 0) && (sourceMeta.height % 4 == 0);
+
+    if (usage == TextureUsage::MetallicRoughness && compressible)
+        PackMetallicRoughness(decoded);
+
+    DirectX::ScratchImage mipChain;
+    hr = DirectX::GenerateMipMaps(*decoded.GetImage(0, 0, 0), DirectX::TEX_FILTER_DEFAULT, 0, mipChain);
+    if (FAILED(hr))
+    {
+        std::cerr << "Generate mip chain failed (HRESULT: 0x" << std::hex << hr << std::dec << ")" << std::endl;
+        return false;
+    }
+    decoded.Release();
+
+    if (!compressible)
+    {
+        result = std::move(mipChain);
+        return true;
+    }
+
+    DXGI_FORMAT format = DXGI_FORMAT_BC5_UNORM;
+    if (usage == TextureUsage::Color)
+        format = DirectX::IsSRGB(sourceMeta.format) ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+
+    hr = DirectX::Compress(mipChain.GetImages(), mipChain.GetImageCount(), mipChain.GetMetadata(), format,
+        DirectX::TEX_COMPRESS_BC7_QUICK, DirectX::TEX_THRESHOLD_DEFAULT, result);
+    if (FAILED(hr))
+    {
+        std::cerr << "Block compression failed (HRESULT: 0x" << std::hex << hr << std::dec << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TextureCooker::IsPackedMetallicRoughness(DXGI_FORMAT format)
+{
+    return format == DXGI_FORMAT_BC5_UNORM;
+}
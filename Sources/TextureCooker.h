@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <DirectXTex.h>
+
+// How a texture is sampled, which decides its block-compressed format
+enum class TextureUsage : uint32_t
+{
+    Color,              // BC7, keeps the source sRGB-ness (also used for images shared between slots)
+    Normal,             // BC5, tangent-space XY only
+    MetallicRoughness   // BC5 with roughness (G) and metallic (B) packed into RG
+};
+
+// Converts source images (PNG/JPEG/...) into mipmapped, block-compressed DDS files and keeps
+// them in a content-hashed cache directory, so only the first load pays for compression.
+class TextureCooker
+{
+public:
+    static const uint32_t Version = 1; // Bump whenever the cooked output changes
+
+    explicit TextureCooker(const std::string& cacheDirectory);
+
+    // Load the cooked texture for an encoded source image, cooking and caching it on a miss.
+    // Thread-safe; every call works on its own cache entry.
+    bool Load(const void* sourceData, size_t sourceSize, TextureUsage usage, DirectX::ScratchImage& result) const;
+
+    // Make sure the cooked DDS for a source image exists on disk and return its path, for
+    // readers that only want part of it (mip streaming). Thread-safe like Load.
+    bool Prepare(const void* sourceData, size_t sourceSize, TextureUsage usage, std::string& cookedPath) const;
+
+    // Decode, generate mips and compress. Falls back to uncompressed mips when the top level
+    // is not a multiple of the 4x4 block size.
+    static bool Cook(const void* sourceData, size_t sourceSize, TextureUsage usage, DirectX::ScratchImage& result);
+
+    // True if a cooked MetallicRoughness texture stores roughness/metallic in RG instead of GB
+    static bool IsPackedMetallicRoughness(DXGI_FORMAT format);
+
+private:
+    std::string GetCachePath(const void* sourceData, size_t sourceSize, TextureUsage usage) const;
+    bool WriteCooked(const DirectX::ScratchImage& image, const std::string& cachePath) const;
+
+    std::string m_CacheDirectory;
+};
@@ -0,0 +1,431 @@
+#include "TextureStreamer.h"
+#include "JobSystem.h"
+#include "Renderer.h"
+#include "SceneCache.h"
+#include "Utility.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const uint32_t DDSMagic = 0x20534444;          // 'DDS '
+    const uint32_t DDSFourCCDX10 = 0x30315844;     // 'DX10'
+    const uint32_t DDSPixelFormatFourCC = 0x4;     // DDPF_FOURCC
+    const size_t DDSHeaderSize = 4 + 124;          // Magic + DDS_HEADER
+    const size_t DDSHeaderDX10Size = 20;
+    const size_t DDSPixelFormatFlagsOffset = 4 + 76;
+    const size_t DDSPixelFormatFourCCOffset = 4 + 80;
+
+    uint32_t GetMipDimension(uint32_t size, uint32_t mip)
+    {
+        return std::max(1u, size >> mip);
+    }
+
+    // Block-compressed resources need a top level that is a whole number of 4x4 blocks
+    bool IsValidTopMip(uint32_t width, uint32_t height, DXGI_FORMAT format, uint32_t mip)
+    {
+        if (!DirectX::IsCompressed(format))
+            return true;
+        return (width >> mip) % 4 == 0 && (height >> mip) % 4 == 0 && (width >> mip) > 0 && (height >> mip) > 0;
+    }
+
+    // Bytes of levels [firstMip, lastMip] in tightly packed (DDS) layout
+    size_t GetMipBytes(uint32_t width, uint32_t height, DXGI_FORMAT format, uint32_t firstMip, uint32_t lastMip)
+    {
+        size_t bytes = 0;
+        for (uint32_t mip = firstMip; mip <= lastMip; ++mip)
+        {
+            size_t rowPitch = 0;
+            size_t slicePitch = 0;
+            if (SUCCEEDED(DirectX::ComputePitch(format, GetMipDimension(width, mip), GetMipDimension(height, mip), rowPitch, slicePitch)))
+                bytes += slicePitch;
+        }
+        return bytes;
+    }
+
+    // Random access to the mips of a cooked DDS through a file mapping, so reading one
+    // level only touches that level's pages. Accepts the single 2D textures TextureCooker writes.
+    class DDSMipReader
+    {
+    public:
+        bool Open(const std::string& path)
+        {
+            if (!m_File.Open(path) || m_File.GetSize() < DDSHeaderSize)
+                return false;
+
+            const uint8_t* data = m_File.GetData();
+            uint32_t magic = 0;
+            memcpy(&magic, data, sizeof(magic));
+            if (magic != DDSMagic)
+                return false;
+
+            if (FAILED(DirectX::GetMetadataFromDDSMemory(data, static_cast<size_t>(m_File.GetSize()), DirectX::DDS_FLAGS_NONE, m_Metadata)) ||
+                m_Metadata.dimension != DirectX::TEX_DIMENSION_TEXTURE2D || m_Metadata.arraySize != 1 || m_Metadata.depth != 1)
+                return false;
+
+            uint32_t pixelFormatFlags = 0;
+            uint32_t fourCC = 0;
+            memcpy(&pixelFormatFlags, data + DDSPixelFormatFlagsOffset, sizeof(pixelFormatFlags));
+            memcpy(&fourCC, data + DDSPixelFormatFourCCOffset, sizeof(fourCC));
+            const bool hasDX10Header = (pixelFormatFlags & DDSPixelFormatFourCC) && fourCC == DDSFourCCDX10;
+
+            // Levels are stored back to back after the headers
+            const uint32_t width = static_cast<uint32_t>(m_Metadata.width);
+            const uint32_t height = static_cast<uint32_t>(m_Metadata.height);
+            m_MipOffsets.resize(m_Metadata.mipLevels + 1);
+            m_MipOffsets[0] = DDSHeaderSize + (hasDX10Header ? DDSHeaderDX10Size : 0);
+            for (uint32_t mip = 0; mip < m_Metadata.mipLevels; ++mip)
+                m_MipOffsets[mip + 1] = m_MipOffsets[mip] + GetMipBytes(width, height, m_Metadata.format, mip, mip);
+
+            return m_MipOffsets.back() <= m_File.GetSize();
+        }
+
+        const DirectX::TexMetadata& GetMetadata() const { return m_Metadata; }
+
+        // Copy levels [firstMip, lastMip] into a new mip chain
+        bool ReadMips(uint32_t firstMip, uint32_t lastMip, DirectX::ScratchImage& result) const
+        {
+            if (firstMip > lastMip || lastMip >= m_Metadata.mipLevels)
+                return false;
+
+            const uint32_t width = static_cast<uint32_t>(m_Metadata.width);
+            const uint32_t height = static_cast<uint32_t>(m_Metadata.height);
+            if (FAILED(result.Initialize2D(m_Metadata.format, GetMipDimension(width, firstMip), GetMipDimension(height, firstMip), 1, lastMip - firstMip + 1)))
+                return false;
+
+            for (uint32_t mip = firstMip; mip <= lastMip; ++mip)
+            {
+                const DirectX::Image* image = result.GetImage(mip - firstMip, 0, 0);
+                const size_t size = m_MipOffsets[mip + 1] - m_MipOffsets[mip];
+                if (!image || image->slicePitch != size)
+                    return false;
+                memcpy(image->pixels, m_File.GetData() + m_MipOffsets[mip], size);
+            }
+            return true;
+        }
+
+    private:
+        MappedFile m_File;
+        DirectX::TexMetadata m_Metadata = {};
+        std::vector<size_t> m_MipOffsets;
+    };
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    // Workers write into m_CompletedReads; wait for the ones still running
+    std::unique_lock<std::mutex> lock(m_ReadMutex);
+    m_ReadCondition.wait(lock, [this]() { return m_RunningReads == 0; });
+}
+
+bool TextureStreamer::LoadTail(const std::string& path, DirectX::TexMetadata& fullMetadata, DirectX::ScratchImage& tail, uint32_t& tailMip)
+{
+    DDSMipReader reader;
+    if (!reader.Open(path))
+        return false;
+
+    fullMetadata = reader.GetMetadata();
+    const uint32_t width = static_cast<uint32_t>(fullMetadata.width);
+    const uint32_t height = static_cast<uint32_t>(fullMetadata.height);
+    const uint32_t mipCount = static_cast<uint32_t>(fullMetadata.mipLevels);
+
+    // Smallest valid top level that still fits in TailSize (or the smallest valid one)
+    tailMip = 0;
+    for (uint32_t mip = 0; mip < mipCount; ++mip)
+    {
+        if (!IsValidTopMip(width, height, fullMetadata.format, mip))
+            continue;
+        tailMip = mip;
+        if (std::max(GetMipDimension(width, mip), GetMipDimension(height, mip)) <= TailSize)
+            break;
+    }
+
+    return reader.ReadMips(tailMip, mipCount - 1, tail);
+}
+
+void TextureStreamer::Initialize(Renderer* renderer)
+{
+    m_Renderer = renderer;
+}
+
+uint32_t TextureStreamer::Add(const std::string& path, const DirectX::TexMetadata& fullMetadata, uint32_t tailMip, GPUTexture&& tailTexture)
+{
+    const UINT secondSlot = m_Renderer->AllocateDescriptor();
+    if (secondSlot == Renderer::InvalidDescriptor)
+    {
+        std::cerr << "No descriptor left to stream, keeping the mip tail only: " << path << std::endl;
+        return InvalidHandle;
+    }
+
+    StreamedTexture entry;
+    entry.path = path;
+    entry.texture = std::move(tailTexture);
+    entry.texture.state = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    entry.srvSlots[0] = entry.texture.srvIndex;
+    entry.srvSlots[1] = secondSlot;
+    entry.width = static_cast<uint32_t>(fullMetadata.width);
+    entry.height = static_cast<uint32_t>(fullMetadata.height);
+    entry.mipCount = static_cast<uint32_t>(fullMetadata.mipLevels);
+    entry.format = fullMetadata.format;
+    entry.tailMip = tailMip;
+    entry.residentMip = tailMip;
+    entry.wantedMip = tailMip;
+    entry.residentBytes = GetMipBytes(entry.width, entry.height, entry.format, tailMip, entry.mipCount - 1);
+
+    m_ResidentBytes += entry.residentBytes;
+    m_Textures.push_back(std::move(entry));
+    return static_cast<uint32_t>(m_Textures.size() - 1);
+}
+
+void TextureStreamer::ReleaseDescriptors()
+{
+    for (StreamedTexture& entry : m_Textures)
+    {
+        for (UINT& slot : entry.srvSlots)
+        {
+            m_Renderer->FreeDescriptor(slot);
+            slot = Renderer::InvalidDescriptor;
+        }
+        entry.texture.srvIndex = Renderer::InvalidDescriptor;
+    }
+}
+
+void TextureStreamer::Request(uint32_t handle, float projectedSize)
+{
+    StreamedTexture& entry = m_Textures[handle];
+    entry.priority = std::max(entry.priority, projectedSize);
+}
+
+uint32_t TextureStreamer::ComputeWantedMip(const StreamedTexture& entry) const
+{
+    if (entry.priority <= 0.0f)
+        return entry.tailMip;
+
+    // About one texel per covered pixel
+    const float texels = static_cast<float>(std::max(entry.width, entry.height));
+    const float mip = std::floor(std::log2(std::max(texels / entry.priority, 1.0f)));
+    uint32_t wanted = std::min(static_cast<uint32_t>(mip), entry.tailMip);
+
+    // Round to the next finer level a resource can start at
+    while (wanted > 0 && !IsValidTopMip(entry.width, entry.height, entry.format, wanted))
+        --wanted;
+    return wanted;
+}
+
+void TextureStreamer::QueueRead(uint32_t handle, uint32_t firstMip)
+{
+    StreamedTexture& entry = m_Textures[handle];
+    const uint32_t lastMip = entry.residentMip - 1;
+    entry.readPending = true;
+    m_BytesInFlight += GetMipBytes(entry.width, entry.height, entry.format, firstMip, lastMip);
+
+    {
+        std::lock_guard<std::mutex> lock(m_ReadMutex);
+        ++m_RunningReads;
+    }
+
+    JobSystem::Get().Submit([this, handle, firstMip, lastMip, path = entry.path]()
+    {
+        MipRead read;
+        read.handle = handle;
+        read.firstMip = firstMip;
+        DDSMipReader reader;
+        read.succeeded = reader.Open(path) && reader.ReadMips(firstMip, lastMip, read.mips);
+        {
+            std::lock_guard<std::mutex> lock(m_ReadMutex);
+            m_CompletedReads.push_back(std::move(read));
+            --m_RunningReads;
+        }
+        m_ReadCondition.notify_all();
+    });
+}
+
+bool TextureStreamer::Rebuild(ID3D12GraphicsCommandList* cmdList, StreamedTexture& entry, uint32_t newMip, const DirectX::ScratchImage* newMips)
+{
+    ID3D12Device* device = m_Renderer->GetDevice();
+    const uint32_t mipLevels = entry.mipCount - newMip;
+
+    D3D12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(entry.format, GetMipDimension(entry.width, newMip), GetMipDimension(entry.height, newMip), 1, static_cast<UINT16>(mipLevels));
+    D3D12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+
+    GPUTexture texture;
+    texture.format = entry.format;
+    texture.state = D3D12_RESOURCE_STATE_COPY_DEST;
+    if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc, texture.state, nullptr, IID_PPV_ARGS(&texture.resource))))
+    {
+        std::cerr << "Failed to create streamed texture: " << entry.path << std::endl;
+        return false;
+    }
+
+    // Keep the levels both resources share
+    entry.texture.Transition(cmdList, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    for (uint32_t mip = std::max(newMip, entry.residentMip); mip < entry.mipCount; ++mip)
+    {
+        CD3DX12_TEXTURE_COPY_LOCATION dst(texture.resource.Get(), mip - newMip);
+        CD3DX12_TEXTURE_COPY_LOCATION src(entry.texture.resource.Get(), mip - entry.residentMip);
+        cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+    }
+
+    // Upload the levels that were just read
+    if (newMips && newMip < entry.residentMip)
+    {
+        const UINT count = entry.residentMip - newMip;
+        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(count);
+        std::vector<UINT> numRows(count);
+        std::vector<UINT64> rowSizes(count);
+        UINT64 uploadSize = 0;
+        device->GetCopyableFootprints(&desc, 0, count, 0, layouts.data(), numRows.data(), rowSizes.data(), &uploadSize);
+
+        Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer;
+        D3D12_HEAP_PROPERTIES uploadHeapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+        D3D12_RESOURCE_DESC uploadDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadSize);
+        if (FAILED(device->CreateCommittedResource(&uploadHeapProps, D3D12_HEAP_FLAG_NONE, &uploadDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&uploadBuffer))))
+        {
+            std::cerr << "Failed to create streaming upload buffer: " << entry.path << std::endl;
+            entry.texture.Transition(cmdList, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+            return false;
+        }
+
+        uint8_t* uploadMem = nullptr;
+        uploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&uploadMem));
+        for (UINT i = 0; i < count; ++i)
+        {
+            const DirectX::Image* image = newMips->GetImage(i, 0, 0);
+            uint8_t* dst = uploadMem + layouts[i].Offset;
+            const uint8_t* src = image->pixels;
+            for (UINT y = 0; y < numRows[i]; ++y)
+            {
+                memcpy(dst, src, static_cast<size_t>(rowSizes[i]));
+                dst += layouts[i].Footprint.RowPitch;
+                src += image->rowPitch;
+            }
+
+            CD3DX12_TEXTURE_COPY_LOCATION dstLocation(texture.resource.Get(), i);
+            CD3DX12_TEXTURE_COPY_LOCATION srcLocation(uploadBuffer.Get(), layouts[i]);
+            cmdList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+        }
+        uploadBuffer->Unmap(0, nullptr);
+
+        m_Retired.push_back(uploadBuffer);
+        m_UploadedBytes += static_cast<size_t>(uploadSize);
+    }
+
+    texture.Transition(cmdList, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+    // Swap in the new resource behind the other SRV slot; the old one may still be bound by
+    // commands recorded earlier this frame, so it is only released next Update
+    m_Retired.push_back(entry.texture.resource);
+    entry.activeSlot ^= 1;
+    entry.texture.resource = texture.resource;
+    entry.texture.state = texture.state;
+    m_Renderer->CreateTextureSRV(entry.texture, entry.srvSlots[entry.activeSlot], mipLevels);
+
+    const size_t residentBytes = GetMipBytes(entry.width, entry.height, entry.format, newMip, entry.mipCount - 1);
+    m_ResidentBytes = m_ResidentBytes - entry.residentBytes + residentBytes;
+    entry.residentBytes = residentBytes;
+    entry.residentMip = newMip;
+    return true;
+}
+
+bool TextureStreamer::Update(ID3D12GraphicsCommandList* cmdList)
+{
+    m_Retired.clear();
+    m_UploadedBytes = 0;
+    bool changed = false;
+
+    for (auto& entry : m_Textures)
+        entry.wantedMip = ComputeWantedMip(entry);
+
+    // Upload finished reads until the frame budget is spent; the last one may overshoot it,
+    // so a level larger than the budget still arrives
+    while (m_UploadedBytes < m_UploadBudget)
+    {
+        MipRead read;
+        {
+            std::lock_guard<std::mutex> lock(m_ReadMutex);
+            if (m_CompletedReads.empty())
+                break;
+            read = std::move(m_CompletedReads.front());
+            m_CompletedReads.pop_front();
+        }
+
+        StreamedTexture& entry = m_Textures[read.handle];
+        entry.readPending = false;
+        m_BytesInFlight -= GetMipBytes(entry.width, entry.height, entry.format, read.firstMip, entry.residentMip - 1);
+
+        if (!read.succeeded)
+        {
+            // Leave the texture at its current level rather than retrying every frame
+            std::cerr << "Failed to read streamed mips: " << entry.path << std::endl;
+            entry.tailMip = entry.residentMip;
+            continue;
+        }
+        changed |= Rebuild(cmdList, entry, read.firstMip, &read.mips);
+    }
+
+    // Over the residency budget: drop levels nobody wants any more, least visible first
+    std::vector<uint32_t> candidates;
+    if (m_ResidentBytes > m_ResidentBudget)
+    {
+        for (uint32_t i = 0; i < m_Textures.size(); ++i)
+        {
+            if (!m_Textures[i].readPending && m_Textures[i].residentMip < m_Textures[i].wantedMip)
+                candidates.push_back(i);
+        }
+        std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) { return m_Textures[a].priority < m_Textures[b].priority; });
+
+        for (uint32_t handle : candidates)
+        {
+            if (m_ResidentBytes <= m_ResidentBudget)
+                break;
+            changed |= Rebuild(cmdList, m_Textures[handle], m_Textures[handle].wantedMip, nullptr);
+        }
+    }
+
+    // Queue the next finer level of the most visible textures that want more
+    candidates.clear();
+    for (uint32_t i = 0; i < m_Textures.size(); ++i)
+    {
+        if (!m_Textures[i].readPending && m_Textures[i].wantedMip < m_Textures[i].residentMip)
+            candidates.push_back(i);
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) { return m_Textures[a].priority > m_Textures[b].priority; });
+
+    for (uint32_t handle : candidates)
+    {
+        const StreamedTexture& entry = m_Textures[handle];
+        uint32_t nextMip = entry.residentMip - 1;
+        while (nextMip > entry.wantedMip && !IsValidTopMip(entry.width, entry.height, entry.format, nextMip))
+            --nextMip;
+
+        // Keep at most two frames of uploads in flight, and stay inside the residency budget
+        const size_t bytes = GetMipBytes(entry.width, entry.height, entry.format, nextMip, entry.residentMip - 1);
+        if (m_BytesInFlight > 0 && m_BytesInFlight + bytes > m_UploadBudget * 2)
+            break;
+        if (m_ResidentBytes + m_BytesInFlight + bytes > m_ResidentBudget)
+            continue;
+
+        QueueRead(handle, nextMip);
+    }
+
+    for (auto& entry : m_Textures)
+        entry.priority = 0.0f;
+
+    return changed;
+}
+
+TextureStreamingStats TextureStreamer::GetStats() const
+{
+    TextureStreamingStats stats;
+    stats.textureCount = m_Textures.size();
+    stats.residentBytes = m_ResidentBytes;
+    stats.uploadedBytes = m_UploadedBytes;
+    for (const auto& entry : m_Textures)
+    {
+        if (entry.residentMip == 0)
+            ++stats.fullyResidentCount;
+        if (entry.readPending)
+            ++stats.pendingReads;
+    }
+    return stats;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <d3d12.h>
+#include <wrl.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <DirectXTex.h>
+#include "GraphicsTypes.h"
+
+class Renderer;
+
+struct TextureStreamingStats
+{
+    size_t textureCount = 0;        // Streamed textures
+    size_t fullyResidentCount = 0;  // Textures with every mip resident
+    size_t pendingReads = 0;        // Mip reads queued or running on the workers
+    size_t residentBytes = 0;       // GPU bytes held by streamed textures
+    size_t uploadedBytes = 0;       // Bytes uploaded last frame
+};
+
+// Streams the mips of cooked DDS textures on demand. Every texture starts with only its
+// mip tail resident; finer mips are read on the JobSystem and uploaded within a per-frame
+// budget, highest projected screen size first. A texture that gains (or loses) mips is
+// rebuilt as a new resource and its SRV is written to the second of two heap slots it owns,
+// so the caller switches its material texture index instead of touching a live descriptor.
+class TextureStreamer
+{
+public:
+    static const uint32_t TailSize = 64; // Largest mip dimension kept resident from the start
+
+    TextureStreamer() = default;
+    ~TextureStreamer();
+
+    // Read the mip tail of a cooked DDS into `tail`. Thread-safe.
+    // `fullMetadata` describes the whole file; `tailMip` is the tail's first level in it.
+    static bool LoadTail(const std::string& path, DirectX::TexMetadata& fullMetadata, DirectX::ScratchImage& tail, uint32_t& tailMip);
+
+    void Initialize(Renderer* renderer);
+
+    static const uint32_t InvalidHandle = UINT32_MAX;
+
+    // Take over a texture holding the mip tail of `path` (uploaded and in PIXEL_SHADER_RESOURCE).
+    // Returns the handle used by the calls below, or InvalidHandle (leaving the texture with the
+    // caller) when the heap has no slot left for the second SRV.
+    uint32_t Add(const std::string& path, const DirectX::TexMetadata& fullMetadata, uint32_t tailMip, GPUTexture&& tailTexture);
+
+    // Return both SRV slots of every texture to the Renderer. The GPU must be done with them.
+    void ReleaseDescriptors();
+
+    UINT GetSRVIndex(uint32_t handle) const { return m_Textures[handle].texture.srvIndex; }
+    DXGI_FORMAT GetFormat(uint32_t handle) const { return m_Textures[handle].format; }
+
+    // Report that the texture covers `projectedSize` pixels this frame. The largest report since
+    // the last Update decides the wanted mip and the streaming priority.
+    void Request(uint32_t handle, float projectedSize);
+
+    // Retire what the previous frame replaced, record uploads and trims for this frame into
+    // `cmdList`, and queue new mip reads. Returns true if any SRV index changed.
+    bool Update(ID3D12GraphicsCommandList* cmdList);
+
+    void SetUploadBudget(size_t bytesPerFrame) { m_UploadBudget = bytesPerFrame; }
+    void SetResidentBudget(size_t bytes) { m_ResidentBudget = bytes; }
+    TextureStreamingStats GetStats() const;
+
+    // Prevent copying
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+private:
+    struct StreamedTexture
+    {
+        std::string path;
+        GPUTexture texture;
+        UINT srvSlots[2] = {};
+        uint32_t activeSlot = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipCount = 0;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        uint32_t tailMip = 0;
+        uint32_t residentMip = 0;   // Finest level in `texture`
+        uint32_t wantedMip = 0;
+        float priority = 0.0f;      // Largest projected size requested this frame
+        bool readPending = false;
+        size_t residentBytes = 0;
+    };
+
+    // Mips read by a worker, waiting to be uploaded
+    struct MipRead
+    {
+        uint32_t handle;
+        uint32_t firstMip;
+        bool succeeded;
+        DirectX::ScratchImage mips;
+    };
+
+    uint32_t ComputeWantedMip(const StreamedTexture& entry) const;
+    bool Rebuild(ID3D12GraphicsCommandList* cmdList, StreamedTexture& entry, uint32_t newMip, const DirectX::ScratchImage* newMips);
+    void QueueRead(uint32_t handle, uint32_t firstMip);
+
+    Renderer* m_Renderer = nullptr;
+    std::vector<StreamedTexture> m_Textures;
+    size_t m_UploadBudget = 16ull * 1024 * 1024;
+    size_t m_ResidentBudget = 512ull * 1024 * 1024;
+    size_t m_ResidentBytes = 0;
+    size_t m_UploadedBytes = 0;
+
+    // Resources replaced last frame; the Renderer waits for the GPU in EndFrame, so they are idle by the next Update
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_Retired;
+
+    std::deque<MipRead> m_CompletedReads;
+    std::mutex m_ReadMutex;
+    std::condition_variable m_ReadCondition;
+    size_t m_RunningReads = 0;
+    size_t m_BytesInFlight = 0; // Estimated bytes of queued, running and completed reads
+};
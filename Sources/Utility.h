@@ -14,4 +14,27 @@
     if (!(condition)) { \
         std::cerr << "Application Error: " << msg << std::endl; \
         assert(false); \
-    }
\ No newline at end of file
+    }
+
+#include <cstdint>
+#include <cstring>
+
+// 64-bit FNV-1a style hash, folded a word at a time so multi-megabyte buffers hash quickly.
+// Used for content keys and corruption checks, not for security.
+inline uint64_t HashData(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+{
+    const uint64_t prime = 0x100000001b3ull;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * prime;
+    }
+    return hash;
+}
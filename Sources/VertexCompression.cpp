@@ -0,0 +1,191 @@
+#include "VertexCompression.h"
+#include "SceneTypes.h"
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    const float UNorm16Max = 65535.0f;
+    const float SNorm16Max = 32767.0f;
+    const float HalfMax = 65504.0f;
+
+    float SignNotZero(float value)
+    {
+        return value >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    void Normalize(float v[3])
+    {
+        const float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        if (length > 0.0f)
+        {
+            v[0] /= length;
+            v[1] /= length;
+            v[2] /= length;
+        }
+    }
+
+    float Dot(const float a[3], const float b[3])
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    float AngleBetween(const float a[3], const float b[3])
+    {
+        // atan2 stays accurate for the tiny angles quantization produces, unlike acos
+        const float cross[3] = {
+            a[1] * b[2] - a[2] * b[1],
+            a[2] * b[0] - a[0] * b[2],
+            a[0] * b[1] - a[1] * b[0]
+        };
+        return std::atan2(std::sqrt(Dot(cross, cross)), Dot(a, b));
+    }
+
+    int16_t ToSNorm16(float value)
+    {
+        return static_cast<int16_t>(std::clamp(value, -1.0f, 1.0f) * SNorm16Max);
+    }
+}
+
+float VertexErrorBounds::Position(float offset, float scale)
+{
+    return scale * (0.5f / UNorm16Max) + (std::fabs(offset) + scale) * 4.0f * FLT_EPSILON;
+}
+
+void VertexErrorStats::Merge(const VertexErrorStats& other)
+{
+    position = std::max(position, other.position);
+    normalAngle = std::max(normalAngle, other.normalAngle);
+    texCoord = std::max(texCoord, other.texCoord);
+    violations += other.violations;
+}
+
+void EncodeOctahedral(const float normal[3], int16_t encoded[2])
+{
+    // Project onto the octahedron, folding the lower hemisphere over the diagonals
+    const float l1 = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+    if (l1 <= 0.0f)
+    {
+        encoded[0] = 0;
+        encoded[1] = 0;
+        return;
+    }
+
+    float u = normal[0] / l1;
+    float v = normal[1] / l1;
+    if (normal[2] < 0.0f)
+    {
+        const float foldedU = (1.0f - std::fabs(v)) * SignNotZero(u);
+        const float foldedV = (1.0f - std::fabs(u)) * SignNotZero(v);
+        u = foldedU;
+        v = foldedV;
+    }
+
+    // Plain rounding can land on a worse neighbour; keep whichever of the four decodes closest
+    float unit[3] = { normal[0], normal[1], normal[2] };
+    Normalize(unit);
+
+    const float baseU = std::floor(std::clamp(u, -1.0f, 1.0f) * SNorm16Max);
+    const float baseV = std::floor(std::clamp(v, -1.0f, 1.0f) * SNorm16Max);
+    float bestDot = -2.0f;
+    for (int i = 0; i < 4; ++i)
+    {
+        const int16_t candidate[2] = {
+            ToSNorm16((baseU + float(i & 1)) / SNorm16Max),
+            ToSNorm16((baseV + float(i >> 1)) / SNorm16Max)
+        };
+        float decoded[3];
+        DecodeOctahedral(candidate, decoded);
+        const float dot = Dot(decoded, unit);
+        if (dot > bestDot)
+        {
+            bestDot = dot;
+            encoded[0] = candidate[0];
+            encoded[1] = candidate[1];
+        }
+    }
+}
+
+void DecodeOctahedral(const int16_t encoded[2], float normal[3])
+{
+    normal[0] = std::max(encoded[0] / SNorm16Max, -1.0f);
+    normal[1] = std::max(encoded[1] / SNorm16Max, -1.0f);
+    normal[2] = 1.0f - std::fabs(normal[0]) - std::fabs(normal[1]);
+
+    // Unfold the lower hemisphere
+    const float t = std::max(-normal[2], 0.0f);
+    normal[0] += normal[0] >= 0.0f ? -t : t;
+    normal[1] += normal[1] >= 0.0f ? -t : t;
+    Normalize(normal);
+}
+
+CompactVertex EncodeCompactVertex(const float position[3], const float normal[3], const float texCoord[2], const PositionQuantization& quantization)
+{
+    CompactVertex vertex = {};
+    for (int i = 0; i < 3; ++i)
+    {
+        const float scale = quantization.scale[i];
+        const float t = scale > 0.0f ? std::clamp((position[i] - quantization.offset[i]) / scale, 0.0f, 1.0f) : 0.0f;
+        vertex.position[i] = static_cast<uint16_t>(t * UNorm16Max + 0.5f);
+    }
+
+    EncodeOctahedral(normal, vertex.normal);
+
+    for (int i = 0; i < 2; ++i)
+        vertex.texCoord[i] = DirectX::PackedVector::XMConvertFloatToHalf(std::clamp(texCoord[i], -HalfMax, HalfMax));
+    return vertex;
+}
+
+void DecodeCompactVertex(const CompactVertex& vertex, const PositionQuantization& quantization, float position[3], float normal[3], float texCoord[2])
+{
+    for (int i = 0; i < 3; ++i)
+        position[i] = quantization.offset[i] + (vertex.position[i] / UNorm16Max) * quantization.scale[i];
+
+    DecodeOctahedral(vertex.normal, normal);
+
+    for (int i = 0; i < 2; ++i)
+        texCoord[i] = DirectX::PackedVector::XMConvertHalfToFloat(vertex.texCoord[i]);
+}
+
+void EncodeCompactVertices(const GLTFVertex* vertices, size_t count, const PositionQuantization& quantization, CompactVertex* result, VertexErrorStats& stats)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const GLTFVertex& source = vertices[i];
+        result[i] = EncodeCompactVertex(source.position, source.normal, source.texCoord, quantization);
+
+        float position[3];
+        float normal[3];
+        float texCoord[2];
+        DecodeCompactVertex(result[i], quantization, position, normal, texCoord);
+
+        bool violated = false;
+        for (int k = 0; k < 3; ++k)
+        {
+            const float error = std::fabs(position[k] - source.position[k]);
+            stats.position = std::max(stats.position, error);
+            violated |= error > VertexErrorBounds::Position(quantization.offset[k], quantization.scale[k]);
+        }
+
+        float sourceNormal[3] = { source.normal[0], source.normal[1], source.normal[2] };
+        Normalize(sourceNormal);
+        if (Dot(sourceNormal, sourceNormal) > 0.0f)
+        {
+            const float angle = AngleBetween(sourceNormal, normal);
+            stats.normalAngle = std::max(stats.normalAngle, angle);
+            violated |= angle > VertexErrorBounds::NormalAngle;
+        }
+
+        for (int k = 0; k < 2; ++k)
+        {
+            const float error = std::fabs(texCoord[k] - source.texCoord[k]);
+            stats.texCoord = std::max(stats.texCoord, error);
+            violated |= error > std::fabs(source.texCoord[k]) * VertexErrorBounds::TexCoordRelative + VertexErrorBounds::TexCoordAbsolute;
+        }
+
+        if (violated)
+            ++stats.violations;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct GLTFVertex;
+
+// 16-byte vertex used with VertexFormat::Compact. Matches CompactVertex in Common.hlsl.
+struct CompactVertex
+{
+    uint16_t position[4]; // unorm16 xyz inside the primitive AABB; w is unused so the BLAS can read RGBA16_UNORM
+    int16_t normal[2];    // Octahedral, snorm16
+    uint16_t texCoord[2]; // Half floats
+};
+static_assert(sizeof(CompactVertex) == 16, "CompactVertex must stay 16 bytes");
+
+// Maps the primitive AABB [offset, offset + scale] onto the unorm16 position range
+struct PositionQuantization
+{
+    float offset[3];
+    float scale[3];
+};
+
+// Worst-case round-trip errors of the compact layout
+struct VertexErrorBounds
+{
+    static constexpr float NormalAngle = 0.0002f;      // Radians, 16-bit octahedral with nearest-of-four rounding
+    static constexpr float TexCoordRelative = 1.0f / 2048.0f; // Half float: 11 significant bits
+    static constexpr float TexCoordAbsolute = 1.0f / 16777216.0f; // Half subnormal spacing (2^-24)
+
+    // Half a quantization step of the AABB, plus float rounding of offset + t * scale
+    static float Position(float offset, float scale);
+};
+
+// Largest error seen over a set of round trips, in the units of VertexErrorBounds
+struct VertexErrorStats
+{
+    float position = 0.0f;  // Largest absolute position error
+    float normalAngle = 0.0f;
+    float texCoord = 0.0f;  // Largest absolute UV error
+    uint32_t violations = 0; // Round trips outside VertexErrorBounds
+
+    void Merge(const VertexErrorStats& other);
+};
+
+void EncodeOctahedral(const float normal[3], int16_t encoded[2]);
+void DecodeOctahedral(const int16_t encoded[2], float normal[3]);
+
+CompactVertex EncodeCompactVertex(const float position[3], const float normal[3], const float texCoord[2], const PositionQuantization& quantization);
+void DecodeCompactVertex(const CompactVertex& vertex, const PositionQuantization& quantization, float position[3], float normal[3], float texCoord[2]);
+
+// Encode `count` vertices and measure each round trip against VertexErrorBounds
+void EncodeCompactVertices(const GLTFVertex* vertices, size_t count, const PositionQuantization& quantization, CompactVertex* result, VertexErrorStats& stats);
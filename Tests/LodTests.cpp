@@ -0,0 +1,206 @@
+// Builds LODs of known height-field meshes and checks their triangle counts and their error
+// against a deviation measured here, independently of the simplifier's own estimate
+#include "MeshProcessing.h"
+#include "SceneTypes.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++g_Failures;
+        }
+    }
+
+    struct Vec3
+    {
+        float x, y, z;
+    };
+
+    Vec3 operator+(Vec3 a, Vec3 b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+    Vec3 operator-(Vec3 a, Vec3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    Vec3 operator*(Vec3 a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+    float Dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    float Length(Vec3 a) { return std::sqrt(Dot(a, a)); }
+
+    // Closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5)
+    Vec3 ClosestPointOnTriangle(Vec3 p, Vec3 a, Vec3 b, Vec3 c)
+    {
+        const Vec3 ab = b - a, ac = c - a, ap = p - a;
+        const float d1 = Dot(ab, ap), d2 = Dot(ac, ap);
+        if (d1 <= 0.0f && d2 <= 0.0f)
+            return a;
+
+        const Vec3 bp = p - b;
+        const float d3 = Dot(ab, bp), d4 = Dot(ac, bp);
+        if (d3 >= 0.0f && d4 <= d3)
+            return b;
+
+        const float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+            return a + ab * (d1 / (d1 - d3));
+
+        const Vec3 cp = p - c;
+        const float d5 = Dot(ab, cp), d6 = Dot(ac, cp);
+        if (d6 >= 0.0f && d5 <= d6)
+            return c;
+
+        const float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+            return a + ac * (d2 / (d2 - d6));
+
+        const float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+        const float denominator = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denominator) + ac * (vc * denominator);
+    }
+
+    // A (GridSize x GridSize)-cell height field over the unit square, each cell split along its diagonal
+    const uint32_t GridSize = 48;
+
+    struct HeightField
+    {
+        std::vector<GLTFVertex> vertices;
+        std::vector<uint32_t> indices;
+
+        Vec3 Position(uint32_t index) const
+        {
+            const float* p = vertices[index].position;
+            return { p[0], p[1], p[2] };
+        }
+
+        float Height(uint32_t x, uint32_t y) const
+        {
+            return vertices[y * (GridSize + 1) + x].position[2];
+        }
+
+        // Height of the triangulated surface (not the generating function) at (x, y)
+        float SurfaceHeight(float x, float y) const
+        {
+            const float gx = std::clamp(x, 0.0f, 1.0f) * GridSize, gy = std::clamp(y, 0.0f, 1.0f) * GridSize;
+            const uint32_t cx = std::min(uint32_t(gx), GridSize - 1), cy = std::min(uint32_t(gy), GridSize - 1);
+            const float fx = gx - cx, fy = gy - cy;
+            const float z00 = Height(cx, cy), z10 = Height(cx + 1, cy), z01 = Height(cx, cy + 1), z11 = Height(cx + 1, cy + 1);
+            if (fx >= fy)
+                return z00 + fx * (z10 - z00) + fy * (z11 - z10);
+            return z00 + fy * (z01 - z00) + fx * (z11 - z01);
+        }
+    };
+
+    template <typename HeightFunction>
+    HeightField MakeHeightField(HeightFunction height)
+    {
+        HeightField field;
+        for (uint32_t y = 0; y <= GridSize; ++y)
+        {
+            for (uint32_t x = 0; x <= GridSize; ++x)
+            {
+                const float u = float(x) / GridSize, v = float(y) / GridSize;
+                field.vertices.push_back({ { u, v, height(u, v) }, { 0.0f, 0.0f, 1.0f }, { u, v } });
+            }
+        }
+        for (uint32_t y = 0; y < GridSize; ++y)
+        {
+            for (uint32_t x = 0; x < GridSize; ++x)
+            {
+                const uint32_t v00 = y * (GridSize + 1) + x, v10 = v00 + 1, v01 = v00 + GridSize + 1, v11 = v01 + 1;
+                field.indices.insert(field.indices.end(), { v00, v10, v11, v00, v11, v01 });
+            }
+        }
+        return field;
+    }
+
+    // Two-sided distance between the LOD and the full mesh: every original vertex against the
+    // LOD's triangles, and points spread over every LOD triangle against the original surface
+    // (vertical distance, which is never below the true distance)
+    float MeasureDeviation(const HeightField& field, const std::vector<uint32_t>& lodIndices)
+    {
+        float deviation = 0.0f;
+        for (uint32_t v = 0; v < field.vertices.size(); ++v)
+        {
+            const Vec3 p = field.Position(v);
+            float nearest = INFINITY;
+            for (size_t i = 0; i + 2 < lodIndices.size(); i += 3)
+            {
+                const Vec3 closest = ClosestPointOnTriangle(p, field.Position(lodIndices[i]), field.Position(lodIndices[i + 1]), field.Position(lodIndices[i + 2]));
+                nearest = std::min(nearest, Length(p - closest));
+            }
+            deviation = std::max(deviation, nearest);
+        }
+
+        const int Samples = 6;
+        for (size_t i = 0; i + 2 < lodIndices.size(); i += 3)
+        {
+            const Vec3 a = field.Position(lodIndices[i]), b = field.Position(lodIndices[i + 1]), c = field.Position(lodIndices[i + 2]);
+            for (int s = 0; s <= Samples; ++s)
+            {
+                for (int t = 0; s + t <= Samples; ++t)
+                {
+                    const Vec3 p = a + (b - a) * (float(s) / Samples) + (c - a) * (float(t) / Samples);
+                    deviation = std::max(deviation, std::fabs(p.z - field.SurfaceHeight(p.x, p.y)));
+                }
+            }
+        }
+        return deviation;
+    }
+
+    template <typename IndexType>
+    void CheckLods(const char* name, const HeightField& field, size_t minLevels)
+    {
+        const std::vector<IndexType> indices(field.indices.begin(), field.indices.end());
+        std::vector<SimplifiedLod> lods;
+        LodStats stats;
+        BuildLods(field.vertices.data(), uint32_t(field.vertices.size()), indices.data(), indices.size(), lods, stats);
+
+        std::cout << name << ": " << indices.size() / 3 << " triangles" << std::endl;
+        Check(stats.violations == 0, "BuildLods reports no violations");
+        Check(lods.size() >= minLevels, "the mesh reaches the expected number of LODs");
+
+        size_t previousCount = indices.size();
+        float previousError = 0.0f;
+        for (const SimplifiedLod& lod : lods)
+        {
+            const float deviation = MeasureDeviation(field, lod.indices);
+            std::cout << "  LOD: " << lod.indices.size() / 3 << " triangles, error " << lod.error << ", measured " << deviation << std::endl;
+
+            Check(lod.indices.size() % 3 == 0 && lod.indices.size() <= previousCount / 4 * 3, "each LOD drops at least a quarter of the triangles");
+            Check(std::all_of(lod.indices.begin(), lod.indices.end(), [&](uint32_t index) { return index < field.vertices.size(); }), "LOD indices stay in range");
+            Check(lod.error >= previousError, "LOD errors never decrease");
+            // The simplifier's error is a quadric estimate (distance to the planes of the collapsed
+            // triangles), not the surface-to-surface distance, so allow it to undershoot by half
+            Check(deviation <= lod.error * 2.0f + 1e-5f, "measured deviation stays within the reported LOD error");
+            previousCount = lod.indices.size();
+            previousError = lod.error;
+        }
+    }
+}
+
+int main()
+{
+    // Flat: every collapse is free, so the LODs must lose triangles without moving the surface
+    const HeightField flat = MakeHeightField([](float, float) { return 0.0f; });
+    CheckLods<uint16_t>("Flat grid", flat, MaxLodCount - 1);
+
+    // A smooth dome (zero on the locked border): every collapse now costs some deviation
+    const float pi = 3.14159265f;
+    const HeightField dome = MakeHeightField([pi](float u, float v) { return 0.1f * std::sin(pi * u) * std::sin(pi * v); });
+    CheckLods<uint32_t>("Dome", dome, 2);
+
+    if (g_Failures > 0)
+    {
+        std::cerr << g_Failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "LODs: all checks passed" << std::endl;
+    return 0;
+}
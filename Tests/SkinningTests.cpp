@@ -0,0 +1,157 @@
+// Skins known vertices with SkinVertexRange and checks them against hand-computed results
+// and the scalar reference
+#include "Skinning.h"
+#include "SceneTypes.h"
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++g_Failures;
+        }
+    }
+
+    DirectX::XMFLOAT4X4 ToFloat4x4(DirectX::FXMMATRIX matrix)
+    {
+        DirectX::XMFLOAT4X4 result;
+        DirectX::XMStoreFloat4x4(&result, matrix);
+        return result;
+    }
+
+    // Row-vector convention, as DirectXMath: p' = [p 1] * m
+    void TransformPoint(const DirectX::XMFLOAT4X4& m, const float* p, float w, float* result)
+    {
+        for (int c = 0; c < 3; ++c)
+            result[c] = p[0] * m.m[0][c] + p[1] * m.m[1][c] + p[2] * m.m[2][c] + w * m.m[3][c];
+    }
+
+    bool Near(const float* a, const float* b, int count, float tolerance)
+    {
+        for (int c = 0; c < count; ++c)
+        {
+            if (!(std::fabs(a[c] - b[c]) <= tolerance))
+                return false;
+        }
+        return true;
+    }
+
+    float Length(const float* v)
+    {
+        return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    }
+
+    SkinVertex MakeVertex(float x, float y, float z, const uint16_t (&joints)[4], const float (&weights)[4])
+    {
+        SkinVertex vertex = {};
+        vertex.bindPose = { { x, y, z }, { 0.0f, 0.6f, 0.8f }, { 0.25f, 0.75f } };
+        for (int i = 0; i < 4; ++i)
+        {
+            vertex.joints[i] = joints[i];
+            vertex.weights[i] = weights[i];
+        }
+        return vertex;
+    }
+
+    void TestIdentity()
+    {
+        const std::vector<DirectX::XMFLOAT4X4> palette(3, ToFloat4x4(DirectX::XMMatrixIdentity()));
+        const std::vector<SkinVertex> vertices = {
+            MakeVertex(1.0f, 2.0f, 3.0f, { 0, 0, 0, 0 }, { 1.0f, 0.0f, 0.0f, 0.0f }),
+            MakeVertex(-4.0f, 0.5f, 9.0f, { 0, 1, 2, 1 }, { 0.25f, 0.25f, 0.25f, 0.25f }),
+        };
+        std::vector<GLTFVertex> skinned(vertices.size());
+        SkinVertexRange(vertices.data(), vertices.size(), palette.data(), skinned.data());
+
+        for (size_t k = 0; k < vertices.size(); ++k)
+        {
+            Check(Near(skinned[k].position, vertices[k].bindPose.position, 3, 1e-6f), "identity joints keep the bind pose position");
+            Check(Near(skinned[k].normal, vertices[k].bindPose.normal, 3, 1e-6f), "identity joints keep the bind pose normal");
+            Check(Near(skinned[k].texCoord, vertices[k].bindPose.texCoord, 2, 0.0f), "texture coordinates pass through");
+        }
+    }
+
+    void TestRigid()
+    {
+        // One influence: the vertex follows its joint exactly, and so does the normal
+        const DirectX::XMFLOAT4X4 joint = ToFloat4x4(DirectX::XMMatrixRotationRollPitchYaw(0.3f, -1.1f, 0.7f) * DirectX::XMMatrixTranslation(5.0f, -2.0f, 0.5f));
+        const std::vector<DirectX::XMFLOAT4X4> palette = { ToFloat4x4(DirectX::XMMatrixIdentity()), joint };
+        const SkinVertex vertex = MakeVertex(0.5f, -1.5f, 2.0f, { 1, 0, 0, 0 }, { 1.0f, 0.0f, 0.0f, 0.0f });
+        GLTFVertex skinned;
+        SkinVertexRange(&vertex, 1, palette.data(), &skinned);
+
+        float position[3], normal[3];
+        TransformPoint(joint, vertex.bindPose.position, 1.0f, position);
+        TransformPoint(joint, vertex.bindPose.normal, 0.0f, normal);
+        Check(Near(skinned.position, position, 3, 1e-5f), "a single influence moves the vertex with its joint");
+        Check(Near(skinned.normal, normal, 3, 1e-5f), "a single influence rotates the normal with its joint");
+    }
+
+    void TestBlend()
+    {
+        // Random affine joints (non-uniform scale included) and normalized weights, some zero and
+        // some repeating a joint
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> positive(0.5f, 2.0f);
+        std::vector<DirectX::XMFLOAT4X4> palette(16);
+        for (auto& joint : palette)
+        {
+            joint = ToFloat4x4(DirectX::XMMatrixScaling(positive(random), positive(random), positive(random)) *
+                DirectX::XMMatrixRotationRollPitchYaw(3.0f * unit(random), 3.0f * unit(random), 3.0f * unit(random)) *
+                DirectX::XMMatrixTranslation(10.0f * unit(random), 10.0f * unit(random), 10.0f * unit(random)));
+        }
+
+        std::uniform_int_distribution<int> pickJoint(0, int(palette.size()) - 1);
+        std::vector<SkinVertex> vertices;
+        for (int k = 0; k < 1001; ++k)
+        {
+            const uint16_t joints[4] = { uint16_t(pickJoint(random)), uint16_t(pickJoint(random)), uint16_t(k % 3 ? pickJoint(random) : 0), uint16_t(pickJoint(random)) };
+            float weights[4] = { positive(random), k % 2 ? positive(random) : 0.0f, positive(random), k % 5 ? 0.0f : positive(random) };
+            const float sum = weights[0] + weights[1] + weights[2] + weights[3];
+            for (float& weight : weights)
+                weight /= sum;
+            vertices.push_back(MakeVertex(5.0f * unit(random), 5.0f * unit(random), 5.0f * unit(random), { joints[0], joints[1], joints[2], joints[3] }, { weights[0], weights[1], weights[2], weights[3] }));
+        }
+
+        std::vector<GLTFVertex> skinned(vertices.size());
+        SkinVertexRange(vertices.data(), vertices.size(), palette.data(), skinned.data());
+
+        const float maxError = CompareSkinnedVertices(vertices.data(), vertices.size(), palette.data(), skinned.data());
+        bool unitNormals = true;
+        for (const GLTFVertex& vertex : skinned)
+            unitNormals &= std::fabs(Length(vertex.normal) - 1.0f) < 1e-4f;
+
+        // Positions reach ~40 units; float rounding over four influences stays well below this
+        std::cout << "Blended skinning: max position error " << maxError << std::endl;
+        Check(maxError < 1e-4f, "blended positions match the scalar reference");
+
+        // The reference must notice a vertex that went wrong
+        skinned[500].position[1] += 0.01f;
+        Check(CompareSkinnedVertices(vertices.data(), vertices.size(), palette.data(), skinned.data()) >= 0.009f, "the scalar reference detects a misplaced vertex");
+        Check(unitNormals, "blended normals are unit length");
+    }
+}
+
+int main()
+{
+    TestIdentity();
+    TestRigid();
+    TestBlend();
+
+    if (g_Failures > 0)
+    {
+        std::cerr << g_Failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Skinning: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,209 @@
+// Round trips edge-case vertices through the compact layout and checks them against VertexErrorBounds
+#include "VertexCompression.h"
+#include "SceneTypes.h"
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    int g_Failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++g_Failures;
+        }
+    }
+
+    bool IsFinite(const float* values, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (!std::isfinite(values[i]))
+                return false;
+        }
+        return true;
+    }
+
+    float Length(const float v[3])
+    {
+        return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    }
+
+    VertexErrorStats Encode(const std::vector<GLTFVertex>& vertices, const PositionQuantization& quantization)
+    {
+        std::vector<CompactVertex> encoded(vertices.size());
+        VertexErrorStats stats;
+        EncodeCompactVertices(vertices.data(), vertices.size(), quantization, encoded.data(), stats);
+        return stats;
+    }
+
+    GLTFVertex MakeVertex(float x, float y, float z, float nx, float ny, float nz, float u, float v)
+    {
+        return { { x, y, z }, { nx, ny, nz }, { u, v } };
+    }
+
+    const PositionQuantization UnitBox = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f } };
+
+    void TestAxisNormals()
+    {
+        // The octahedron's corners and edge midpoints, where the fold and the clamps meet
+        std::vector<GLTFVertex> vertices;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            for (float sign : { 1.0f, -1.0f })
+            {
+                float n[3] = {};
+                n[axis] = sign;
+                vertices.push_back(MakeVertex(0.5f, 0.5f, 0.5f, n[0], n[1], n[2], 0.0f, 0.0f));
+            }
+        }
+        const float d = 0.70710678f;
+        for (float a : { d, -d })
+        {
+            for (float b : { d, -d })
+            {
+                vertices.push_back(MakeVertex(0.5f, 0.5f, 0.5f, a, b, 0.0f, 0.0f, 0.0f));
+                vertices.push_back(MakeVertex(0.5f, 0.5f, 0.5f, a, 0.0f, b, 0.0f, 0.0f));
+                vertices.push_back(MakeVertex(0.5f, 0.5f, 0.5f, 0.0f, a, b, 0.0f, 0.0f));
+            }
+        }
+
+        const VertexErrorStats stats = Encode(vertices, UnitBox);
+        Check(stats.violations == 0, "axis-aligned normals stay within the bounds");
+        Check(stats.normalAngle <= VertexErrorBounds::NormalAngle, "axis-aligned normal angle error");
+    }
+
+    void TestDenseNormals()
+    {
+        // A fine sweep over the sphere, both hemispheres, including unnormalized inputs
+        std::vector<GLTFVertex> vertices;
+        const float pi = 3.14159265f;
+        for (int i = 0; i <= 256; ++i)
+        {
+            const float theta = pi * i / 256.0f;
+            for (int j = 0; j < 512; ++j)
+            {
+                const float phi = 2.0f * pi * j / 512.0f;
+                const float length = (j % 3) ? 1.0f : 3.5f;
+                vertices.push_back(MakeVertex(0.0f, 0.0f, 0.0f, std::sin(theta) * std::cos(phi) * length,
+                    std::sin(theta) * std::sin(phi) * length, std::cos(theta) * length, 0.0f, 0.0f));
+            }
+        }
+
+        const VertexErrorStats stats = Encode(vertices, UnitBox);
+        Check(stats.violations == 0, "sphere sweep normals stay within the bounds");
+    }
+
+    void TestDegenerateNormals()
+    {
+        // A zero normal has no direction to keep, but must still decode to a usable unit vector
+        const float zero[3] = { 0.0f, 0.0f, 0.0f };
+        int16_t encoded[2];
+        EncodeOctahedral(zero, encoded);
+        float decoded[3];
+        DecodeOctahedral(encoded, decoded);
+        Check(IsFinite(decoded, 3), "zero normal decodes to finite values");
+        Check(std::fabs(Length(decoded) - 1.0f) < 1e-5f, "zero normal decodes to a unit vector");
+
+        const float tiny[3] = { 1e-30f, -1e-30f, 1e-30f };
+        EncodeOctahedral(tiny, encoded);
+        DecodeOctahedral(encoded, decoded);
+        Check(IsFinite(decoded, 3) && std::fabs(Length(decoded) - 1.0f) < 1e-5f, "tiny normal decodes to a unit vector");
+
+        const std::vector<GLTFVertex> vertices = { MakeVertex(0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f) };
+        Check(Encode(vertices, UnitBox).violations == 0, "zero normal is not counted as a violation");
+    }
+
+    void TestFlatAabb()
+    {
+        // A planar primitive: one axis has zero extent and must decode to its offset exactly
+        const PositionQuantization flat = { { -3.0f, 7.25f, 100.0f }, { 12.0f, 0.0f, 0.5f } };
+        std::vector<GLTFVertex> vertices;
+        for (int i = 0; i <= 64; ++i)
+        {
+            const float t = i / 64.0f;
+            vertices.push_back(MakeVertex(-3.0f + 12.0f * t, 7.25f, 100.0f + 0.5f * (1.0f - t), 0.0f, 1.0f, 0.0f, t, 1.0f - t));
+        }
+
+        const VertexErrorStats stats = Encode(vertices, flat);
+        Check(stats.violations == 0, "flat AABB positions stay within the bounds");
+
+        std::vector<CompactVertex> encoded(vertices.size());
+        VertexErrorStats unused;
+        EncodeCompactVertices(vertices.data(), vertices.size(), flat, encoded.data(), unused);
+        for (const CompactVertex& vertex : encoded)
+        {
+            float position[3], normal[3], texCoord[2];
+            DecodeCompactVertex(vertex, flat, position, normal, texCoord);
+            Check(position[1] == 7.25f, "flat axis decodes to the AABB offset");
+        }
+
+        // Fully degenerate: a single point
+        const PositionQuantization point = { { 1.0f, 2.0f, 3.0f }, { 0.0f, 0.0f, 0.0f } };
+        const std::vector<GLTFVertex> pointVertices = { MakeVertex(1.0f, 2.0f, 3.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f) };
+        const VertexErrorStats pointStats = Encode(pointVertices, point);
+        Check(pointStats.violations == 0 && pointStats.position == 0.0f, "point AABB decodes exactly");
+    }
+
+    void TestTexCoordRange()
+    {
+        // Inside the half range: tiny (subnormal), ordinary, tiled and near the largest half
+        std::vector<GLTFVertex> vertices;
+        for (float u : { 0.0f, 1e-7f, -3e-6f, 6.1e-5f, 0.5f, 1.0f / 3.0f, -2.75f, 17.3f, 1000.1f, -40000.7f, 65504.0f, -65504.0f, 65519.0f })
+            vertices.push_back(MakeVertex(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, u, -u));
+
+        const VertexErrorStats stats = Encode(vertices, UnitBox);
+        Check(stats.violations == 0, "in-range UVs stay within the bounds");
+
+        // Beyond it the encoder clamps to the largest half: finite, but reported as a violation
+        const float beyond[] = { 70000.0f, -1e6f, 3e38f };
+        for (float u : beyond)
+        {
+            const std::vector<GLTFVertex> outside = { MakeVertex(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, u, 0.25f) };
+            Check(Encode(outside, UnitBox).violations == 1, "out-of-range UV is counted as a violation");
+
+            const float position[3] = { 0.0f, 0.0f, 0.0f }, normal[3] = { 0.0f, 0.0f, 1.0f }, texCoord[2] = { u, 0.25f };
+            float decodedPosition[3], decodedNormal[3], decodedTexCoord[2];
+            DecodeCompactVertex(EncodeCompactVertex(position, normal, texCoord, UnitBox), UnitBox, decodedPosition, decodedNormal, decodedTexCoord);
+            Check(IsFinite(decodedTexCoord, 2), "out-of-range UV decodes to a finite value");
+            Check(std::fabs(decodedTexCoord[0]) == 65504.0f && (decodedTexCoord[0] > 0.0f) == (u > 0.0f), "out-of-range UV clamps to the largest half");
+        }
+    }
+
+    void TestPositionBounds()
+    {
+        // Wide, tiny and far-from-origin extents: every in-box position rounds within half a step
+        const PositionQuantization box = { { -1000.0f, 0.001f, 12345.0f }, { 2000.0f, 0.002f, 1.0f } };
+        std::vector<GLTFVertex> vertices;
+        for (int i = 0; i <= 1000; ++i)
+        {
+            const float t = i / 1000.0f;
+            vertices.push_back(MakeVertex(-1000.0f + 2000.0f * t, 0.001f + 0.002f * t, 12345.0f + t, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f));
+        }
+
+        const VertexErrorStats stats = Encode(vertices, box);
+        Check(stats.violations == 0, "positions across the AABB stay within the bounds");
+    }
+}
+
+int main()
+{
+    TestAxisNormals();
+    TestDenseNormals();
+    TestDegenerateNormals();
+    TestFlatAabb();
+    TestTexCoordRange();
+    TestPositionBounds();
+
+    if (g_Failures > 0)
+    {
+        std::cerr << g_Failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "VertexCompression: all checks passed" << std::endl;
+    return 0;
+}